@@ -1,4 +1,5 @@
 #include "App.h"
+#include "task/ThreadPool.h"
 #include "ui/MainUI.h"
 #include "utils/Logger.h"
 
@@ -262,6 +263,9 @@ void App::SetupModernStyle() {
 }
 
 void App::Run() {
+    // 界面线程发起的并行工作（预览等）优先于批处理
+    ThreadPool::ScopedPriority priority(TaskPriority::Interactive);
+
     try {
         while (!glfwWindowShouldClose(m_Window)) {
             try {
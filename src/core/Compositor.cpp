@@ -0,0 +1,140 @@
+#include "Compositor.h"
+#include "CompositorKernels.h"
+#include "PixelKernels.h"
+#include <cstring>
+
+namespace {
+
+const CompositeKernels& GetKernels(SimdLevel level) {
+    static const CompositeKernels scalar = {
+        CompositeBlendRGBAScalar, CompositeIsOpaqueScalar,
+        CompositeExpandRGBScalar, CompositeExpandGrayScalar,
+        CompositeBlendPremultipliedScalar
+    };
+#if defined(IMGTOOL_ENABLE_SIMD)
+    static const CompositeKernels sse41 = {
+        CompositeBlendRGBASSE41, CompositeIsOpaqueSSE41,
+        CompositeExpandRGBSSE41, CompositeExpandGraySSE41,
+        CompositeBlendPremultipliedSSE41
+    };
+    static const CompositeKernels avx2 = {
+        CompositeBlendRGBAAVX2, CompositeIsOpaqueAVX2,
+        CompositeExpandRGBSSE41, CompositeExpandGraySSE41,
+        CompositeBlendPremultipliedAVX2
+    };
+
+    switch (level) {
+        case SimdLevel::AVX2:  return avx2;
+        case SimdLevel::SSE41: return sse41;
+        case SimdLevel::Scalar: break;
+    }
+#else
+    (void)level;
+#endif
+    return scalar;
+}
+
+// 灰度 + Alpha：数量少，只提供标量实现
+void BlendGrayAlpha(uint8_t* dst, const uint8_t* src, int count) {
+    for (int x = 0; x < count; ++x) {
+        const uint8_t pixel[4] = {src[0], src[0], src[0], src[1]};
+        CompositeBlendPixel(dst, pixel);
+        dst += 4;
+        src += 2;
+    }
+}
+
+} // namespace
+
+void CompositeBlendRGBAScalar(uint8_t* dst, const uint8_t* src, int count) {
+    for (int x = 0; x < count; ++x) {
+        CompositeBlendPixel(dst + static_cast<size_t>(x) * 4, src + static_cast<size_t>(x) * 4);
+    }
+}
+
+bool CompositeIsOpaqueScalar(const uint8_t* src, int count) {
+    for (int x = 0; x < count; ++x) {
+        if (src[static_cast<size_t>(x) * 4 + 3] != 255) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CompositeExpandRGBScalar(uint8_t* dst, const uint8_t* src, int count) {
+    ConvertRowToRGBA<3>(dst, src, count);
+}
+
+void CompositeExpandGrayScalar(uint8_t* dst, const uint8_t* src, int count) {
+    ConvertRowToRGBA<1>(dst, src, count);
+}
+
+void CompositeBlendPremultipliedScalar(uint8_t* dst, const uint8_t* src, int count) {
+    for (int x = 0; x < count; ++x) {
+        CompositeBlendPremultipliedPixel(dst + static_cast<size_t>(x) * 4,
+                                         src + static_cast<size_t>(x) * 4);
+    }
+}
+
+void Compositor::BlendRow(uint8_t* dst, const uint8_t* src, int count, int channels) {
+    BlendRow(dst, src, count, channels, CpuFeatures::GetSimdLevel());
+}
+
+void Compositor::BlendRow(uint8_t* dst, const uint8_t* src, int count, int channels,
+                          SimdLevel level) {
+    if (!dst || !src || count <= 0) {
+        return;
+    }
+
+    const CompositeKernels& kernels = GetKernels(level);
+
+    switch (channels) {
+        case 4:
+            // 整行不透明（常见的照片类 RGBA）直接复制，不做混合
+            if (kernels.isOpaque(src, count)) {
+                std::memcpy(dst, src, static_cast<size_t>(count) * 4);
+            } else {
+                kernels.blendRGBA(dst, src, count);
+            }
+            break;
+        case 3:
+            kernels.expandRGB(dst, src, count);
+            break;
+        case 2:
+            BlendGrayAlpha(dst, src, count);
+            break;
+        case 1:
+            kernels.expandGray(dst, src, count);
+            break;
+        default:
+            break;
+    }
+}
+
+void Compositor::BlendRowPremultiplied(uint8_t* dst, const uint8_t* src, int count) {
+    BlendRowPremultiplied(dst, src, count, CpuFeatures::GetSimdLevel());
+}
+
+void Compositor::BlendRowPremultiplied(uint8_t* dst, const uint8_t* src, int count,
+                                       SimdLevel level) {
+    if (!dst || !src || count <= 0) {
+        return;
+    }
+    GetKernels(level).blendPremultiplied(dst, src, count);
+}
+
+bool Compositor::IsOpaqueRow(const uint8_t* src, int count, int channels) {
+    switch (channels) {
+        case 4:
+            return GetKernels(CpuFeatures::GetSimdLevel()).isOpaque(src, count);
+        case 2:
+            for (int x = 0; x < count; ++x) {
+                if (src[static_cast<size_t>(x) * 2 + 1] != 255) {
+                    return false;
+                }
+            }
+            return true;
+        default:
+            return true;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 行合成器：把一段源像素合成到 RGBA 画布行上
+ *
+ * 职责：
+ * - 按源格式选择专用内核（RGBA / 不透明 RGBA / RGB / Gray / Gray+Alpha）
+ * - 整数精确 /255 的 Alpha 混合（结果四舍五入）
+ * - 整行不透明时直接复制或扩展，不做混合
+ * - 按运行时检测到的指令集分派 SSE4.1 / AVX2 / 标量内核
+ *
+ * 注意：画布始终不透明，合成后目标像素的 alpha 固定为 255；
+ * 所有内核使用相同的整数运算，标量与 SIMD 输出逐位一致
+ */
+class Compositor {
+public:
+    /**
+     * @brief 合成一行像素
+     * @param dst 画布行中的起始像素（RGBA）
+     * @param src 源像素
+     * @param count 像素个数
+     * @param channels 源通道数（1-4）
+     */
+    static void BlendRow(uint8_t* dst, const uint8_t* src, int count, int channels);
+
+    /**
+     * @brief 合成一行像素（指定 SIMD 等级，用于校验各内核输出一致）
+     */
+    static void BlendRow(uint8_t* dst, const uint8_t* src, int count, int channels,
+                         SimdLevel level);
+
+    /**
+     * @brief 合成一行预乘 alpha 的 RGBA 像素（旋转等重采样输出使用，边缘抗锯齿无黑边）
+     * @param dst 画布行中的起始像素（RGBA）
+     * @param src 预乘 alpha 的 RGBA 像素
+     * @param count 像素个数
+     */
+    static void BlendRowPremultiplied(uint8_t* dst, const uint8_t* src, int count);
+
+    /**
+     * @brief 合成一行预乘 alpha 的像素（指定 SIMD 等级）
+     */
+    static void BlendRowPremultiplied(uint8_t* dst, const uint8_t* src, int count,
+                                      SimdLevel level);
+
+    /**
+     * @brief 判断一行源像素是否全部不透明（合成后会完全覆盖画布）
+     * @param src 源像素
+     * @param count 像素个数
+     * @param channels 源通道数（1、3 通道始终不透明）
+     */
+    static bool IsOpaqueRow(const uint8_t* src, int count, int channels);
+};
@@ -0,0 +1,98 @@
+#include "CompositorKernels.h"
+
+#if defined(IMGTOOL_ENABLE_SIMD)
+
+#include <immintrin.h>
+
+namespace {
+
+inline __m256i Div255(__m256i x) {
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+inline __m256i Mix(__m256i s, __m256i d, __m256i a) {
+    const __m256i invA = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+    return Div255(_mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, invA)));
+}
+
+inline __m256i MixPremultiplied(__m256i s, __m256i d, __m256i a) {
+    const __m256i invA = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+    return _mm256_add_epi16(s, Div255(_mm256_mullo_epi16(d, invA)));
+}
+
+} // namespace
+
+void CompositeBlendRGBAAVX2(uint8_t* dst, const uint8_t* src, int count) {
+    // shuffle/unpack/pack 都在 128 位通道内进行，像素顺序自然还原
+    const __m256i alphaShuffle = _mm256_setr_epi8(3, 3, 3, 3, 7, 7, 7, 7,
+                                                  11, 11, 11, 11, 15, 15, 15, 15,
+                                                  3, 3, 3, 3, 7, 7, 7, 7,
+                                                  11, 11, 11, 11, 15, 15, 15, 15);
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m256i zero = _mm256_setzero_si256();
+
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 4));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + x * 4));
+        __m256i a = _mm256_shuffle_epi8(s, alphaShuffle);
+
+        __m256i lo = Mix(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero),
+                         _mm256_unpacklo_epi8(a, zero));
+        __m256i hi = Mix(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero),
+                         _mm256_unpackhi_epi8(a, zero));
+
+        __m256i out = _mm256_or_si256(_mm256_packus_epi16(lo, hi), alphaMask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), out);
+    }
+
+    CompositeBlendRGBASSE41(dst + x * 4, src + x * 4, count - x);
+}
+
+void CompositeBlendPremultipliedAVX2(uint8_t* dst, const uint8_t* src, int count) {
+    const __m256i alphaShuffle = _mm256_setr_epi8(3, 3, 3, 3, 7, 7, 7, 7,
+                                                  11, 11, 11, 11, 15, 15, 15, 15,
+                                                  3, 3, 3, 3, 7, 7, 7, 7,
+                                                  11, 11, 11, 11, 15, 15, 15, 15);
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m256i zero = _mm256_setzero_si256();
+
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 4));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + x * 4));
+        __m256i a = _mm256_shuffle_epi8(s, alphaShuffle);
+
+        __m256i lo = MixPremultiplied(_mm256_unpacklo_epi8(s, zero),
+                                      _mm256_unpacklo_epi8(d, zero),
+                                      _mm256_unpacklo_epi8(a, zero));
+        __m256i hi = MixPremultiplied(_mm256_unpackhi_epi8(s, zero),
+                                      _mm256_unpackhi_epi8(d, zero),
+                                      _mm256_unpackhi_epi8(a, zero));
+
+        __m256i out = _mm256_or_si256(_mm256_packus_epi16(lo, hi), alphaMask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), out);
+    }
+
+    CompositeBlendPremultipliedSSE41(dst + x * 4, src + x * 4, count - x);
+}
+
+bool CompositeIsOpaqueAVX2(const uint8_t* src, int count) {
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+
+    int x = 0;
+    for (; x + 32 <= count; x += 32) {
+        const __m256i* p = reinterpret_cast<const __m256i*>(src + x * 4);
+        __m256i acc = _mm256_and_si256(
+            _mm256_and_si256(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1)),
+            _mm256_and_si256(_mm256_loadu_si256(p + 2), _mm256_loadu_si256(p + 3)));
+        if (!_mm256_testc_si256(acc, alphaMask)) {
+            return false;
+        }
+    }
+
+    return CompositeIsOpaqueSSE41(src + x * 4, count - x);
+}
+
+#endif // IMGTOOL_ENABLE_SIMD
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Compositor.h"
+
+/**
+ * @file CompositorKernels.h
+ * @brief 行合成内核（仅供 Compositor 及其 SIMD 实现文件内部使用）
+ *
+ * 所有内核的目标都是 RGBA 画布行，输出 alpha 固定为 255。
+ */
+
+using CompositeBlendFn = void (*)(uint8_t* dst, const uint8_t* src, int count);
+using CompositeOpaqueFn = bool (*)(const uint8_t* src, int count);
+
+struct CompositeKernels {
+    CompositeBlendFn blendRGBA = nullptr;   // 带 alpha 的 RGBA 混合
+    CompositeOpaqueFn isOpaque = nullptr;   // RGBA 行是否全部不透明
+    CompositeBlendFn expandRGB = nullptr;   // RGB -> RGBA
+    CompositeBlendFn expandGray = nullptr;  // Gray -> RGBA
+    CompositeBlendFn blendPremultiplied = nullptr;  // 预乘 alpha 的 RGBA 混合
+};
+
+// 标量实现（Compositor.cpp）
+void CompositeBlendRGBAScalar(uint8_t* dst, const uint8_t* src, int count);
+bool CompositeIsOpaqueScalar(const uint8_t* src, int count);
+void CompositeExpandRGBScalar(uint8_t* dst, const uint8_t* src, int count);
+void CompositeExpandGrayScalar(uint8_t* dst, const uint8_t* src, int count);
+void CompositeBlendPremultipliedScalar(uint8_t* dst, const uint8_t* src, int count);
+
+#if defined(IMGTOOL_ENABLE_SIMD)
+// SSE4.1 实现（CompositorSSE41.cpp）
+void CompositeBlendRGBASSE41(uint8_t* dst, const uint8_t* src, int count);
+bool CompositeIsOpaqueSSE41(const uint8_t* src, int count);
+void CompositeExpandRGBSSE41(uint8_t* dst, const uint8_t* src, int count);
+void CompositeExpandGraySSE41(uint8_t* dst, const uint8_t* src, int count);
+void CompositeBlendPremultipliedSSE41(uint8_t* dst, const uint8_t* src, int count);
+
+// AVX2 实现（CompositorAVX2.cpp，扩展内核沿用 SSE4.1 版本）
+void CompositeBlendRGBAAVX2(uint8_t* dst, const uint8_t* src, int count);
+bool CompositeIsOpaqueAVX2(const uint8_t* src, int count);
+void CompositeBlendPremultipliedAVX2(uint8_t* dst, const uint8_t* src, int count);
+#endif
+
+/**
+ * @brief 精确的 round(x / 255)，x 范围 [0, 255 * 255]
+ */
+inline uint32_t CompositeDiv255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+/**
+ * @brief 单个 RGBA 像素的混合（标量，供各内核处理尾部像素）
+ */
+inline void CompositeBlendPixel(uint8_t* dst, const uint8_t* src) {
+    const uint32_t alpha = src[3];
+    const uint32_t invAlpha = 255 - alpha;
+    dst[0] = static_cast<uint8_t>(CompositeDiv255(src[0] * alpha + dst[0] * invAlpha));
+    dst[1] = static_cast<uint8_t>(CompositeDiv255(src[1] * alpha + dst[1] * invAlpha));
+    dst[2] = static_cast<uint8_t>(CompositeDiv255(src[2] * alpha + dst[2] * invAlpha));
+    dst[3] = 255; // 画布始终不透明
+}
+
+/**
+ * @brief 单个预乘 alpha 像素的混合：src + dst * (255 - a) / 255
+ */
+inline void CompositeBlendPremultipliedPixel(uint8_t* dst, const uint8_t* src) {
+    const uint32_t invAlpha = 255 - src[3];
+    dst[0] = static_cast<uint8_t>(src[0] + CompositeDiv255(dst[0] * invAlpha));
+    dst[1] = static_cast<uint8_t>(src[1] + CompositeDiv255(dst[1] * invAlpha));
+    dst[2] = static_cast<uint8_t>(src[2] + CompositeDiv255(dst[2] * invAlpha));
+    dst[3] = 255; // 画布始终不透明
+}
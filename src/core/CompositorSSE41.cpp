@@ -0,0 +1,137 @@
+#include "CompositorKernels.h"
+
+#if defined(IMGTOOL_ENABLE_SIMD)
+
+#include <smmintrin.h>
+
+namespace {
+
+// 16 位通道上的精确 round(x / 255)：((x + 128) + ((x + 128) >> 8)) >> 8，不会溢出
+inline __m128i Div255(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// src * a + dst * (255 - a)，均为 16 位，最大 255 * 255，不会溢出
+inline __m128i Mix(__m128i s, __m128i d, __m128i a) {
+    const __m128i invA = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    return Div255(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, invA)));
+}
+
+// src + dst * (255 - a) / 255（src 为预乘值，结果不会超过 255）
+inline __m128i MixPremultiplied(__m128i s, __m128i d, __m128i a) {
+    const __m128i invA = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    return _mm_add_epi16(s, Div255(_mm_mullo_epi16(d, invA)));
+}
+
+} // namespace
+
+void CompositeBlendRGBASSE41(uint8_t* dst, const uint8_t* src, int count) {
+    // 每个像素的 alpha 广播到 4 个字节
+    const __m128i alphaShuffle = _mm_setr_epi8(3, 3, 3, 3, 7, 7, 7, 7,
+                                               11, 11, 11, 11, 15, 15, 15, 15);
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128i zero = _mm_setzero_si128();
+
+    int x = 0;
+    for (; x + 4 <= count; x += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + x * 4));
+        __m128i a = _mm_shuffle_epi8(s, alphaShuffle);
+
+        __m128i lo = Mix(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero),
+                         _mm_unpacklo_epi8(a, zero));
+        __m128i hi = Mix(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero),
+                         _mm_unpackhi_epi8(a, zero));
+
+        __m128i out = _mm_or_si128(_mm_packus_epi16(lo, hi), alphaMask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), out);
+    }
+
+    for (; x < count; ++x) {
+        CompositeBlendPixel(dst + x * 4, src + x * 4);
+    }
+}
+
+void CompositeBlendPremultipliedSSE41(uint8_t* dst, const uint8_t* src, int count) {
+    const __m128i alphaShuffle = _mm_setr_epi8(3, 3, 3, 3, 7, 7, 7, 7,
+                                               11, 11, 11, 11, 15, 15, 15, 15);
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128i zero = _mm_setzero_si128();
+
+    int x = 0;
+    for (; x + 4 <= count; x += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + x * 4));
+        __m128i a = _mm_shuffle_epi8(s, alphaShuffle);
+
+        __m128i lo = MixPremultiplied(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero),
+                                      _mm_unpacklo_epi8(a, zero));
+        __m128i hi = MixPremultiplied(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero),
+                                      _mm_unpackhi_epi8(a, zero));
+
+        __m128i out = _mm_or_si128(_mm_packus_epi16(lo, hi), alphaMask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), out);
+    }
+
+    for (; x < count; ++x) {
+        CompositeBlendPremultipliedPixel(dst + x * 4, src + x * 4);
+    }
+}
+
+bool CompositeIsOpaqueSSE41(const uint8_t* src, int count) {
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(src + x * 4);
+        __m128i acc = _mm_and_si128(_mm_and_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                                    _mm_and_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+        // 所有 alpha 字节都是 0xFF 时，acc & mask == mask
+        if (!_mm_testc_si128(acc, alphaMask)) {
+            return false;
+        }
+    }
+
+    return CompositeIsOpaqueScalar(src + x * 4, count - x);
+}
+
+void CompositeExpandRGBSSE41(uint8_t* dst, const uint8_t* src, int count) {
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1,
+                                          6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+    // 每次读取 16 字节只用前 12 字节，需保证不越过行尾
+    int x = 0;
+    for (; x + 6 <= count; x += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 3));
+        __m128i out = _mm_or_si128(_mm_shuffle_epi8(s, shuffle), alphaMask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), out);
+    }
+
+    CompositeExpandRGBScalar(dst + x * 4, src + x * 3, count - x);
+}
+
+void CompositeExpandGraySSE41(uint8_t* dst, const uint8_t* src, int count) {
+    const __m128i shuffle0 = _mm_setr_epi8(0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1);
+    const __m128i shuffle1 = _mm_setr_epi8(4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7, 7, 7, -1);
+    const __m128i shuffle2 = _mm_setr_epi8(8, 8, 8, -1, 9, 9, 9, -1,
+                                           10, 10, 10, -1, 11, 11, 11, -1);
+    const __m128i shuffle3 = _mm_setr_epi8(12, 12, 12, -1, 13, 13, 13, -1,
+                                           14, 14, 14, -1, 15, 15, 15, -1);
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        __m128i* out = reinterpret_cast<__m128i*>(dst + x * 4);
+        _mm_storeu_si128(out + 0, _mm_or_si128(_mm_shuffle_epi8(g, shuffle0), alphaMask));
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_shuffle_epi8(g, shuffle1), alphaMask));
+        _mm_storeu_si128(out + 2, _mm_or_si128(_mm_shuffle_epi8(g, shuffle2), alphaMask));
+        _mm_storeu_si128(out + 3, _mm_or_si128(_mm_shuffle_epi8(g, shuffle3), alphaMask));
+    }
+
+    CompositeExpandGrayScalar(dst + x * 4, src + x, count - x);
+}
+
+#endif // IMGTOOL_ENABLE_SIMD
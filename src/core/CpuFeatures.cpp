@@ -0,0 +1,73 @@
+#include "CpuFeatures.h"
+#include <atomic>
+
+#if defined(IMGTOOL_ENABLE_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+
+std::atomic<int> g_MaxSimdLevel{static_cast<int>(SimdLevel::AVX2)};
+
+SimdLevel DetectOnce() {
+#if !defined(IMGTOOL_ENABLE_SIMD)
+    return SimdLevel::Scalar;
+#elif defined(_MSC_VER)
+    int info[4] = {0, 0, 0, 0};
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!sse41) {
+        return SimdLevel::Scalar;
+    }
+
+    // AVX2 需要操作系统保存 YMM 寄存器状态
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5)) {
+            return SimdLevel::AVX2;
+        }
+    }
+    return SimdLevel::SSE41;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return SimdLevel::SSE41;
+    }
+    return SimdLevel::Scalar;
+#endif
+}
+
+} // namespace
+
+SimdLevel CpuFeatures::DetectSimdLevel() {
+    static const SimdLevel detected = DetectOnce();
+    return detected;
+}
+
+SimdLevel CpuFeatures::GetSimdLevel() {
+    int detected = static_cast<int>(DetectSimdLevel());
+    int maxLevel = g_MaxSimdLevel.load(std::memory_order_relaxed);
+    return static_cast<SimdLevel>(detected < maxLevel ? detected : maxLevel);
+}
+
+void CpuFeatures::SetMaxSimdLevel(SimdLevel level) {
+    g_MaxSimdLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+const char* CpuFeatures::GetSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "Scalar";
+        case SimdLevel::SSE41:  return "SSE4.1";
+        case SimdLevel::AVX2:   return "AVX2";
+    }
+    return "Unknown";
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+/**
+ * @brief SIMD 指令集等级（按能力递增排列）
+ */
+enum class SimdLevel {
+    Scalar = 0,   // 纯 C++ 实现
+    SSE41 = 1,    // SSE4.1
+    AVX2 = 2      // AVX2
+};
+
+/**
+ * @brief CPU 特性检测
+ *
+ * 职责：
+ * - 运行时检测 CPU 支持的 SIMD 指令集
+ * - 为各个像素内核提供统一的分派依据
+ *
+ * 注意：编译时未启用 SIMD（IMGTOOL_ENABLE_SIMD）时始终返回 Scalar
+ */
+class CpuFeatures {
+public:
+    /**
+     * @brief 获取当前可用的 SIMD 等级（检测结果与上限取较小值）
+     */
+    static SimdLevel GetSimdLevel();
+
+    /**
+     * @brief 获取硬件实际支持的 SIMD 等级（不受上限影响）
+     */
+    static SimdLevel DetectSimdLevel();
+
+    /**
+     * @brief 限制可用的 SIMD 等级
+     * @param level 上限（用于对比标量与 SIMD 输出、排查问题）
+     */
+    static void SetMaxSimdLevel(SimdLevel level);
+
+    /**
+     * @brief 获取 SIMD 等级名称（用于日志）
+     */
+    static const char* GetSimdLevelName(SimdLevel level);
+};
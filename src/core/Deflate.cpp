@@ -0,0 +1,752 @@
+#include "Deflate.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr int kMinMatch = 3;
+constexpr int kMaxMatch = 258;
+constexpr size_t kWindowMask = Deflate::kWindowSize - 1;
+
+constexpr int kLiteralSymbols = 286;   // 0-255 字面量，256 块结束，257-285 长度
+constexpr int kDistanceSymbols = 30;
+constexpr int kCodeLengthSymbols = 19;
+constexpr int kMaxCodeBits = 15;
+constexpr int kMaxCodeLengthBits = 7;
+
+constexpr int kLengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr int kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr int kDistanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                   257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                   8193, 12289, 16385, 24577};
+constexpr int kDistanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+constexpr uint8_t kCodeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5,
+                                          11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// 动态 Huffman 策略的参数（与 zlib 6 级相近）
+constexpr int kMaxChain = 128;      // 哈希链最多比较的候选数
+constexpr int kGoodLength = 8;      // 已有匹配达到该长度时只搜索 1/4 的链
+constexpr int kNiceLength = 128;    // 找到该长度的匹配后立即停止搜索
+constexpr int kMaxLazy = 16;        // 前一个匹配达到该长度时不再尝试延迟匹配
+constexpr size_t kBlockTokens = 32768;  // 每个动态块最多的符号数
+
+constexpr int kHashBits = 15;
+constexpr int kFastHashBits = 14;
+
+/**
+ * @brief 长度、距离到符号的查找表
+ */
+struct SymbolTables {
+    uint8_t lengthSymbol[kMaxMatch + 1];  // 长度 -> 0..28
+    uint8_t distanceLow[256];             // 距离 - 1 < 256
+    uint8_t distanceHigh[256];            // (距离 - 1) >> 7
+
+    SymbolTables() {
+        for (int code = 0; code < 29; ++code) {
+            const int count = (code == 28) ? 1 : (1 << kLengthExtra[code]);
+            for (int i = 0; i < count; ++i) {
+                lengthSymbol[kLengthBase[code] + i] = static_cast<uint8_t>(code);
+            }
+        }
+        for (int code = 0; code < 30; ++code) {
+            for (int d = kDistanceBase[code] - 1; d < kDistanceBase[code] - 1 + (1 << kDistanceExtra[code]); ++d) {
+                if (d < 256) {
+                    distanceLow[d] = static_cast<uint8_t>(code);
+                } else {
+                    distanceHigh[d >> 7] = static_cast<uint8_t>(code);
+                }
+            }
+        }
+    }
+
+    int DistanceSymbol(int distance) const {
+        const int d = distance - 1;
+        return d < 256 ? distanceLow[d] : distanceHigh[d >> 7];
+    }
+};
+
+const SymbolTables& Tables() {
+    static const SymbolTables tables;
+    return tables;
+}
+
+/**
+ * @brief 按 LSB 优先顺序写比特流
+ */
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : m_Out(out) {}
+
+    void Put(uint32_t bits, int count) {
+        m_Bits |= static_cast<uint64_t>(bits) << m_Count;
+        m_Count += count;
+        if (m_Count >= 32) {
+            const uint32_t word = static_cast<uint32_t>(m_Bits);
+            const uint8_t bytes[4] = {static_cast<uint8_t>(word), static_cast<uint8_t>(word >> 8),
+                                      static_cast<uint8_t>(word >> 16), static_cast<uint8_t>(word >> 24)};
+            m_Out.insert(m_Out.end(), bytes, bytes + 4);
+            m_Bits >>= 32;
+            m_Count -= 32;
+        }
+    }
+
+    // 补零到字节边界
+    void AlignToByte() {
+        while (m_Count > 0) {
+            m_Out.push_back(static_cast<uint8_t>(m_Bits));
+            m_Bits >>= 8;
+            m_Count = std::max(0, m_Count - 8);
+        }
+        m_Bits = 0;
+    }
+
+    // 只能在字节边界上调用
+    void PutBytes(const uint8_t* data, size_t size) {
+        m_Out.insert(m_Out.end(), data, data + size);
+    }
+
+private:
+    std::vector<uint8_t>& m_Out;
+    uint64_t m_Bits = 0;
+    int m_Count = 0;
+};
+
+/**
+ * @brief Huffman 编码表（码字已按位反转，可直接 LSB 优先写出）
+ */
+struct HuffmanCode {
+    uint16_t codes[288] = {};
+    uint8_t lengths[288] = {};
+};
+
+uint32_t ReverseBits(uint32_t code, int length) {
+    uint32_t result = 0;
+    for (int i = 0; i < length; ++i) {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
+    return result;
+}
+
+/**
+ * @brief 由码长生成规范 Huffman 码字
+ */
+void AssignCodes(HuffmanCode& huffman, int count) {
+    int lengthCount[kMaxCodeBits + 1] = {};
+    for (int i = 0; i < count; ++i) {
+        lengthCount[huffman.lengths[i]]++;
+    }
+    lengthCount[0] = 0;
+
+    uint32_t nextCode[kMaxCodeBits + 2] = {};
+    uint32_t code = 0;
+    for (int bits = 1; bits <= kMaxCodeBits; ++bits) {
+        code = (code + lengthCount[bits - 1]) << 1;
+        nextCode[bits] = code;
+    }
+    for (int i = 0; i < count; ++i) {
+        const int length = huffman.lengths[i];
+        huffman.codes[i] = length ? static_cast<uint16_t>(ReverseBits(nextCode[length]++, length)) : 0;
+    }
+}
+
+/**
+ * @brief 由符号频率计算限长 Huffman 码长
+ * @param frequencies 频率
+ * @param count 符号数
+ * @param maxBits 最大码长
+ * @param lengths 输出码长（未使用的符号为 0）
+ */
+void BuildLengths(const uint32_t* frequencies, int count, int maxBits, uint8_t* lengths) {
+    std::fill(lengths, lengths + count, 0);
+
+    struct Leaf {
+        uint32_t frequency;
+        int symbol;
+    };
+    Leaf leaves[288];
+    int leafCount = 0;
+    for (int i = 0; i < count; ++i) {
+        if (frequencies[i] > 0) {
+            leaves[leafCount++] = {frequencies[i], i};
+        }
+    }
+
+    // 少于两个符号时补成两个长度为 1 的码字（完整的编码，所有解码器都能接受）
+    if (leafCount < 2) {
+        const int used = leafCount == 1 ? leaves[0].symbol : 0;
+        lengths[used] = 1;
+        lengths[used == 0 ? 1 : 0] = 1;
+        return;
+    }
+
+    std::sort(leaves, leaves + leafCount, [](const Leaf& a, const Leaf& b) {
+        return a.frequency != b.frequency ? a.frequency < b.frequency : a.symbol < b.symbol;
+    });
+
+    // 双队列构造 Huffman 树：叶子已按频率排序，新生成的内部节点频率单调不减
+    struct Node {
+        uint32_t frequency;
+        int parent;
+    };
+    Node nodes[2 * 288];
+    for (int i = 0; i < leafCount; ++i) {
+        nodes[i] = {leaves[i].frequency, -1};
+    }
+    int nextLeaf = 0;
+    int nextInternal = leafCount;
+    int nodeCount = leafCount;
+    auto takeSmallest = [&]() {
+        if (nextLeaf < leafCount &&
+            (nextInternal >= nodeCount || nodes[nextLeaf].frequency <= nodes[nextInternal].frequency)) {
+            return nextLeaf++;
+        }
+        return nextInternal++;
+    };
+    while (nodeCount < 2 * leafCount - 1) {
+        const int a = takeSmallest();
+        const int b = takeSmallest();
+        nodes[nodeCount] = {nodes[a].frequency + nodes[b].frequency, -1};
+        nodes[a].parent = nodeCount;
+        nodes[b].parent = nodeCount;
+        ++nodeCount;
+    }
+
+    // 内部节点的父节点编号总是更大，从根向下一次即可得到所有深度
+    int depth[2 * 288];
+    depth[nodeCount - 1] = 0;
+    for (int i = nodeCount - 2; i >= 0; --i) {
+        depth[i] = depth[nodes[i].parent] + 1;
+    }
+
+    // 统计各码长的叶子数，超过 maxBits 的部分按 miniz 的方法重新分配
+    int lengthCount[2 * 288] = {};
+    for (int i = 0; i < leafCount; ++i) {
+        lengthCount[std::min(depth[i], 2 * 288 - 1)]++;
+    }
+    for (int i = maxBits + 1; i < 2 * 288; ++i) {
+        lengthCount[maxBits] += lengthCount[i];
+        lengthCount[i] = 0;
+    }
+    uint32_t total = 0;
+    for (int i = maxBits; i > 0; --i) {
+        total += static_cast<uint32_t>(lengthCount[i]) << (maxBits - i);
+    }
+    while (total != (1u << maxBits)) {
+        lengthCount[maxBits]--;
+        for (int i = maxBits - 1; i > 0; --i) {
+            if (lengthCount[i]) {
+                lengthCount[i]--;
+                lengthCount[i + 1] += 2;
+                break;
+            }
+        }
+        total--;
+    }
+
+    // 频率越高码长越短
+    int leaf = leafCount - 1;
+    for (int bits = 1; bits <= maxBits; ++bits) {
+        for (int n = lengthCount[bits]; n > 0; --n) {
+            lengths[leaves[leaf--].symbol] = static_cast<uint8_t>(bits);
+        }
+    }
+}
+
+const HuffmanCode& FixedLiteralCode() {
+    static const HuffmanCode code = [] {
+        HuffmanCode huffman;
+        for (int i = 0; i < 288; ++i) {
+            huffman.lengths[i] = i < 144 ? 8 : (i < 256 ? 9 : (i < 280 ? 7 : 8));
+        }
+        AssignCodes(huffman, 288);
+        return huffman;
+    }();
+    return code;
+}
+
+const HuffmanCode& FixedDistanceCode() {
+    static const HuffmanCode code = [] {
+        HuffmanCode huffman;
+        for (int i = 0; i < 30; ++i) {
+            huffman.lengths[i] = 5;
+        }
+        AssignCodes(huffman, 30);
+        return huffman;
+    }();
+    return code;
+}
+
+inline void PutLiteral(BitWriter& writer, const HuffmanCode& literals, int value) {
+    writer.Put(literals.codes[value], literals.lengths[value]);
+}
+
+inline void PutMatch(BitWriter& writer, const HuffmanCode& literals, const HuffmanCode& distances,
+                     int length, int distance) {
+    const SymbolTables& tables = Tables();
+    const int lengthSymbol = tables.lengthSymbol[length];
+    writer.Put(literals.codes[257 + lengthSymbol], literals.lengths[257 + lengthSymbol]);
+    if (kLengthExtra[lengthSymbol]) {
+        writer.Put(static_cast<uint32_t>(length - kLengthBase[lengthSymbol]), kLengthExtra[lengthSymbol]);
+    }
+    const int distanceSymbol = tables.DistanceSymbol(distance);
+    writer.Put(distances.codes[distanceSymbol], distances.lengths[distanceSymbol]);
+    if (kDistanceExtra[distanceSymbol]) {
+        writer.Put(static_cast<uint32_t>(distance - kDistanceBase[distanceSymbol]), kDistanceExtra[distanceSymbol]);
+    }
+}
+
+/**
+ * @brief 写 stored 块（超过 65535 字节时拆成多个块，只有最后一个块带结束标记）
+ */
+void PutStored(BitWriter& writer, const uint8_t* data, size_t size, bool isLast) {
+    do {
+        const size_t length = std::min<size_t>(size, 65535);
+        size -= length;
+        writer.Put((isLast && size == 0) ? 1 : 0, 1);
+        writer.Put(0, 2);
+        writer.AlignToByte();
+        writer.Put(static_cast<uint32_t>(length), 16);
+        writer.Put(static_cast<uint32_t>(~length & 0xFFFF), 16);
+        writer.PutBytes(data, length);
+        data += length;
+    } while (size > 0);
+}
+
+inline uint32_t Load32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, 4);
+    return value;
+}
+
+inline int MatchLength(const uint8_t* a, const uint8_t* b, int limit) {
+    int length = 0;
+    while (length + 4 <= limit && Load32(a + length) == Load32(b + length)) {
+        length += 4;
+    }
+    while (length < limit && a[length] == b[length]) {
+        ++length;
+    }
+    return length;
+}
+
+/**
+ * @brief 固定 Huffman 编码：单项哈希表 + 贪心匹配，直接输出，不缓存符号
+ */
+void CompressFixed(const uint8_t* data, size_t historyBegin, size_t begin, size_t end,
+                   bool isFinal, BitWriter& writer) {
+    const HuffmanCode& literals = FixedLiteralCode();
+    const HuffmanCode& distances = FixedDistanceCode();
+
+    std::vector<int64_t> table(size_t(1) << kFastHashBits, -1);
+    auto hash = [](uint32_t value) {
+        return (value * 2654435761u) >> (32 - kFastHashBits);
+    };
+
+    // 历史窗口只登记位置，不输出
+    for (size_t p = historyBegin; p + 4 <= begin; ++p) {
+        table[hash(Load32(data + p))] = static_cast<int64_t>(p);
+    }
+
+    writer.Put(isFinal ? 1 : 0, 1);
+    writer.Put(1, 2);
+
+    size_t pos = begin;
+    while (pos + 4 <= end) {
+        const uint32_t value = Load32(data + pos);
+        const uint32_t h = hash(value);
+        const int64_t candidate = table[h];
+        table[h] = static_cast<int64_t>(pos);
+
+        if (candidate >= 0 && pos - static_cast<size_t>(candidate) <= Deflate::kWindowSize &&
+            Load32(data + candidate) == value) {
+            const int limit = static_cast<int>(std::min<size_t>(kMaxMatch, end - pos));
+            const int length = 4 + MatchLength(data + candidate + 4, data + pos + 4, limit - 4);
+            PutMatch(writer, literals, distances, length, static_cast<int>(pos - candidate));
+            // 匹配末尾附近的位置也登记一次，后续重复内容更容易命中
+            if (pos + length + 2 <= end && length > 2) {
+                const size_t tail = pos + length - 2;
+                table[hash(Load32(data + tail))] = static_cast<int64_t>(tail);
+            }
+            pos += length;
+        } else {
+            PutLiteral(writer, literals, data[pos]);
+            ++pos;
+        }
+    }
+    for (; pos < end; ++pos) {
+        PutLiteral(writer, literals, data[pos]);
+    }
+    PutLiteral(writer, literals, 256);
+}
+
+/**
+ * @brief 动态 Huffman 编码器：哈希链 + 延迟匹配，按块统计频率后选择最小的编码方式
+ */
+class DynamicCompressor {
+public:
+    DynamicCompressor(const uint8_t* data, size_t historyBegin, BitWriter& writer)
+        : m_Data(data), m_Base(historyBegin), m_Writer(writer),
+          m_Head(size_t(1) << kHashBits, -1), m_Prev(Deflate::kWindowSize, -1) {
+        m_Tokens.reserve(kBlockTokens);
+    }
+
+    void Compress(size_t begin, size_t end, bool isFinal) {
+        m_End = end;
+        for (size_t p = m_Base; p < begin; ++p) {
+            Insert(p);
+        }
+
+        m_BlockStart = begin;
+        size_t pos = begin;
+        bool havePrevious = false;
+        int previousLength = 0;
+        int previousDistance = 0;
+
+        while (pos < end) {
+            int length = 0;
+            int distance = 0;
+            if (!havePrevious || previousLength < kMaxLazy) {
+                FindMatch(pos, previousLength, length, distance);
+            }
+            Insert(pos);
+
+            if (havePrevious && previousLength >= kMinMatch && length <= previousLength) {
+                // 前一个位置的匹配更好：输出它，并登记匹配覆盖的其余位置
+                AddMatch(previousLength, previousDistance);
+                const size_t matchEnd = pos - 1 + previousLength;
+                for (size_t p = pos + 1; p < matchEnd; ++p) {
+                    Insert(p);
+                }
+                pos = matchEnd;
+                havePrevious = false;
+                previousLength = 0;
+            } else {
+                if (havePrevious) {
+                    AddLiteral(m_Data[pos - 1]);
+                }
+                havePrevious = true;
+                previousLength = length;
+                previousDistance = distance;
+                ++pos;
+            }
+
+            if (m_Tokens.size() >= kBlockTokens) {
+                // 延迟中的符号还没输出，块只能在它之前结束
+                FlushBlock(havePrevious ? pos - 1 : pos, false);
+            }
+        }
+        if (havePrevious) {
+            if (previousLength >= kMinMatch) {
+                AddMatch(previousLength, previousDistance);
+            } else {
+                AddLiteral(m_Data[pos - 1]);
+            }
+        }
+        FlushBlock(end, isFinal);
+    }
+
+private:
+    struct Token {
+        uint16_t value;     // 字面量或匹配长度
+        uint16_t distance;  // 0 表示字面量
+    };
+
+    uint32_t Hash(size_t pos) const {
+        const uint32_t value = m_Data[pos] | (m_Data[pos + 1] << 8) | (m_Data[pos + 2] << 16);
+        return (value * 2654435761u) >> (32 - kHashBits);
+    }
+
+    void Insert(size_t pos) {
+        if (pos + kMinMatch > m_End) {
+            return;
+        }
+        const uint32_t h = Hash(pos);
+        const int32_t relative = static_cast<int32_t>(pos - m_Base);
+        m_Prev[pos & kWindowMask] = m_Head[h];
+        m_Head[h] = relative;
+    }
+
+    void FindMatch(size_t pos, int previousLength, int& outLength, int& outDistance) const {
+        const int limit = static_cast<int>(std::min<size_t>(kMaxMatch, m_End - pos));
+        // 前一个匹配已不短于剩余数据时不可能找到更长的；下面的快速比较读取 current[bestLength]，
+        // 也要求 bestLength < limit，否则会越过数据末尾
+        if (limit < kMinMatch || previousLength >= limit) {
+            return;
+        }
+
+        int bestLength = std::max(previousLength, kMinMatch - 1);
+        int chain = previousLength >= kGoodLength ? kMaxChain / 4 : kMaxChain;
+        const uint8_t* current = m_Data + pos;
+        int32_t candidate = m_Head[Hash(pos)];
+        const int32_t relativePos = static_cast<int32_t>(pos - m_Base);
+
+        while (candidate >= 0 && chain-- > 0) {
+            const int32_t distance = relativePos - candidate;
+            if (distance <= 0 || distance > static_cast<int32_t>(Deflate::kWindowSize)) {
+                break;
+            }
+            const uint8_t* match = m_Data + m_Base + candidate;
+            if (match[bestLength] == current[bestLength] && match[0] == current[0] &&
+                match[1] == current[1]) {
+                const int length = MatchLength(match, current, limit);
+                if (length > bestLength) {
+                    bestLength = length;
+                    outLength = length;
+                    outDistance = static_cast<int>(distance);
+                    if (length >= kNiceLength || length >= limit) {
+                        break;
+                    }
+                }
+            }
+            const int32_t next = m_Prev[(m_Base + candidate) & kWindowMask];
+            if (next >= candidate) {
+                break;  // 环形缓冲区中的旧记录已被覆盖
+            }
+            candidate = next;
+        }
+    }
+
+    void AddLiteral(uint8_t value) {
+        m_Tokens.push_back({value, 0});
+        m_LiteralFreq[value]++;
+    }
+
+    void AddMatch(int length, int distance) {
+        m_Tokens.push_back({static_cast<uint16_t>(length), static_cast<uint16_t>(distance)});
+        m_LiteralFreq[257 + Tables().lengthSymbol[length]]++;
+        m_DistanceFreq[Tables().DistanceSymbol(distance)]++;
+    }
+
+    void FlushBlock(size_t blockEnd, bool isLast);
+
+private:
+    const uint8_t* m_Data;
+    size_t m_Base;
+    size_t m_End = 0;
+    BitWriter& m_Writer;
+
+    std::vector<int32_t> m_Head;
+    std::vector<int32_t> m_Prev;
+
+    std::vector<Token> m_Tokens;
+    size_t m_BlockStart = 0;
+    uint32_t m_LiteralFreq[kLiteralSymbols] = {};
+    uint32_t m_DistanceFreq[kDistanceSymbols] = {};
+};
+
+void DynamicCompressor::FlushBlock(size_t blockEnd, bool isLast) {
+    m_LiteralFreq[256] = 1;
+
+    HuffmanCode literals;
+    HuffmanCode distances;
+    BuildLengths(m_LiteralFreq, kLiteralSymbols, kMaxCodeBits, literals.lengths);
+    BuildLengths(m_DistanceFreq, kDistanceSymbols, kMaxCodeBits, distances.lengths);
+    AssignCodes(literals, kLiteralSymbols);
+    AssignCodes(distances, kDistanceSymbols);
+
+    int literalCount = kLiteralSymbols;
+    while (literalCount > 257 && literals.lengths[literalCount - 1] == 0) {
+        --literalCount;
+    }
+    int distanceCount = kDistanceSymbols;
+    while (distanceCount > 1 && distances.lengths[distanceCount - 1] == 0) {
+        --distanceCount;
+    }
+
+    // 码长序列的游程编码（16 重复前值 3-6 次，17 零 3-10 次，18 零 11-138 次）
+    uint8_t allLengths[kLiteralSymbols + kDistanceSymbols];
+    std::memcpy(allLengths, literals.lengths, literalCount);
+    std::memcpy(allLengths + literalCount, distances.lengths, distanceCount);
+    const int total = literalCount + distanceCount;
+
+    struct RunItem {
+        uint8_t symbol;
+        uint8_t extra;
+    };
+    RunItem items[kLiteralSymbols + kDistanceSymbols];
+    int itemCount = 0;
+    uint32_t codeLengthFreq[kCodeLengthSymbols] = {};
+    auto emit = [&](int symbol, int extra) {
+        items[itemCount++] = {static_cast<uint8_t>(symbol), static_cast<uint8_t>(extra)};
+        codeLengthFreq[symbol]++;
+    };
+    for (int i = 0; i < total;) {
+        const uint8_t value = allLengths[i];
+        int run = 1;
+        while (i + run < total && allLengths[i + run] == value) {
+            ++run;
+        }
+        i += run;
+        if (value == 0) {
+            while (run >= 11) {
+                const int n = std::min(run, 138);
+                emit(18, n - 11);
+                run -= n;
+            }
+            if (run >= 3) {
+                emit(17, run - 3);
+                run = 0;
+            }
+        } else {
+            emit(value, 0);
+            --run;
+            while (run >= 3) {
+                const int n = std::min(run, 6);
+                emit(16, n - 3);
+                run -= n;
+            }
+        }
+        while (run-- > 0) {
+            emit(value, 0);
+        }
+    }
+
+    HuffmanCode codeLengths;
+    BuildLengths(codeLengthFreq, kCodeLengthSymbols, kMaxCodeLengthBits, codeLengths.lengths);
+    AssignCodes(codeLengths, kCodeLengthSymbols);
+    int codeLengthCount = kCodeLengthSymbols;
+    while (codeLengthCount > 4 && codeLengths.lengths[kCodeLengthOrder[codeLengthCount - 1]] == 0) {
+        --codeLengthCount;
+    }
+
+    // 比较三种编码方式的位数
+    const HuffmanCode& fixedLiterals = FixedLiteralCode();
+    uint32_t extraBits = 0;
+    uint32_t dynamicBits = 3 + 5 + 5 + 4 + 3 * static_cast<uint32_t>(codeLengthCount);
+    uint32_t fixedBits = 3;
+    for (int i = 0; i < kLiteralSymbols; ++i) {
+        dynamicBits += static_cast<uint32_t>(m_LiteralFreq[i]) * literals.lengths[i];
+        fixedBits += static_cast<uint32_t>(m_LiteralFreq[i]) * fixedLiterals.lengths[i];
+        if (i >= 257) {
+            extraBits += static_cast<uint32_t>(m_LiteralFreq[i]) * kLengthExtra[i - 257];
+        }
+    }
+    for (int i = 0; i < kDistanceSymbols; ++i) {
+        dynamicBits += static_cast<uint32_t>(m_DistanceFreq[i]) * distances.lengths[i];
+        fixedBits += static_cast<uint32_t>(m_DistanceFreq[i]) * 5;
+        extraBits += static_cast<uint32_t>(m_DistanceFreq[i]) * kDistanceExtra[i];
+    }
+    for (int i = 0; i < kCodeLengthSymbols; ++i) {
+        dynamicBits += static_cast<uint32_t>(codeLengthFreq[i]) *
+                       (codeLengths.lengths[i] + (i == 16 ? 2 : i == 17 ? 3 : i == 18 ? 7 : 0));
+    }
+    dynamicBits += extraBits;
+    fixedBits += extraBits;
+    const size_t rawSize = blockEnd - m_BlockStart;
+    const uint32_t storedBits = (static_cast<uint32_t>(rawSize) + 5 * (rawSize / 65535 + 1)) * 8 + 7;
+
+    if (storedBits <= dynamicBits && storedBits <= fixedBits) {
+        PutStored(m_Writer, m_Data + m_BlockStart, rawSize, isLast);
+    } else {
+        const bool useFixed = fixedBits <= dynamicBits;
+        const HuffmanCode& literalCode = useFixed ? fixedLiterals : literals;
+        const HuffmanCode& distanceCode = useFixed ? FixedDistanceCode() : distances;
+
+        m_Writer.Put(isLast ? 1 : 0, 1);
+        if (useFixed) {
+            m_Writer.Put(1, 2);
+        } else {
+            m_Writer.Put(2, 2);
+            m_Writer.Put(static_cast<uint32_t>(literalCount - 257), 5);
+            m_Writer.Put(static_cast<uint32_t>(distanceCount - 1), 5);
+            m_Writer.Put(static_cast<uint32_t>(codeLengthCount - 4), 4);
+            for (int i = 0; i < codeLengthCount; ++i) {
+                m_Writer.Put(codeLengths.lengths[kCodeLengthOrder[i]], 3);
+            }
+            for (int i = 0; i < itemCount; ++i) {
+                const int symbol = items[i].symbol;
+                m_Writer.Put(codeLengths.codes[symbol], codeLengths.lengths[symbol]);
+                if (symbol == 16) {
+                    m_Writer.Put(items[i].extra, 2);
+                } else if (symbol == 17) {
+                    m_Writer.Put(items[i].extra, 3);
+                } else if (symbol == 18) {
+                    m_Writer.Put(items[i].extra, 7);
+                }
+            }
+        }
+
+        for (const Token& token : m_Tokens) {
+            if (token.distance == 0) {
+                PutLiteral(m_Writer, literalCode, token.value);
+            } else {
+                PutMatch(m_Writer, literalCode, distanceCode, token.value, token.distance);
+            }
+        }
+        PutLiteral(m_Writer, literalCode, 256);
+    }
+
+    m_Tokens.clear();
+    m_BlockStart = blockEnd;
+    std::fill(std::begin(m_LiteralFreq), std::end(m_LiteralFreq), 0);
+    std::fill(std::begin(m_DistanceFreq), std::end(m_DistanceFreq), 0);
+}
+
+} // namespace
+
+void Deflate::CompressSegment(const uint8_t* data, size_t historyBegin, size_t begin, size_t end,
+                              Strategy strategy, bool isFinal, std::vector<uint8_t>& out) {
+    BitWriter writer(out);
+    switch (strategy) {
+        case Strategy::Store:
+            // stored 块本身按字节对齐，非最后一段不需要额外的对齐块
+            if (begin < end || isFinal) {
+                PutStored(writer, data + begin, end - begin, isFinal);
+            }
+            return;
+        case Strategy::FixedHuffman:
+            CompressFixed(data, historyBegin, begin, end, isFinal, writer);
+            break;
+        case Strategy::Dynamic: {
+            DynamicCompressor compressor(data, historyBegin, writer);
+            compressor.Compress(begin, end, isFinal);
+            break;
+        }
+    }
+
+    if (!isFinal) {
+        // 空的 stored 块：结束于字节边界，下一段可以直接拼接
+        writer.Put(0, 3);
+        writer.AlignToByte();
+        writer.Put(0x0000, 16);
+        writer.Put(0xFFFF, 16);
+    }
+    writer.AlignToByte();
+}
+
+uint32_t Deflate::Adler32(const uint8_t* data, size_t size, uint32_t adler) {
+    constexpr uint32_t kBase = 65521;
+    constexpr size_t kMaxRun = 5552;  // 保证 32 位累加不溢出的最大长度
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    while (size > 0) {
+        const size_t run = std::min(size, kMaxRun);
+        for (size_t i = 0; i < run; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= kBase;
+        b %= kBase;
+        data += run;
+        size -= run;
+    }
+    return (b << 16) | a;
+}
+
+uint32_t Deflate::Adler32Combine(uint32_t adler1, uint32_t adler2, size_t length2) {
+    constexpr uint32_t kBase = 65521;
+    const uint32_t remainder = static_cast<uint32_t>(length2 % kBase);
+    uint32_t sum1 = adler1 & 0xFFFF;
+    uint32_t sum2 = static_cast<uint32_t>((static_cast<uint32_t>(remainder) * sum1) % kBase);
+    sum1 += (adler2 & 0xFFFF) + kBase - 1;
+    sum2 += ((adler1 >> 16) & 0xFFFF) + ((adler2 >> 16) & 0xFFFF) + kBase - remainder;
+    if (sum1 >= kBase) sum1 -= kBase;
+    if (sum1 >= kBase) sum1 -= kBase;
+    if (sum2 >= (kBase << 1)) sum2 -= (kBase << 1);
+    if (sum2 >= kBase) sum2 -= kBase;
+    return sum1 | (sum2 << 16);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Deflate 压缩（RFC 1951）
+ *
+ * 职责：
+ * - 三种压缩策略：stored、固定 Huffman + 快速匹配、动态 Huffman + 哈希链匹配
+ * - 分段压缩：每段独立压缩（可在多个线程上同时进行），按顺序拼接后仍是一个合法的 deflate 流
+ * - zlib 容器需要的 Adler-32 校验（支持分段计算后合并）
+ *
+ * 分段方式与 pigz 相同：非最后一段以空的 stored 块结束并按字节对齐，
+ * 前一段末尾的数据作为历史窗口参与匹配，但不会再次输出。
+ */
+class Deflate {
+public:
+    enum class Strategy {
+        Store,         // 只输出 stored 块
+        FixedHuffman,  // 单项哈希表贪心匹配，固定 Huffman 编码（速度优先）
+        Dynamic        // 哈希链 + 延迟匹配，逐块动态 Huffman 编码（压缩率优先）
+    };
+
+    // 匹配可以引用的最大距离
+    static constexpr size_t kWindowSize = 32768;
+
+    /**
+     * @brief 压缩一段数据
+     * @param data 数据起始地址
+     * @param historyBegin 历史窗口起点（data[historyBegin, begin) 只用于匹配）
+     * @param begin 本段起点
+     * @param end 本段终点（不含）
+     * @param strategy 压缩策略
+     * @param isFinal 是否为整个流的最后一段
+     * @param out 追加输出（每段从字节边界开始，也在字节边界结束）
+     */
+    static void CompressSegment(const uint8_t* data, size_t historyBegin, size_t begin, size_t end,
+                                Strategy strategy, bool isFinal, std::vector<uint8_t>& out);
+
+    /**
+     * @brief 计算 Adler-32
+     * @param adler 前面数据的 Adler-32（首段为 1）
+     */
+    static uint32_t Adler32(const uint8_t* data, size_t size, uint32_t adler = 1);
+
+    /**
+     * @brief 合并两段数据的 Adler-32
+     * @param adler1 前一段的 Adler-32
+     * @param adler2 后一段的 Adler-32（从 1 开始单独计算）
+     * @param length2 后一段的字节数
+     */
+    static uint32_t Adler32Combine(uint32_t adler1, uint32_t adler2, size_t length2);
+};
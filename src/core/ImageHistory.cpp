@@ -1,5 +1,6 @@
 #include "ImageHistory.h"
 #include <iostream>
+#include <utility>
 
 ImageHistory::ImageHistory(size_t maxHistorySize)
     : m_CurrentIndex(-1)
@@ -13,13 +14,13 @@ void ImageHistory::Push(const ImageData& imageData, const std::string& descripti
         m_History.erase(m_History.begin() + m_CurrentIndex + 1, m_History.end());
     }
 
-    // 创建新的历史记录项（深拷贝图像数据）
+    // 创建新的历史记录项（像素与调用方共享，之后任一方修改时才复制）
     ImageHistoryEntry entry;
-    entry.imageData = imageData;  // 这会复制整个 vector
+    entry.imageData = imageData;
     entry.description = description;
 
     // 添加到历史记录
-    m_History.push_back(entry);
+    m_History.push_back(std::move(entry));
     m_CurrentIndex = static_cast<int>(m_History.size()) - 1;
 
     // 如果超过最大历史记录数，删除最旧的记录
@@ -40,7 +41,7 @@ bool ImageHistory::Undo(ImageData& outImageData, std::string& outDescription) {
 
     // 获取上一个状态
     const ImageHistoryEntry& entry = m_History[m_CurrentIndex];
-    outImageData = entry.imageData;  // 深拷贝
+    outImageData = entry.imageData;  // 共享像素（写时复制）
     outDescription = entry.description;
 
     m_CurrentIndex--;
@@ -62,7 +63,7 @@ bool ImageHistory::Redo(ImageData& outImageData, std::string& outDescription) {
 
     // 获取下一个状态
     const ImageHistoryEntry& entry = m_History[m_CurrentIndex];
-    outImageData = entry.imageData;  // 深拷贝
+    outImageData = entry.imageData;  // 共享像素（写时复制）
     outDescription = entry.description;
 
     printf("[ImageHistory] Redo: '%s' (new index=%d)\n", 
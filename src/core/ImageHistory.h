@@ -10,7 +10,7 @@
  * 保存图像的完整状态，用于撤销/重做
  */
 struct ImageHistoryEntry {
-    ImageData imageData;        // 图像数据的完整副本
+    ImageData imageData;        // 图像状态（像素写时复制，与其它副本共享内存）
     std::string description;    // 操作描述（如 "Delete Selection"）
     
     ImageHistoryEntry() = default;
@@ -45,7 +45,7 @@ public:
      * @param description 操作描述
      * 
      * 注意：
-     * - 会创建图像数据的完整副本
+     * - 只增加像素的引用计数，不复制像素；之后修改图像时才会复制出新的一份
      * - 如果超过最大历史记录数，会删除最旧的记录
      * - 如果当前不在历史记录末尾，会清除后续的重做记录
      */
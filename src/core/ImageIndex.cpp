@@ -0,0 +1,516 @@
+#include "ImageIndex.h"
+#include "ImageLoader.h"
+#include "ImageProber.h"
+#include "ImageProcessor.h"
+#include "../utils/Logger.h"
+#include "../utils/MappedFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 索引文件格式（本机字节序）：
+//   "IBTI" | 版本 u32 | 条目数 u32 | 条目...
+//   条目：文件名长度 u16 | 文件名 | 大小 u64 | 修改时间 i64 | 宽 i32 | 高 i32 | 通道 i32 |
+//         内容哈希 u64 | 缩略图偏移 u64 | 缩略图大小 u32
+constexpr char kMagic[4] = {'I', 'B', 'T', 'I'};
+constexpr uint32_t kVersion = 1;
+
+// 缩略图数据文件中失效的数据多于有效数据且超过 1 MiB 时重写
+constexpr uint64_t kCompactSlack = 1024 * 1024;
+
+constexpr int kThumbnailQuality = 85;
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : m_Data(data), m_Size(size) {}
+
+    template<typename T>
+    bool Read(T& value) {
+        if (m_Size - m_Pos < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, m_Data + m_Pos, sizeof(T));
+        m_Pos += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(std::string& value, size_t length) {
+        if (m_Size - m_Pos < length) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(m_Data + m_Pos), length);
+        m_Pos += length;
+        return true;
+    }
+
+private:
+    const uint8_t* m_Data;
+    size_t m_Size;
+    size_t m_Pos = 0;
+};
+
+template<typename T>
+void Append(std::vector<uint8_t>& out, const T& value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+uint64_t HashString(const std::string& text) {
+    uint64_t hash = 0xcbf29ce484222325ULL;  // FNV-1a
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief 文件内容哈希（按 8 字节处理，只用于判断内容是否相同，不用于安全场景）
+ */
+uint64_t HashBytes(const uint8_t* data, size_t size) {
+    uint64_t hash = 0x9E3779B97F4A7C15ULL ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash ^= word * 0x87C37B91114253D5ULL;
+        hash = ((hash << 31) | (hash >> 33)) * 0x4CF5AD432745937FULL;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    }
+    hash ^= hash >> 33;
+    return hash != 0 ? hash : 1;  // 0 表示未计算
+}
+
+fs::path DefaultDirectory() {
+#ifdef _WIN32
+    if (const wchar_t* localAppData = _wgetenv(L"LOCALAPPDATA")) {
+        return fs::path(localAppData) / "ImageBatchTool" / "index";
+    }
+#else
+    if (const char* cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome && *cacheHome) {
+        return fs::path(cacheHome) / "ImageBatchTool" / "index";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return fs::path(home) / ".cache" / "ImageBatchTool" / "index";
+    }
+#endif
+    return fs::path();
+}
+
+void SplitPath(const std::string& filePath, std::string& folderPath, std::string& fileName) {
+    const fs::path path = fs::path(filePath).lexically_normal();
+    folderPath = path.parent_path().string();
+    fileName = path.filename().string();
+}
+
+} // namespace
+
+bool FileStamp::Read(const std::string& filePath, FileStamp& outStamp) {
+    std::error_code ec;
+    const auto size = fs::file_size(filePath, ec);
+    if (ec) {
+        return false;
+    }
+    const auto time = fs::last_write_time(filePath, ec);
+    if (ec) {
+        return false;
+    }
+    outStamp.size = static_cast<uint64_t>(size);
+    outStamp.modifiedTime = static_cast<int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+bool FileStamp::Read(const fs::directory_entry& entry, FileStamp& outStamp) {
+    std::error_code ec;
+    const auto size = entry.file_size(ec);
+    if (ec) {
+        return false;
+    }
+    const auto time = entry.last_write_time(ec);
+    if (ec) {
+        return false;
+    }
+    outStamp.size = static_cast<uint64_t>(size);
+    outStamp.modifiedTime = static_cast<int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+ImageIndex::ImageIndex(const fs::path& cacheDirectory) : m_Directory(cacheDirectory) {}
+
+ImageIndex::~ImageIndex() {
+    Flush();
+}
+
+ImageIndex& ImageIndex::Shared() {
+    static ImageIndex index(DefaultDirectory());
+    return index;
+}
+
+bool ImageIndex::LookupInfo(const std::string& filePath, const FileStamp& stamp,
+                            ImageInfo& outInfo) {
+    std::string folderPath, fileName;
+    SplitPath(filePath, folderPath, fileName);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    const Folder& folder = GetFolder(folderPath);
+    auto it = folder.entries.find(fileName);
+    if (it == folder.entries.end() || !(it->second.stamp == stamp)) {
+        return false;
+    }
+
+    outInfo.filePath = filePath;
+    outInfo.fileName = fileName;
+    outInfo.width = it->second.width;
+    outInfo.height = it->second.height;
+    outInfo.channels = it->second.channels;
+    outInfo.fileSize = static_cast<size_t>(stamp.size);
+    return true;
+}
+
+void ImageIndex::StoreInfo(const ImageInfo& info, const FileStamp& stamp) {
+    std::string folderPath, fileName;
+    SplitPath(info.filePath, folderPath, fileName);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Folder& folder = GetFolder(folderPath);
+    Entry& entry = folder.entries[fileName];
+    if (!(entry.stamp == stamp)) {
+        // 文件已变化：旧的哈希和缩略图作废
+        entry = Entry();
+        entry.stamp = stamp;
+    }
+    entry.width = info.width;
+    entry.height = info.height;
+    entry.channels = info.channels;
+    folder.dirty = true;
+}
+
+void ImageIndex::Retain(const std::string& folderPath, const std::vector<std::string>& fileNames) {
+    // 与 SplitPath 得到的文件夹路径一致（去掉末尾的分隔符）
+    fs::path normalized = fs::path(folderPath).lexically_normal();
+    if (!normalized.has_filename()) {
+        normalized = normalized.parent_path();
+    }
+    const std::string key = normalized.string();
+    const std::unordered_set<std::string> keep(fileNames.begin(), fileNames.end());
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Folder& folder = GetFolder(key);
+    for (auto it = folder.entries.begin(); it != folder.entries.end();) {
+        if (keep.count(it->first) == 0) {
+            it = folder.entries.erase(it);
+            folder.dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool ImageIndex::LoadThumbnail(const std::string& filePath, ImageData& outThumbnail) {
+    std::string folderPath, fileName;
+    SplitPath(filePath, folderPath, fileName);
+
+    FileStamp stamp;
+    const bool hasStamp = FileStamp::Read(filePath, stamp);
+
+    if (hasStamp && !m_Directory.empty()) {
+        std::vector<uint8_t> encoded;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            const Folder& folder = GetFolder(folderPath);
+            auto it = folder.entries.find(fileName);
+            if (it != folder.entries.end() && it->second.stamp == stamp &&
+                it->second.thumbnailSize > 0) {
+                std::ifstream file(ThumbnailPath(folderPath), std::ios::binary);
+                encoded.resize(it->second.thumbnailSize);
+                file.seekg(static_cast<std::streamoff>(it->second.thumbnailOffset));
+                if (!file.read(reinterpret_cast<char*>(encoded.data()),
+                               static_cast<std::streamsize>(encoded.size()))) {
+                    encoded.clear();
+                }
+            }
+        }
+        // 命中只依赖大小和修改时间，不读取原文件（网络共享上读原文件与解码一样慢）
+        if (!encoded.empty() &&
+            ImageLoader::LoadFromMemory(encoded.data(), encoded.size(), 1, outThumbnail)) {
+            return true;
+        }
+    }
+
+    Entry entry;
+    std::vector<uint8_t> encoded;
+    if (!CreateThumbnail(filePath, outThumbnail, encoded, entry)) {
+        return false;
+    }
+    if (!hasStamp || m_Directory.empty()) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Folder& folder = GetFolder(folderPath);
+
+    // 新缩略图追加到数据文件末尾，旧数据在 Flush() 时按需清理；
+    // 偏移以文件实际的末尾为准，写入并刷新成功后才记录
+    std::error_code ec;
+    fs::create_directories(m_Directory, ec);
+    std::ofstream file(ThumbnailPath(folderPath), std::ios::binary | std::ios::app);
+    file.seekp(0, std::ios::end);
+    const std::streamoff offset = file.tellp();
+    if (offset < 0 ||
+        !file.write(reinterpret_cast<const char*>(encoded.data()),
+                    static_cast<std::streamsize>(encoded.size())) ||
+        !file.flush()) {
+        Logger::Warning("Failed to write thumbnail cache for: " + filePath);
+        return true;
+    }
+
+    entry.stamp = stamp;
+    entry.thumbnailOffset = static_cast<uint64_t>(offset);
+    entry.thumbnailSize = static_cast<uint32_t>(encoded.size());
+    folder.thumbnailFileSize = entry.thumbnailOffset + encoded.size();
+    folder.entries[fileName] = entry;
+    folder.dirty = true;
+    return true;
+}
+
+void ImageIndex::Flush() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Directory.empty()) {
+        return;
+    }
+    for (auto& [folderPath, folder] : m_Folders) {
+        if (!folder.dirty) {
+            continue;
+        }
+        CompactThumbnails(folderPath, folder);
+        if (WriteFolder(folderPath, folder)) {
+            folder.dirty = false;
+        }
+    }
+}
+
+ImageIndex::Folder& ImageIndex::GetFolder(const std::string& folderPath) {
+    auto it = m_Folders.find(folderPath);
+    if (it != m_Folders.end()) {
+        return it->second;
+    }
+
+    Folder& folder = m_Folders[folderPath];
+    if (!m_Directory.empty() && !ReadFolder(folderPath, folder)) {
+        // 没有可用的索引时缩略图数据文件中的内容无人引用，清空后从头追加
+        folder = Folder();
+        std::error_code ec;
+        fs::remove(ThumbnailPath(folderPath), ec);
+    }
+    return folder;
+}
+
+fs::path ImageIndex::IndexPath(const std::string& folderPath) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.idx",
+                  static_cast<unsigned long long>(HashString(folderPath)));
+    return m_Directory / name;
+}
+
+fs::path ImageIndex::ThumbnailPath(const std::string& folderPath) const {
+    return fs::path(IndexPath(folderPath)).replace_extension(".thumbs");
+}
+
+bool ImageIndex::ReadFolder(const std::string& folderPath, Folder& folder) const {
+    std::vector<uint8_t> data;
+    size_t fileSize = 0;
+    if (!MappedFile::ReadPrefix(IndexPath(folderPath).string(), SIZE_MAX, data, fileSize)) {
+        return false;  // 没有索引（第一次打开这个文件夹）
+    }
+
+    std::error_code ec;
+    const auto thumbnailFileSize = fs::file_size(ThumbnailPath(folderPath), ec);
+    folder.thumbnailFileSize = ec ? 0 : static_cast<uint64_t>(thumbnailFileSize);
+
+    Reader reader(data.data(), data.size());
+    char magic[4];
+    uint32_t version = 0, count = 0;
+    if (!reader.Read(magic) || std::memcmp(magic, kMagic, 4) != 0 ||
+        !reader.Read(version) || version != kVersion || !reader.Read(count)) {
+        Logger::Warning("Ignoring incompatible image index for: " + folderPath);
+        return false;
+    }
+
+    folder.entries.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint16_t nameLength = 0;
+        std::string name;
+        Entry entry;
+        int32_t width = 0, height = 0, channels = 0;
+        if (!reader.Read(nameLength) || !reader.ReadString(name, nameLength) ||
+            !reader.Read(entry.stamp.size) || !reader.Read(entry.stamp.modifiedTime) ||
+            !reader.Read(width) || !reader.Read(height) || !reader.Read(channels) ||
+            !reader.Read(entry.contentHash) || !reader.Read(entry.thumbnailOffset) ||
+            !reader.Read(entry.thumbnailSize)) {
+            Logger::Warning("Ignoring corrupt image index for: " + folderPath);
+            return false;
+        }
+        entry.width = width;
+        entry.height = height;
+        entry.channels = channels;
+
+        // 缩略图数据文件被删除或截断时只丢弃缩略图
+        if (entry.thumbnailOffset + entry.thumbnailSize > folder.thumbnailFileSize) {
+            entry.thumbnailOffset = 0;
+            entry.thumbnailSize = 0;
+        }
+        folder.entries[std::move(name)] = entry;
+    }
+    return true;
+}
+
+bool ImageIndex::WriteFolder(const std::string& folderPath, Folder& folder) const {
+    std::vector<uint8_t> data;
+    data.insert(data.end(), kMagic, kMagic + 4);
+    Append(data, kVersion);
+    Append(data, static_cast<uint32_t>(folder.entries.size()));
+    for (const auto& [name, entry] : folder.entries) {
+        Append(data, static_cast<uint16_t>(name.size()));
+        data.insert(data.end(), name.begin(), name.end());
+        Append(data, entry.stamp.size);
+        Append(data, entry.stamp.modifiedTime);
+        Append(data, static_cast<int32_t>(entry.width));
+        Append(data, static_cast<int32_t>(entry.height));
+        Append(data, static_cast<int32_t>(entry.channels));
+        Append(data, entry.contentHash);
+        Append(data, entry.thumbnailOffset);
+        Append(data, entry.thumbnailSize);
+    }
+
+    // 先写临时文件再替换，写到一半退出时旧索引仍然完整
+    std::error_code ec;
+    fs::create_directories(m_Directory, ec);
+    const fs::path path = IndexPath(folderPath);
+    fs::path temp = path;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char*>(data.data()),
+                        static_cast<std::streamsize>(data.size()))) {
+            Logger::Warning("Failed to write image index: " + temp.string());
+            return false;
+        }
+    }
+    fs::rename(temp, path, ec);
+    if (ec) {
+        Logger::Warning("Failed to replace image index: " + path.string() + " - " + ec.message());
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+void ImageIndex::CompactThumbnails(const std::string& folderPath, Folder& folder) const {
+    uint64_t liveBytes = 0;
+    for (const auto& [name, entry] : folder.entries) {
+        liveBytes += entry.thumbnailSize;
+    }
+    if (folder.thumbnailFileSize <= liveBytes * 2 + kCompactSlack) {
+        return;
+    }
+
+    const fs::path path = ThumbnailPath(folderPath);
+    fs::path temp = path;
+    temp += ".tmp";
+    {
+        std::ifstream input(path, std::ios::binary);
+        std::ofstream output(temp, std::ios::binary | std::ios::trunc);
+        std::vector<char> buffer;
+        uint64_t offset = 0;
+        for (auto& [name, entry] : folder.entries) {
+            if (entry.thumbnailSize == 0) {
+                continue;
+            }
+            buffer.resize(entry.thumbnailSize);
+            input.seekg(static_cast<std::streamoff>(entry.thumbnailOffset));
+            if (!input.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) ||
+                !output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()))) {
+                input.clear();
+                entry.thumbnailOffset = 0;
+                entry.thumbnailSize = 0;
+                continue;
+            }
+            entry.thumbnailOffset = offset;
+            offset += entry.thumbnailSize;
+        }
+        folder.thumbnailFileSize = offset;
+    }
+
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+    if (ec) {
+        // 替换失败时旧文件仍在，但偏移已经更新，只能放弃所有缩略图
+        Logger::Warning("Failed to compact thumbnail cache: " + path.string() + " - " + ec.message());
+        fs::remove(temp, ec);
+        for (auto& [name, entry] : folder.entries) {
+            entry.thumbnailOffset = 0;
+            entry.thumbnailSize = 0;
+        }
+    }
+}
+
+bool ImageIndex::CreateThumbnail(const std::string& filePath, ImageData& outThumbnail,
+                                 std::vector<uint8_t>& outEncoded, Entry& outEntry) {
+    MappedFile file;
+    std::string error;
+    if (!file.Open(filePath, &error)) {
+        Logger::Error("Failed to open " + filePath + ": " + error);
+        return false;
+    }
+    outEntry.contentHash = HashBytes(file.Data(), file.Size());
+
+    // 从头部得到原图尺寸：JPEG 可以直接按 1/2、1/4、1/8 解码到接近缩略图的尺寸
+    int width = 0, height = 0, channels = 0;
+    const bool hasHeader = ImageProber::Parse(file.Data(), file.Size(), width, height, channels);
+    int scaleDenominator = 1;
+    if (hasHeader) {
+        const int longest = std::max(width, height);
+        for (int denominator : {8, 4, 2}) {
+            if (longest / denominator >= kThumbnailSize) {
+                scaleDenominator = denominator;
+                break;
+            }
+        }
+    }
+
+    ImageData decoded;
+    if (!ImageLoader::LoadFromMemory(file.Data(), file.Size(), scaleDenominator, decoded)) {
+        Logger::Error("Failed to decode thumbnail source: " + filePath);
+        return false;
+    }
+    outEntry.width = hasHeader ? width : decoded.width;
+    outEntry.height = hasHeader ? height : decoded.height;
+    outEntry.channels = hasHeader ? channels : decoded.channels;
+
+    const int longest = std::max(decoded.width, decoded.height);
+    if (longest > kThumbnailSize) {
+        const double scale = static_cast<double>(kThumbnailSize) / longest;
+        const int thumbWidth = std::max(1, static_cast<int>(decoded.width * scale + 0.5));
+        const int thumbHeight = std::max(1, static_cast<int>(decoded.height * scale + 0.5));
+        outThumbnail = ImageProcessor::Resize(decoded, thumbWidth, thumbHeight);
+    } else {
+        outThumbnail = std::move(decoded);
+    }
+    if (!outThumbnail.IsValid()) {
+        return false;
+    }
+
+    // 带 alpha 的缩略图用 PNG，其它用 JPG（体积小）
+    const bool hasAlpha = (outThumbnail.channels == 2 || outThumbnail.channels == 4);
+    return ImageLoader::EncodeToMemory(outThumbnail, hasAlpha ? OutputFormat::PNG : OutputFormat::JPG,
+                                       kThumbnailQuality, outEncoded);
+}
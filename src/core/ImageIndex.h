@@ -0,0 +1,144 @@
+#pragma once
+
+#include "Types.h"
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief 文件标识（大小 + 修改时间），两者都不变时认为文件内容没有变化
+ */
+struct FileStamp {
+    uint64_t size = 0;
+    int64_t modifiedTime = 0;  // std::filesystem::file_time_type 的计数
+
+    bool operator==(const FileStamp& other) const {
+        return size == other.size && modifiedTime == other.modifiedTime;
+    }
+
+    /**
+     * @brief 读取文件的大小和修改时间
+     */
+    static bool Read(const std::string& filePath, FileStamp& outStamp);
+
+    /**
+     * @brief 从目录遍历得到的条目读取（Windows 上使用遍历时缓存的属性，不再访问文件）
+     */
+    static bool Read(const std::filesystem::directory_entry& entry, FileStamp& outStamp);
+};
+
+/**
+ * @brief 图片元数据与缩略图索引（持久化到本地缓存目录）
+ *
+ * 职责：
+ * - 按 文件路径 + 大小 + 修改时间 缓存尺寸、通道数、内容哈希和编码后的小缩略图
+ * - 每个文件夹一个索引文件（元数据）和一个缩略图数据文件，打开文件夹时只读取索引文件
+ * - 缩略图按需从数据文件中读取，不常驻内存
+ *
+ * 缓存目录：
+ * - Windows: %LOCALAPPDATA%/ImageBatchTool/index
+ * - 其它: $XDG_CACHE_HOME/ImageBatchTool/index 或 ~/.cache/ImageBatchTool/index
+ *
+ * 注意：所有方法都是线程安全的；新增的元数据在 Flush() 时写入磁盘
+ */
+class ImageIndex {
+public:
+    // 缩略图最长边
+    static constexpr int kThumbnailSize = 96;
+
+    explicit ImageIndex(const std::filesystem::path& cacheDirectory);
+    ~ImageIndex();
+
+    ImageIndex(const ImageIndex&) = delete;
+    ImageIndex& operator=(const ImageIndex&) = delete;
+
+    /**
+     * @brief 进程内共享的索引（使用默认缓存目录）
+     */
+    static ImageIndex& Shared();
+
+    /**
+     * @brief 查找图片信息
+     * @param filePath 文件路径
+     * @param stamp 文件当前的大小和修改时间
+     * @param outInfo 命中时输出图片信息
+     * @return 命中且文件未变化时返回 true
+     */
+    bool LookupInfo(const std::string& filePath, const FileStamp& stamp, ImageInfo& outInfo);
+
+    /**
+     * @brief 记录图片信息
+     */
+    void StoreInfo(const ImageInfo& info, const FileStamp& stamp);
+
+    /**
+     * @brief 删除文件夹中不在 fileNames 里的记录（文件已删除或不再是图片）
+     * @param folderPath 文件夹路径
+     * @param fileNames 文件夹中现有的图片文件名
+     */
+    void Retain(const std::string& folderPath, const std::vector<std::string>& fileNames);
+
+    /**
+     * @brief 获取缩略图（优先读取索引中的缩略图，没有时解码原图生成并写入索引）
+     * @param filePath 文件路径
+     * @param outThumbnail 输出缩略图（最长边不超过 kThumbnailSize）
+     * @return 成功返回 true
+     */
+    bool LoadThumbnail(const std::string& filePath, ImageData& outThumbnail);
+
+    /**
+     * @brief 把修改过的文件夹索引写入磁盘
+     */
+    void Flush();
+
+private:
+    struct Entry {
+        FileStamp stamp;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        uint64_t contentHash = 0;     // 原文件内容哈希（生成缩略图时计算，命中时不校验）；0 表示尚未计算
+        uint64_t thumbnailOffset = 0; // 在缩略图数据文件中的偏移
+        uint32_t thumbnailSize = 0;   // 0 表示没有缩略图
+    };
+
+    struct Folder {
+        std::unordered_map<std::string, Entry> entries;  // 文件名 -> 记录
+        uint64_t thumbnailFileSize = 0;  // 缩略图数据文件当前大小（新缩略图追加到末尾）
+        bool dirty = false;
+    };
+
+    /**
+     * @brief 取得文件夹的索引（第一次访问时从磁盘读取），调用方需持有 m_Mutex
+     */
+    Folder& GetFolder(const std::string& folderPath);
+
+    /**
+     * @brief 索引文件和缩略图数据文件的路径（按文件夹路径的哈希命名）
+     */
+    std::filesystem::path IndexPath(const std::string& folderPath) const;
+    std::filesystem::path ThumbnailPath(const std::string& folderPath) const;
+
+    bool ReadFolder(const std::string& folderPath, Folder& folder) const;
+    bool WriteFolder(const std::string& folderPath, Folder& folder) const;
+
+    /**
+     * @brief 缩略图数据文件中失效的数据过多时重写（只保留仍被引用的缩略图）
+     */
+    void CompactThumbnails(const std::string& folderPath, Folder& folder) const;
+
+    /**
+     * @brief 解码原图生成缩略图
+     * @param outEncoded 编码后的缩略图（带 alpha 时为 PNG，否则为 JPG）
+     */
+    static bool CreateThumbnail(const std::string& filePath, ImageData& outThumbnail,
+                                std::vector<uint8_t>& outEncoded, Entry& outEntry);
+
+private:
+    std::filesystem::path m_Directory;  // 为空时不读写磁盘
+    std::mutex m_Mutex;
+    std::unordered_map<std::string, Folder> m_Folders;
+};
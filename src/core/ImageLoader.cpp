@@ -1,97 +1,162 @@
 #include "ImageLoader.h"
+#include "ImageProber.h"
+#include "JpegWriter.h"
+#include "PngWriter.h"
+#include "WebpWriter.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include <stb_image_write.h>
-
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include "../utils/Logger.h"
+#include "../utils/MappedFile.h"
+
+#if defined(IMGTOOL_HAS_LIBJPEG)
+#include <csetjmp>
+#include <cstdio>  // jpeglib.h 依赖 FILE
+#include <jpeglib.h>
+#endif
 
 namespace fs = std::filesystem;
 
-bool ImageLoader::Load(const std::string& filePath, ImageData& outData) {
-    try {
-        Logger::Debug("Load() called for: " + filePath);
-        
-        // 验证文件存在
-        if (!fs::exists(filePath) || !fs::is_regular_file(filePath)) {
-            Logger::Error("File does not exist or is not regular: " + filePath);
+#if defined(IMGTOOL_HAS_LIBJPEG)
+namespace {
+
+struct JpegErrorManager {
+    jpeg_error_mgr base;
+    std::jmp_buf jump;
+};
+
+// libjpeg 默认遇到错误会直接 exit()，这里改为记录日志后跳回解码函数
+void JpegErrorExit(j_common_ptr cinfo) {
+    char message[JMSG_LENGTH_MAX];
+    (*cinfo->err->format_message)(cinfo, message);
+    Logger::Error("libjpeg error: " + std::string(message));
+    std::longjmp(reinterpret_cast<JpegErrorManager*>(cinfo->err)->jump, 1);
+}
+
+/**
+ * @brief 逐行 JPEG 解码（缩放 IDCT，输出 1/scaleDenominator 尺寸）
+ *
+ * libjpeg 出错时 longjmp 回 Start / ReadRow；这两个函数在 setjmp 之后不创建带析构函数的局部对象。
+ */
+class JpegRowDecoder {
+public:
+    JpegRowDecoder() {
+        m_Info.err = jpeg_std_error(&m_Error.base);
+        m_Error.base.error_exit = JpegErrorExit;
+    }
+
+    ~JpegRowDecoder() {
+        if (m_Created) {
+            jpeg_destroy_decompress(&m_Info);
+        }
+    }
+
+    JpegRowDecoder(const JpegRowDecoder&) = delete;
+    JpegRowDecoder& operator=(const JpegRowDecoder&) = delete;
+
+    /**
+     * @brief 读取文件头并开始解码（data 在解码结束前必须有效）
+     * @return 出错或为 CMYK / YCCK（交给 stb_image 处理）时返回 false
+     */
+    bool Start(const uint8_t* data, size_t size, int scaleDenominator) {
+        if (setjmp(m_Error.jump)) {
             return false;
         }
-        Logger::Debug("File exists and is regular: " + filePath);
 
-        // 检查文件大小
-        try {
-            if (fs::file_size(filePath) == 0) {
-                Logger::Error("File is empty: " + filePath);
-                return false;
-            }
-            Logger::Debug("File size check passed");
-        } catch (const std::exception& e) {
-            Logger::Error("Error checking file size: " + std::string(e.what()));
+        jpeg_create_decompress(&m_Info);
+        m_Created = true;
+        jpeg_mem_src(&m_Info, const_cast<unsigned char*>(data), static_cast<unsigned long>(size));
+        jpeg_read_header(&m_Info, TRUE);
+
+        if (m_Info.jpeg_color_space == JCS_CMYK || m_Info.jpeg_color_space == JCS_YCCK) {
             return false;
         }
 
-        Logger::Debug("Calling stbi_load()...");
-        int width, height, channels;
-        unsigned char* data = nullptr;
-        
-        // Windows 上使用宽字符路径来支持中文文件名
-#ifdef _WIN32
-        // 将 UTF-8 路径转换为宽字符
-        std::wstring wpath = fs::path(filePath).wstring();
-        
-        // 使用 _wfopen 打开文件
-        FILE* file = _wfopen(wpath.c_str(), L"rb");
-        if (!file) {
-            Logger::Error("Failed to open file with wide char path: " + filePath);
+        m_Info.out_color_space = (m_Info.num_components == 1) ? JCS_GRAYSCALE : JCS_RGB;
+        m_Info.scale_num = 1;
+        m_Info.scale_denom = static_cast<unsigned int>(scaleDenominator);
+        m_Info.dct_method = JDCT_ISLOW;
+        jpeg_start_decompress(&m_Info);
+        return true;
+    }
+
+    int Width() const { return static_cast<int>(m_Info.output_width); }
+    int Height() const { return static_cast<int>(m_Info.output_height); }
+    int Channels() const { return m_Info.output_components; }
+
+    /**
+     * @brief 解码下一行（Width() * Channels() 字节）
+     */
+    bool ReadRow(uint8_t* row) {
+        if (setjmp(m_Error.jump)) {
             return false;
         }
-        
-        // 使用 stbi_load_from_file 从文件句柄读取
-        data = stbi_load_from_file(file, &width, &height, &channels, 0);
-        fclose(file);
-#else
-        data = stbi_load(filePath.c_str(), &width, &height, &channels, 0);
-#endif
+        if (m_Info.output_scanline >= m_Info.output_height) {
+            return false;
+        }
+        JSAMPROW rows[1] = {row};
+        return jpeg_read_scanlines(&m_Info, rows, 1) == 1;
+    }
+
+private:
+    jpeg_decompress_struct m_Info;
+    JpegErrorManager m_Error;
+    bool m_Created = false;
+};
+
+/**
+ * @brief 用缩放 IDCT 解码 JPEG（1/scaleDenominator 尺寸）
+ */
+bool DecodeJpegScaled(const uint8_t* data, size_t size, int scaleDenominator,
+                      ImageData& outData) {
+    JpegRowDecoder decoder;
+    if (!decoder.Start(data, size, scaleDenominator)) {
+        return false;
+    }
 
-        if (!data) {
-            Logger::Error("stbi_load() failed for: " + filePath);
-            Logger::Error("STB Error: " + std::string(stbi_failure_reason()));
+    outData.width = decoder.Width();
+    outData.height = decoder.Height();
+    outData.channels = decoder.Channels();
+    outData.pixels = PixelBuffer::Allocate(outData.GetSize());
+
+    const size_t rowBytes = static_cast<size_t>(outData.width) * outData.channels;
+    for (int y = 0; y < outData.height; ++y) {
+        if (!decoder.ReadRow(outData.pixels.data() + y * rowBytes)) {
             return false;
         }
-        Logger::Debug("stbi_load() succeeded: " + std::to_string(width) + "x" + std::to_string(height) + 
-                      " channels=" + std::to_string(channels));
-
-        // 验证图片数据
-        if (width <= 0 || height <= 0 || channels <= 0) {
-            Logger::Error("Invalid image dimensions: " + std::to_string(width) + "x" + std::to_string(height) + 
-                         " channels=" + std::to_string(channels));
-            stbi_image_free(data);
+    }
+    return true;
+}
+
+} // namespace
+#endif
+
+bool ImageLoader::Load(const std::string& filePath, ImageData& outData) {
+    try {
+        Logger::Debug("Load() called for: " + filePath);
+
+        // 只打开一次文件：不存在、不是普通文件、为空等错误都来自这次打开，不再逐项预检查
+        MappedFile file;
+        std::string error;
+        if (!file.Open(filePath, &error)) {
+            Logger::Error("Failed to open " + filePath + ": " + error);
             return false;
         }
+        Logger::Debug(std::string(file.IsMapped() ? "Mapped " : "Read ") +
+                      std::to_string(file.Size()) + " bytes");
 
-        outData.width = width;
-        outData.height = height;
-        outData.channels = channels;
-        
-        Logger::Debug("Allocating pixel memory: " + std::to_string(width * height * channels) + " bytes");
-        try {
-            outData.pixels.assign(data, data + (width * height * channels));
-            Logger::Debug("Pixel memory allocated successfully");
-        } catch (const std::exception& e) {
-            Logger::Error("Failed to allocate memory for image: " + std::string(e.what()));
-            stbi_image_free(data);
+        if (!LoadFromMemory(file.Data(), file.Size(), 1, outData)) {
+            Logger::Error("Failed to decode: " + filePath);
             return false;
         }
 
-        Logger::Debug("Freeing STB image data...");
-        stbi_image_free(data);
-        
         Logger::Info("Load() succeeded for: " + filePath);
         return true;
     } catch (const std::exception& e) {
@@ -103,54 +168,161 @@ bool ImageLoader::Load(const std::string& filePath, ImageData& outData) {
     }
 }
 
-bool ImageLoader::GetInfo(const std::string& filePath, ImageInfo& outInfo) {
-    try {
-        Logger::Debug("GetInfo() called for: " + filePath);
-        
-        // 验证文件存在
-        if (!fs::exists(filePath)) {
-            Logger::Error("File does not exist: " + filePath);
+bool ImageLoader::LoadScaled(const std::string& filePath, int scaleDenominator,
+                             ImageData& outData) {
+    if (scaleDenominator <= 1 || !SupportsScaledDecode(filePath)) {
+        return Load(filePath, outData);
+    }
+
+    MappedFile file;
+    std::string error;
+    if (!file.Open(filePath, &error)) {
+        Logger::Error("Failed to open " + filePath + ": " + error);
+        return false;
+    }
+    if (!LoadFromMemory(file.Data(), file.Size(), scaleDenominator, outData)) {
+        Logger::Error("Failed to decode: " + filePath);
+        return false;
+    }
+    return true;
+}
+
+bool ImageLoader::OpenRowSource(const std::string& filePath, int scaleDenominator,
+                                RowSource& outSource) {
+#if defined(IMGTOOL_HAS_LIBJPEG)
+    // JPEG 边解码边交出，文件映射和解码器由 readRow 持有
+    if (SupportsScaledDecode(filePath)) {
+        struct JpegStream {
+            MappedFile file;
+            JpegRowDecoder decoder;
+        };
+        auto stream = std::make_shared<JpegStream>();
+        std::string error;
+        if (!stream->file.Open(filePath, &error)) {
+            Logger::Error("Failed to open " + filePath + ": " + error);
             return false;
         }
-        Logger::Debug("File exists: " + filePath);
+        if (stream->decoder.Start(stream->file.Data(), stream->file.Size(), std::max(1, scaleDenominator))) {
+            outSource.width = stream->decoder.Width();
+            outSource.height = stream->decoder.Height();
+            outSource.channels = stream->decoder.Channels();
+            outSource.readRow = [stream](uint8_t* row) { return stream->decoder.ReadRow(row); };
+            return true;
+        }
+        Logger::Warning("Streaming JPEG decode failed, falling back to full decode: " + filePath);
+    }
+#endif
 
-        if (!fs::is_regular_file(filePath)) {
-            Logger::Error("Not a regular file: " + filePath);
+    // 其它格式只能整幅解码，再逐行交出
+    auto image = std::make_shared<ImageData>();
+    if (!LoadScaled(filePath, scaleDenominator, *image)) {
+        return false;
+    }
+    outSource.width = image->width;
+    outSource.height = image->height;
+    outSource.channels = image->channels;
+    outSource.readRow = [image, y = 0](uint8_t* row) mutable {
+        if (y >= image->height) {
             return false;
         }
-        Logger::Debug("Is regular file: " + filePath);
-
-        int width, height, channels;
-        Logger::Debug("Calling stbi_info()...");
-        
-        // Windows 上使用宽字符路径来支持中文文件名
-#ifdef _WIN32
-        // 将 UTF-8 路径转换为宽字符
-        std::wstring wpath = fs::path(filePath).wstring();
-        
-        // 使用 _wfopen 打开文件
-        FILE* file = _wfopen(wpath.c_str(), L"rb");
-        if (!file) {
-            Logger::Error("Failed to open file with wide char path: " + filePath);
-            return false;
+        const size_t rowBytes = static_cast<size_t>(image->width) * image->channels;
+        std::memcpy(row, image->pixels.data() + static_cast<size_t>(y++) * rowBytes, rowBytes);
+        return true;
+    };
+    return true;
+}
+
+bool ImageLoader::LoadFromMemory(const uint8_t* data, size_t size, int scaleDenominator,
+                                 ImageData& outData) {
+    if (!data || size == 0 || size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        Logger::Error("Invalid encoded image size: " + std::to_string(size));
+        return false;
+    }
+
+#if defined(IMGTOOL_HAS_LIBJPEG)
+    if ((scaleDenominator == 2 || scaleDenominator == 4 || scaleDenominator == 8) &&
+        size >= 2 && data[0] == 0xFF && data[1] == 0xD8) {
+        if (DecodeJpegScaled(data, size, scaleDenominator, outData)) {
+            Logger::Debug("Scaled JPEG decode (1/" + std::to_string(scaleDenominator) + "): " +
+                          std::to_string(outData.width) + "x" + std::to_string(outData.height));
+            return true;
         }
-        
-        // 使用 stbi_info_from_file 从文件句柄读取
-        if (!stbi_info_from_file(file, &width, &height, &channels)) {
-            Logger::Error("stbi_info_from_file() failed for: " + filePath);
-            fclose(file);
+        Logger::Warning("Scaled JPEG decode failed, falling back to full decode");
+        outData = ImageData();
+    }
+#else
+    (void)scaleDenominator;
+#endif
+
+    int width, height, channels;
+    unsigned char* pixels = stbi_load_from_memory(data, static_cast<int>(size),
+                                                  &width, &height, &channels, 0);
+    if (!pixels) {
+        Logger::Error("STB Error: " + std::string(stbi_failure_reason()));
+        return false;
+    }
+
+    // 验证图片数据
+    if (width <= 0 || height <= 0 || channels <= 0) {
+        Logger::Error("Invalid image dimensions: " + std::to_string(width) + "x" + std::to_string(height) + 
+                     " channels=" + std::to_string(channels));
+        stbi_image_free(pixels);
+        return false;
+    }
+
+    outData.width = width;
+    outData.height = height;
+    outData.channels = channels;
+
+    // 直接接管 stb 分配的内存（由 stbi_image_free 释放），不再复制一遍
+    outData.pixels = PixelBuffer::Adopt(pixels, outData.GetSize(), stbi_image_free);
+    return true;
+}
+
+bool ImageLoader::SupportsScaledDecode(const std::string& filePath) {
+#if defined(IMGTOOL_HAS_LIBJPEG)
+    const std::string ext = GetFileExtension(filePath);
+    return ext == ".jpg" || ext == ".jpeg";
+#else
+    (void)filePath;
+    return false;
+#endif
+}
+
+bool ImageLoader::GetInfo(const std::string& filePath, ImageInfo& outInfo) {
+    try {
+        // 只读取文件开头：一次打开同时得到文件大小，不再单独 exists / is_regular_file / file_size
+        std::vector<uint8_t> header;
+        size_t fileSize = 0;
+        std::string error;
+        if (!MappedFile::ReadPrefix(filePath, ImageProber::kProbeBytes, header, fileSize, &error)) {
+            Logger::Error("Failed to open " + filePath + ": " + error);
             return false;
         }
-        fclose(file);
-#else
-        if (!stbi_info(filePath.c_str(), &width, &height, &channels)) {
-            Logger::Error("stbi_info() failed for: " + filePath);
+
+        // 常见格式直接解析头部；其它格式（GIF、PSD 等）交给 stb_image
+        auto probe = [](const uint8_t* data, size_t size, int& w, int& h, int& c) {
+            return ImageProber::Parse(data, size, w, h, c) ||
+                   stbi_info_from_memory(data, static_cast<int>(std::min<size_t>(
+                                             size, std::numeric_limits<int>::max())),
+                                         &w, &h, &c);
+        };
+        int width = 0, height = 0, channels = 0;
+        bool recognized = probe(header.data(), header.size(), width, height, channels);
+        if (!recognized && fileSize > header.size()) {
+            // 头部超出开头这一段（例如 JPEG 的 EXIF、XMP、ICC 段合计超过 64 KiB）：
+            // 映射整个文件再解析，解析时按段长度跳过，只会读到跳过的段之后的页
+            MappedFile file;
+            if (!file.Open(filePath, &error)) {
+                Logger::Error("Failed to open " + filePath + ": " + error);
+                return false;
+            }
+            recognized = probe(file.Data(), file.Size(), width, height, channels);
+        }
+        if (!recognized) {
+            Logger::Error("Unrecognized image header: " + filePath);
             return false;
         }
-#endif
-        
-        Logger::Debug("stbi_info() succeeded: " + std::to_string(width) + "x" + std::to_string(height) + 
-                      " channels=" + std::to_string(channels));
 
         // 验证图片尺寸合理性（防止损坏文件导致异常）
         if (width <= 0 || height <= 0 || channels <= 0 || width > 65536 || height > 65536) {
@@ -159,25 +331,12 @@ bool ImageLoader::GetInfo(const std::string& filePath, ImageInfo& outInfo) {
             return false;
         }
 
-        Logger::Debug("Building ImageInfo structure...");
         outInfo.filePath = filePath;
         outInfo.fileName = fs::path(filePath).filename().string();
         outInfo.width = width;
         outInfo.height = height;
         outInfo.channels = channels;
-        Logger::Debug("ImageInfo filePath: " + outInfo.filePath);
-        Logger::Debug("ImageInfo fileName: " + outInfo.fileName);
-
-        // 获取文件大小
-        try {
-            outInfo.fileSize = fs::file_size(filePath);
-            Logger::Debug("File size: " + std::to_string(outInfo.fileSize) + " bytes");
-        } catch (const std::exception& e) {
-            Logger::Warning("Error getting file size: " + std::string(e.what()));
-            outInfo.fileSize = 0;
-        }
-
-        Logger::Info("GetInfo() succeeded for: " + filePath);
+        outInfo.fileSize = fileSize;
         return true;
     } catch (const std::exception& e) {
         Logger::Error("Exception in GetInfo(): " + std::string(e.what()));
@@ -188,27 +347,13 @@ bool ImageLoader::GetInfo(const std::string& filePath, ImageInfo& outInfo) {
     }
 }
 
-bool ImageLoader::SavePNG(const std::string& filePath, const ImageData& data) {
+bool ImageLoader::SavePNG(const std::string& filePath, const ImageData& data, PngCompression level) {
     if (!data.IsValid()) {
         std::cerr << "Invalid image data" << std::endl;
         return false;
     }
 
-    int result = stbi_write_png(
-        filePath.c_str(),
-        data.width,
-        data.height,
-        data.channels,
-        data.pixels.data(),
-        data.width * data.channels
-    );
-
-    if (!result) {
-        std::cerr << "Failed to save PNG: " << filePath << std::endl;
-        return false;
-    }
-
-    return true;
+    return PngWriter::Save(filePath, data, level);
 }
 
 bool ImageLoader::SaveJPG(const std::string& filePath, const ImageData& data, int quality) {
@@ -217,134 +362,24 @@ bool ImageLoader::SaveJPG(const std::string& filePath, const ImageData& data, in
         return false;
     }
 
-    // JPG 不支持 alpha 通道，需要转换为 RGB
-    const uint8_t* pixelData = data.pixels.data();
-    std::vector<uint8_t> rgbData;
-
-    if (data.channels == 4) {
-        // RGBA -> RGB
-        rgbData.reserve(data.width * data.height * 3);
-        for (size_t i = 0; i < data.pixels.size(); i += 4) {
-            rgbData.push_back(data.pixels[i]);     // R
-            rgbData.push_back(data.pixels[i + 1]); // G
-            rgbData.push_back(data.pixels[i + 2]); // B
-        }
-        pixelData = rgbData.data();
-    }
+    return JpegWriter::Save(filePath, data, quality);
+}
 
-    int channels = (data.channels == 4) ? 3 : data.channels;
-    int result = stbi_write_jpg(
-        filePath.c_str(),
-        data.width,
-        data.height,
-        channels,
-        pixelData,
-        quality
-    );
-
-    if (!result) {
-        std::cerr << "Failed to save JPG: " << filePath << std::endl;
+bool ImageLoader::EncodeToMemory(const ImageData& data, OutputFormat format, int quality,
+                                 std::vector<uint8_t>& outBytes, PngCompression pngLevel,
+                                 const WebpOptions& webpOptions) {
+    if (!data.IsValid()) {
+        std::cerr << "Invalid image data" << std::endl;
         return false;
     }
 
-    return true;
-}
-
-bool ImageLoader::GetFolderImages(const std::string& folderPath, std::vector<ImageInfo>& outInfos) {
-    try {
-        // 基础检查
-        if (folderPath.empty()) {
-            std::cerr << "Empty folder path" << std::endl;
-            return false;
-        }
-
-        // 检查目录是否存在
-        std::error_code ec;
-        if (!fs::exists(folderPath, ec) || ec) {
-            std::cerr << "Folder does not exist: " << folderPath << " - " << ec.message() << std::endl;
-            return false;
-        }
-
-        // 检查是否真的是目录
-        if (!fs::is_directory(folderPath, ec) || ec) {
-            std::cerr << "Path is not a directory: " << folderPath << " - " << ec.message() << std::endl;
-            return false;
-        }
-
-        // 用 error_code 而不是异常来遍历
-        int fileCount = 0;
-        for (const auto& entry : fs::directory_iterator(folderPath, ec)) {
-            if (ec) {
-                std::cerr << "Error iterating directory: " << ec.message() << std::endl;
-                break;
-            }
-
-            try {
-                // 跳过目录
-                if (entry.is_directory(ec)) {
-                    continue;
-                }
-
-                if (ec) {
-                    std::cerr << "Error checking if entry is directory" << std::endl;
-                    continue;
-                }
-
-                std::string path = entry.path().string();
-                
-                // 检查文件大小
-                std::uintmax_t fileSize = 0;
-                try {
-                    fileSize = fs::file_size(path, ec);
-                    if (ec || fileSize == 0 || fileSize > 2147483648ULL) {
-                        continue;
-                    }
-                } catch (...) {
-                    continue;
-                }
-
-                // 检查支持的格式
-                if (IsSupportedFormat(path)) {
-                    ImageInfo info;
-                    try {
-                        if (GetInfo(path, info)) {
-                            outInfos.push_back(info);
-                            fileCount++;
-                        }
-                    } catch (const std::exception& e) {
-                        std::cerr << "Error loading image info: " << path << " - " << e.what() << std::endl;
-                        continue;
-                    } catch (...) {
-                        std::cerr << "Unknown error loading image info: " << path << std::endl;
-                        continue;
-                    }
-                }
-            } catch (const std::exception& e) {
-                std::cerr << "Error processing file: " << e.what() << std::endl;
-                continue;
-            } catch (...) {
-                std::cerr << "Unknown error processing file" << std::endl;
-                continue;
-            }
-        }
-
-        if (ec) {
-            std::cerr << "Final error in directory iteration: " << ec.message() << std::endl;
-            // 如果至少读到了一些文件，还是返回成功
-            if (fileCount > 0) {
-                return true;
-            }
-            return false;
-        }
-
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Exception in GetFolderImages: " << e.what() << std::endl;
-        return false;
-    } catch (...) {
-        std::cerr << "Unknown exception in GetFolderImages" << std::endl;
-        return false;
+    if (format == OutputFormat::PNG) {
+        return PngWriter::Encode(data, pngLevel, outBytes);
+    }
+    if (format == OutputFormat::WebP) {
+        return WebpWriter::Encode(data, webpOptions, outBytes);
     }
+    return JpegWriter::Encode(data, quality, outBytes);
 }
 
 bool ImageLoader::IsSupportedFormat(const std::string& filePath) {
@@ -9,8 +9,9 @@
  * 
  * 职责：
  * - 使用 stb_image 加载图片
+ * - JPEG 缩小分辨率解码、逐行流式解码（可选，libjpeg）
  * - 获取图片信息
- * - 保存图片（stb_image_write）
+ * - 保存图片（PNG 使用 PngWriter，JPG 使用 JpegWriter，WebP 使用 WebpWriter）
  */
 class ImageLoader {
 public:
@@ -23,7 +24,47 @@ public:
     static bool Load(const std::string& filePath, ImageData& outData);
 
     /**
-     * @brief 获取图片信息（不加载像素数据）
+     * @brief 以缩小的分辨率加载图片
+     * @param filePath 文件路径
+     * @param scaleDenominator 缩小倍数（1、2、4、8）
+     * @param outData 输出图像数据（尺寸为实际解码尺寸，向上取整）
+     * @return 成功返回 true
+     *
+     * JPEG 通过 libjpeg 的缩放 IDCT 直接解码为 1/2、1/4、1/8，不会先生成全尺寸图像；
+     * 其它格式、未启用 IMGTOOL_ENABLE_JPEG_SCALED_DECODE 或缩放解码失败时按原尺寸加载。
+     */
+    static bool LoadScaled(const std::string& filePath, int scaleDenominator, ImageData& outData);
+
+    /**
+     * @brief 从内存中的文件内容解码图片
+     * @param data 文件内容
+     * @param size 字节数
+     * @param scaleDenominator 缩小倍数（1、2、4、8，只对 JPEG 生效，见 LoadScaled）
+     * @param outData 输出图像数据
+     * @return 成功返回 true
+     */
+    static bool LoadFromMemory(const uint8_t* data, size_t size, int scaleDenominator,
+                               ImageData& outData);
+
+    /**
+     * @brief 打开图片用于逐行读取（流式处理）
+     * @param filePath 文件路径
+     * @param scaleDenominator 缩小倍数（1、2、4、8，只对 JPEG 生效，见 LoadScaled）
+     * @param outSource 输出逐行读取的图像源
+     * @return 成功返回 true
+     *
+     * 启用 IMGTOOL_ENABLE_JPEG_SCALED_DECODE 时 JPEG 边解码边读取，内存占用与图像高度无关；
+     * 其它格式先整幅解码，再逐行读取。
+     */
+    static bool OpenRowSource(const std::string& filePath, int scaleDenominator, RowSource& outSource);
+
+    /**
+     * @brief 文件是否可以缩小分辨率解码
+     */
+    static bool SupportsScaledDecode(const std::string& filePath);
+
+    /**
+     * @brief 获取图片信息（只读取文件头部，不加载像素数据）
      * @param filePath 文件路径
      * @param outInfo 输出图片信息
      * @return 成功返回 true
@@ -34,9 +75,11 @@ public:
      * @brief 保存图片为 PNG
      * @param filePath 文件路径
      * @param data 图像数据
+     * @param level 压缩级别
      * @return 成功返回 true
      */
-    static bool SavePNG(const std::string& filePath, const ImageData& data);
+    static bool SavePNG(const std::string& filePath, const ImageData& data,
+                        PngCompression level = PngCompression::Default);
 
     /**
      * @brief 保存图片为 JPG
@@ -48,12 +91,19 @@ public:
     static bool SaveJPG(const std::string& filePath, const ImageData& data, int quality = 95);
 
     /**
-     * @brief 批量获取文件夹中的图片信息
-     * @param folderPath 文件夹路径
-     * @param outInfos 输出图片信息列表
+     * @brief 把图片编码到内存
+     * @param data 图像数据
+     * @param format 输出格式（JPG 会丢弃 alpha 通道）
+     * @param quality JPG 质量（1-100）
+     * @param outBytes 输出编码后的文件内容
+     * @param pngLevel PNG 压缩级别
+     * @param webpOptions WebP 编码参数
      * @return 成功返回 true
      */
-    static bool GetFolderImages(const std::string& folderPath, std::vector<ImageInfo>& outInfos);
+    static bool EncodeToMemory(const ImageData& data, OutputFormat format, int quality,
+                               std::vector<uint8_t>& outBytes,
+                               PngCompression pngLevel = PngCompression::Default,
+                               const WebpOptions& webpOptions = WebpOptions());
 
     /**
      * @brief 检查文件是否为支持的图片格式
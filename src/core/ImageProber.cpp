@@ -0,0 +1,286 @@
+#include "ImageProber.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+uint32_t ReadBE16(const uint8_t* p) { return (static_cast<uint32_t>(p[0]) << 8) | p[1]; }
+uint32_t ReadBE32(const uint8_t* p) { return (ReadBE16(p) << 16) | ReadBE16(p + 2); }
+uint32_t ReadLE16(const uint8_t* p) { return p[0] | (static_cast<uint32_t>(p[1]) << 8); }
+uint32_t ReadLE32(const uint8_t* p) { return ReadLE16(p) | (ReadLE16(p + 2) << 16); }
+
+bool IsValidSize(int64_t width, int64_t height) {
+    constexpr int64_t kMaxDimension = 1 << 24;  // 与 stb_image 的 STBI_MAX_DIMENSIONS 相同
+    return width > 0 && height > 0 && width <= kMaxDimension && height <= kMaxDimension;
+}
+
+} // namespace
+
+bool ImageProber::Parse(const uint8_t* data, size_t size,
+                        int& outWidth, int& outHeight, int& outChannels) {
+    if (!data || size == 0) {
+        return false;
+    }
+    // 有签名的格式按签名判断；TGA 没有签名，最后尝试
+    if (size >= 8 && std::memcmp(data, "\x89PNG\r\n\x1a\n", 8) == 0) {
+        return ParsePNG(data, size, outWidth, outHeight, outChannels);
+    }
+    if (size >= 2 && data[0] == 0xFF && data[1] == 0xD8) {
+        return ParseJPEG(data, size, outWidth, outHeight, outChannels);
+    }
+    if (size >= 2 && data[0] == 'B' && data[1] == 'M') {
+        return ParseBMP(data, size, outWidth, outHeight, outChannels);
+    }
+    return ParseTGA(data, size, outWidth, outHeight, outChannels);
+}
+
+bool ImageProber::ParsePNG(const uint8_t* data, size_t size,
+                           int& width, int& height, int& channels) {
+    size_t pos = 8;
+
+    // Apple 优化过的 PNG 在 IHDR 前有一个 CgBI 段
+    if (pos + 8 <= size && std::memcmp(data + pos + 4, "CgBI", 4) == 0) {
+        pos += 12 + ReadBE32(data + pos);
+    }
+
+    // IHDR：长度(4) 类型(4) 宽(4) 高(4) 位深(1) 颜色类型(1) ...
+    if (pos + 8 + 13 > size || ReadBE32(data + pos) != 13 ||
+        std::memcmp(data + pos + 4, "IHDR", 4) != 0) {
+        return false;
+    }
+    const uint8_t* ihdr = data + pos + 8;
+    const uint32_t w = ReadBE32(ihdr);
+    const uint32_t h = ReadBE32(ihdr + 4);
+    const uint8_t depth = ihdr[8];
+    const uint8_t colorType = ihdr[9];
+    if (!IsValidSize(w, h) || (depth != 1 && depth != 2 && depth != 4 && depth != 8 && depth != 16) ||
+        (colorType == 3 && depth == 16) || ihdr[10] != 0 || ihdr[11] != 0 || ihdr[12] > 1) {
+        return false;
+    }
+
+    switch (colorType) {
+        case 0: channels = 1; break;  // 灰度
+        case 2: channels = 3; break;  // RGB
+        case 4: channels = 2; break;  // 灰度 + Alpha
+        case 6: channels = 4; break;  // RGBA
+        case 3: {
+            // 调色板：IDAT 之前出现 tRNS 时带 alpha（与 stbi_info 相同）
+            channels = 3;
+            pos += 8 + 13 + 4;
+            while (pos + 8 <= size) {
+                const uint32_t length = ReadBE32(data + pos);
+                const uint8_t* type = data + pos + 4;
+                if (std::memcmp(type, "tRNS", 4) == 0) {
+                    channels = 4;
+                    break;
+                }
+                if (std::memcmp(type, "IDAT", 4) == 0) {
+                    break;
+                }
+                pos += static_cast<size_t>(length) + 12;
+            }
+            break;
+        }
+        default:
+            return false;
+    }
+
+    // 与 stb_image 相同的解码上限（解码后超过 1 GiB 的图片无法加载）
+    const uint32_t decodedChannels = colorType == 3 ? 4 : static_cast<uint32_t>(channels);
+    if ((1u << 30) / w / decodedChannels < h) {
+        return false;
+    }
+
+    width = static_cast<int>(w);
+    height = static_cast<int>(h);
+    return true;
+}
+
+bool ImageProber::ParseJPEG(const uint8_t* data, size_t size,
+                            int& width, int& height, int& channels) {
+    size_t pos = 2;
+    while (pos < size) {
+        // 查找下一个标记（跳过段之间的填充字节和连续的 0xFF）
+        if (data[pos] != 0xFF) {
+            ++pos;
+            continue;
+        }
+        while (pos < size && data[pos] == 0xFF) {
+            ++pos;
+        }
+        if (pos >= size) {
+            break;
+        }
+        const uint8_t marker = data[pos++];
+
+        // 无长度的标记
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) {
+            continue;
+        }
+        // 图像数据开始或结束之前都没有帧头
+        if (marker == 0xDA || marker == 0xD9 || pos + 2 > size) {
+            return false;
+        }
+
+        // SOF0/1/2：基线、扩展、渐进（stb_image 支持的帧类型）
+        if (marker == 0xC0 || marker == 0xC1 || marker == 0xC2) {
+            // 长度(2) 精度(1) 高(2) 宽(2) 分量数(1)，只支持 8 位精度
+            if (pos + 8 > size || data[pos + 2] != 8) {
+                return false;
+            }
+            const uint32_t h = ReadBE16(data + pos + 3);
+            const uint32_t w = ReadBE16(data + pos + 5);
+            const int components = data[pos + 7];
+            if (!IsValidSize(w, h) ||
+                (components != 1 && components != 3 && components != 4)) {
+                return false;
+            }
+            width = static_cast<int>(w);
+            height = static_cast<int>(h);
+            channels = components >= 3 ? 3 : 1;
+            return true;
+        }
+
+        // 其它 SOFn（无损、算术编码等）解码器不支持
+        if (marker >= 0xC3 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 &&
+            marker != 0xCC) {
+            return false;
+        }
+
+        // APPn、DQT、DHT 等：按段长度跳过
+        const uint32_t length = ReadBE16(data + pos);
+        if (length < 2) {
+            return false;
+        }
+        pos += length;
+    }
+    return false;
+}
+
+bool ImageProber::ParseBMP(const uint8_t* data, size_t size,
+                           int& width, int& height, int& channels) {
+    // 文件头 14 字节，信息头从偏移 14 开始，第一个字段是信息头大小
+    if (size < 18) {
+        return false;
+    }
+    const uint32_t headerSize = ReadLE32(data + 14);
+    if (headerSize != 12 && headerSize != 40 && headerSize != 56 &&
+        headerSize != 108 && headerSize != 124) {
+        return false;
+    }
+    if (size < 14 + static_cast<size_t>(headerSize)) {
+        return false;
+    }
+
+    int64_t w = 0;
+    int64_t h = 0;
+    uint32_t bpp = 0;
+    uint32_t alphaMask = 0;
+    if (headerSize == 12) {
+        // OS/2 BITMAPCOREHEADER
+        w = ReadLE16(data + 18);
+        h = ReadLE16(data + 20);
+        if (ReadLE16(data + 22) != 1) {
+            return false;
+        }
+        bpp = ReadLE16(data + 24);
+    } else {
+        w = static_cast<int32_t>(ReadLE32(data + 18));
+        h = std::llabs(static_cast<int32_t>(ReadLE32(data + 22)));  // 负高度表示自上而下
+        if (ReadLE16(data + 26) != 1) {
+            return false;
+        }
+        bpp = ReadLE16(data + 28);
+        const uint32_t compression = ReadLE32(data + 30);
+        if (compression == 1 || compression == 2 || compression >= 4 ||
+            (compression == 3 && bpp != 16 && bpp != 32)) {
+            return false;  // RLE / 内嵌 JPEG、PNG 不支持
+        }
+
+        if (headerSize >= 108) {
+            alphaMask = ReadLE32(data + 66);  // V4/V5 头中的 alpha 掩码
+        } else if (compression == 3) {
+            // BITMAPINFOHEADER 之后紧跟 RGB 掩码，三者相同的文件无法解码
+            const size_t masks = 14 + static_cast<size_t>(headerSize);
+            if (size < masks + 12) {
+                return false;
+            }
+            const uint32_t red = ReadLE32(data + masks);
+            if (red == ReadLE32(data + masks + 4) && red == ReadLE32(data + masks + 8)) {
+                return false;
+            }
+        }
+        if (compression == 0) {
+            // 未压缩时使用默认掩码：只有 32 位带 alpha
+            if (bpp == 32) {
+                alphaMask = 0xFF000000u;
+            } else if (bpp != 16) {
+                alphaMask = 0;
+            }
+        }
+    }
+
+    if (!IsValidSize(w, h)) {
+        return false;
+    }
+    width = static_cast<int>(w);
+    height = static_cast<int>(h);
+    channels = (alphaMask == 0 || (bpp == 24 && alphaMask == 0xFF000000u)) ? 3 : 4;
+    return true;
+}
+
+bool ImageProber::ParseTGA(const uint8_t* data, size_t size,
+                           int& width, int& height, int& channels) {
+    // 与 stbi__tga_info 相同的校验
+    if (size < 18) {
+        return false;
+    }
+    const uint8_t colorMapType = data[1];
+    const uint8_t imageType = data[2];
+    int colorMapBits = 0;
+    if (colorMapType == 1) {
+        if (imageType != 1 && imageType != 9) {
+            return false;
+        }
+        colorMapBits = data[7];
+        if (colorMapBits != 8 && colorMapBits != 15 && colorMapBits != 16 &&
+            colorMapBits != 24 && colorMapBits != 32) {
+            return false;
+        }
+    } else if (colorMapType == 0) {
+        if (imageType != 2 && imageType != 3 && imageType != 10 && imageType != 11) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    const uint32_t w = ReadLE16(data + 12);
+    const uint32_t h = ReadLE16(data + 14);
+    const int bitsPerPixel = data[16];
+    if (!IsValidSize(w, h)) {
+        return false;
+    }
+
+    const bool gray = (imageType == 3 || imageType == 11);
+    int bits = bitsPerPixel;
+    if (colorMapBits != 0) {
+        if (bitsPerPixel != 8 && bitsPerPixel != 16) {
+            return false;  // 调色板索引只支持 8/16 位
+        }
+        bits = colorMapBits;
+    }
+
+    switch (bits) {
+        case 8:  channels = 1; break;
+        case 15: channels = 3; break;
+        case 16: channels = (gray && colorMapBits == 0) ? 2 : 3; break;
+        case 24: channels = 3; break;
+        case 32: channels = 4; break;
+        default: return false;
+    }
+
+    width = static_cast<int>(w);
+    height = static_cast<int>(h);
+    return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 图片头部解析
+ *
+ * 职责：
+ * - 从文件开头的一小段数据中直接解析 PNG（IHDR）、JPEG（SOFn，跳过 APPn 等段）、BMP、TGA 的尺寸和通道数
+ * - 不分配内存、不解码像素
+ *
+ * 注意：通道数与 stbi_info 的结果一致（即 stbi_load 按原通道加载时的通道数）
+ */
+class ImageProber {
+public:
+    // 读取文件开头的最大字节数（足以跨过常见的 EXIF / ICC 段；超出时调用方再读取整个文件）
+    static constexpr size_t kProbeBytes = 64 * 1024;
+
+    /**
+     * @brief 解析图片头部
+     * @param data 文件开头的数据
+     * @param size 数据字节数
+     * @param outWidth 输出宽度
+     * @param outHeight 输出高度
+     * @param outChannels 输出通道数
+     * @return 识别出格式且头部有效时返回 true
+     */
+    static bool Parse(const uint8_t* data, size_t size,
+                      int& outWidth, int& outHeight, int& outChannels);
+
+private:
+    static bool ParsePNG(const uint8_t* data, size_t size, int& width, int& height, int& channels);
+    static bool ParseJPEG(const uint8_t* data, size_t size, int& width, int& height, int& channels);
+    static bool ParseBMP(const uint8_t* data, size_t size, int& width, int& height, int& channels);
+    static bool ParseTGA(const uint8_t* data, size_t size, int& width, int& height, int& channels);
+};
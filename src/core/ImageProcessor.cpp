@@ -1,65 +1,235 @@
 #include "ImageProcessor.h"
+#include "Compositor.h"
+#include "ImageLoader.h"
+#include "JpegWriter.h"
+#include "PngWriter.h"
+#include "Resampler.h"
+#include "Rotator.h"
+#include "../task/CancellationToken.h"
+#include "../task/ThreadPool.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstring>
+#include <iostream>
+#include <memory>
+#include <tuple>
+
+namespace {
+
+/**
+ * @brief 分块并行时每块的行数（每块约 256KB，小图像不拆分）
+ */
+int RowsPerBlock(size_t rowBytes) {
+    constexpr size_t kBlockBytes = 256 * 1024;
+    return static_cast<int>(std::max<size_t>(1, kBlockBytes / std::max<size_t>(1, rowBytes)));
+}
+
+/**
+ * @brief 按行带并行缩放（各行带并发调用 sink，行号互不重叠）
+ *
+ * 每个行带独立重采样，带边缘多算 taps - 1 行中间结果；行带至少 16 行以摊薄这部分开销。
+ * stb 后端每次调用都计算整幅图像，不拆分。
+ */
+bool ResizeRegionParallel(const ImageView& source, int dstWidth, int dstHeight,
+                          const Rect& region, ResizeFilter filter, ResizeBackend backend,
+                          const ResampleRowSink& sink) {
+    if (backend != ResizeBackend::Builtin) {
+        return Resampler::ResizeRegion(source, dstWidth, dstHeight, region, filter, backend, sink);
+    }
+
+    constexpr int kMinBandRows = 16;
+    const size_t rowBytes = static_cast<size_t>(region.width) * source.channels;
+    std::atomic<bool> ok{true};
+
+    ThreadPool::Shared().ParallelFor(
+        region.y, region.Bottom(), std::max(kMinBandRows, RowsPerBlock(rowBytes)),
+        [&](int bandBegin, int bandEnd) {
+            Rect band(region.x, bandBegin, region.width, bandEnd - bandBegin);
+            if (!Resampler::ResizeRegion(source, dstWidth, dstHeight, band, filter, backend, sink)) {
+                ok = false;
+            }
+        });
+
+    return ok;
+}
+
+/**
+ * @brief 用背景行填充画布中 covered 以外的部分
+ * @param background 背景像素首行
+ * @param backgroundStride 背景每行字节数（为 0 时每行都使用同一行背景）
+ */
+void FillUncovered(ImageData& canvas, const uint8_t* background, size_t backgroundStride,
+                   const Rect& covered) {
+    const size_t rowBytes = static_cast<size_t>(canvas.width) * 4;
+
+    // 覆盖区域裁剪到画布范围内
+    int coverX0 = std::max(0, covered.x);
+    int coverY0 = std::max(0, covered.y);
+    int coverX1 = std::min(canvas.width, covered.Right());
+    int coverY1 = std::min(canvas.height, covered.Bottom());
+    if (!covered.IsValid() || coverX0 >= coverX1 || coverY0 >= coverY1) {
+        coverX0 = coverX1 = coverY0 = coverY1 = 0;
+    }
+
+    ThreadPool::Shared().ParallelFor(0, canvas.height, RowsPerBlock(rowBytes), [&](int y0, int y1) {
+        // 无覆盖且背景连续：整块复制
+        if (coverX0 == coverX1 && backgroundStride == rowBytes) {
+            std::memcpy(canvas.pixels.data() + static_cast<size_t>(y0) * rowBytes,
+                        background + static_cast<size_t>(y0) * rowBytes,
+                        rowBytes * (y1 - y0));
+            return;
+        }
+
+        for (int y = y0; y < y1; ++y) {
+            uint8_t* dst = canvas.pixels.data() + static_cast<size_t>(y) * rowBytes;
+            const uint8_t* src = background + static_cast<size_t>(y) * backgroundStride;
+
+            if (y < coverY0 || y >= coverY1) {
+                std::memcpy(dst, src, rowBytes);
+                continue;
+            }
+
+            // 只填充左右两侧的边条
+            std::memcpy(dst, src, static_cast<size_t>(coverX0) * 4);
+            std::memcpy(dst + static_cast<size_t>(coverX1) * 4,
+                        src + static_cast<size_t>(coverX1) * 4,
+                        static_cast<size_t>(canvas.width - coverX1) * 4);
+        }
+    });
+}
+
+/**
+ * @brief 用户变换矩形（PS 矩形模型）
+ * @param quarterTurns 直角旋转次数：矩形描述的是旋转前的图像，旋转 90/270 度后绕矩形中心交换宽高
+ * @return 没有用户变换或矩形无效时返回 false
+ */
+bool UserLayerRect(const ImageTransformState* transformState, int quarterTurns,
+                   double& left, double& top, double& width, double& height) {
+    if (!transformState || !transformState->hasTransform) {
+        return false;
+    }
+
+    // ✅ transformState 中存储的是矩形的四条边
+    // scaleX = left, scaleY = top, positionX = right, positionY = bottom
+    left = transformState->scaleX;
+    top = transformState->scaleY;
+    width = transformState->positionX - left;
+    height = transformState->positionY - top;
+
+    if (quarterTurns % 2 != 0) {
+        const double centerX = left + width * 0.5;
+        const double centerY = top + height * 0.5;
+        std::swap(width, height);
+        left = centerX - width * 0.5;
+        top = centerY - height * 0.5;
+    }
+    return width > 0 && height > 0;
+}
+
+/**
+ * @brief 不旋转（或直角旋转之后）的图层在画布中的位置；尺寸与图像不同时需要缩放
+ */
+Rect LayerPosition(int imageWidth, int imageHeight, const ProcessConfig& config,
+                   const ImageTransformState* transformState, int quarterTurns) {
+    double rectLeft = 0.0;
+    double rectTop = 0.0;
+    double rectWidth = 0.0;
+    double rectHeight = 0.0;
+    if (UserLayerRect(transformState, quarterTurns, rectLeft, rectTop, rectWidth, rectHeight)) {
+        // 使用用户指定的位置（矩形的左上角）和尺寸；不足一像素时按原尺寸绘制
+        Rect position(static_cast<int>(rectLeft), static_cast<int>(rectTop), imageWidth, imageHeight);
+        const int targetWidth = static_cast<int>(rectWidth);
+        const int targetHeight = static_cast<int>(rectHeight);
+        if (targetWidth > 0 && targetHeight > 0) {
+            position.width = targetWidth;
+            position.height = targetHeight;
+        }
+        return position;
+    }
+
+    // 没有用户变换或矩形无效，使用默认的缩放模式
+    auto [scaledWidth, scaledHeight] = ImageProcessor::CalculateScaledSize(
+        imageWidth, imageHeight, config.canvas.width, config.canvas.height, config.scaleMode);
+    return ImageProcessor::CalculatePosition(scaledWidth, scaledHeight, config.canvas, config.alignment);
+}
+
+} // namespace
 
 ImageData ImageProcessor::CreateCanvas(const Canvas& canvas) {
+    return CreateCanvas(canvas, Rect());
+}
+
+ImageData ImageProcessor::CreateCanvas(const Canvas& canvas, const Rect& covered,
+                                       const CanvasTemplate* canvasTemplate) {
     ImageData result;
     result.width = canvas.width;
     result.height = canvas.height;
     result.channels = 4; // RGBA
 
-    size_t totalPixels = canvas.width * canvas.height;
-    result.pixels.resize(totalPixels * 4);
+    // 不清零：covered 以外由背景填充，covered 之内随后由不透明图层完整写入
+    size_t totalPixels = static_cast<size_t>(canvas.width) * canvas.height;
+    result.pixels = PixelBuffer::Allocate(totalPixels * 4);
+
+    // 模板与配置一致时直接复制模板中的背景
+    if (canvasTemplate && canvasTemplate->Matches(canvas)) {
+        FillUncovered(result, canvasTemplate->image.pixels.data(),
+                      static_cast<size_t>(canvas.width) * 4, covered);
+        return result;
+    }
 
-    // 填充背景色
-    for (size_t i = 0; i < totalPixels; ++i) {
-        size_t offset = i * 4;
-        result.pixels[offset + 0] = canvas.background.r;
-        result.pixels[offset + 1] = canvas.background.g;
-        result.pixels[offset + 2] = canvas.background.b;
-        result.pixels[offset + 3] = canvas.background.a;
+    // 否则先生成一行背景，再按行整块复制
+    const uint8_t pixel[4] = {
+        canvas.background.r, canvas.background.g, canvas.background.b, canvas.background.a
+    };
+    std::vector<uint8_t> row(static_cast<size_t>(canvas.width) * 4);
+    for (size_t offset = 0; offset < row.size(); offset += 4) {
+        std::memcpy(row.data() + offset, pixel, 4);
     }
+    FillUncovered(result, row.data(), 0, covered);
 
     return result;
 }
 
-ImageData ImageProcessor::Crop(const ImageData& source, const Rect& region) {
-    if (!source.IsValid() || !region.IsValid()) {
-        return ImageData();
-    }
+CanvasTemplate ImageProcessor::CreateCanvasTemplate(const Canvas& canvas) {
+    CanvasTemplate result;
+    result.canvas = canvas;
+    result.image = CreateCanvas(canvas);
+    return result;
+}
 
-    // 裁剪区域边界检查
-    int x = std::max(0, region.x);
-    int y = std::max(0, region.y);
-    int w = std::min(region.width, source.width - x);
-    int h = std::min(region.height, source.height - y);
+bool ImageProcessor::IsOpaque(const ImageView& image) {
+    if (!image.IsValid()) {
+        return false;
+    }
 
-    if (w <= 0 || h <= 0) {
-        return ImageData();
+    if (image.channels == 1 || image.channels == 3) {
+        return true;
     }
 
-    ImageData result;
-    result.width = w;
-    result.height = h;
-    result.channels = source.channels;
-    result.pixels.resize(w * h * source.channels);
-
-    // 逐行复制
-    for (int row = 0; row < h; ++row) {
-        size_t srcOffset = ((y + row) * source.width + x) * source.channels;
-        size_t dstOffset = row * w * source.channels;
-        std::memcpy(
-            result.pixels.data() + dstOffset,
-            source.pixels.data() + srcOffset,
-            w * source.channels
-        );
+    std::atomic<bool> opaque{true};
+    const size_t rowBytes = static_cast<size_t>(image.width) * image.channels;
+    ThreadPool::Shared().ParallelFor(0, image.height, RowsPerBlock(rowBytes), [&](int y0, int y1) {
+        for (int y = y0; y < y1 && opaque.load(std::memory_order_relaxed); ++y) {
+            if (!Compositor::IsOpaqueRow(image.Row(y), image.width, image.channels)) {
+                opaque = false;
+            }
+        }
+    });
+    return opaque;
+}
+
+ImageView ImageProcessor::Crop(const ImageView& source, const Rect& region) {
+    if (!source.IsValid() || !region.IsValid()) {
+        return ImageView();
     }
 
-    return result;
+    // 裁剪只是视图偏移，边界检查由 SubView 完成
+    return source.SubView(region);
 }
 
-ImageData ImageProcessor::Resize(const ImageData& source, int targetWidth, int targetHeight) {
+ImageData ImageProcessor::Resize(const ImageView& source, int targetWidth, int targetHeight,
+                                 ResizeFilter filter, ResizeBackend backend) {
     if (!source.IsValid() || targetWidth <= 0 || targetHeight <= 0) {
         return ImageData();
     }
@@ -68,53 +238,84 @@ ImageData ImageProcessor::Resize(const ImageData& source, int targetWidth, int t
     result.width = targetWidth;
     result.height = targetHeight;
     result.channels = source.channels;
-    result.pixels.resize(targetWidth * targetHeight * source.channels);
-
-    // 双线性插值
-    float xRatio = static_cast<float>(source.width) / targetWidth;
-    float yRatio = static_cast<float>(source.height) / targetHeight;
-
-    for (int y = 0; y < targetHeight; ++y) {
-        for (int x = 0; x < targetWidth; ++x) {
-            float srcX = x * xRatio;
-            float srcY = y * yRatio;
-
-            int x1 = static_cast<int>(srcX);
-            int y1 = static_cast<int>(srcY);
-            int x2 = std::min(x1 + 1, source.width - 1);
-            int y2 = std::min(y1 + 1, source.height - 1);
-
-            float dx = srcX - x1;
-            float dy = srcY - y1;
-
-            for (int c = 0; c < source.channels; ++c) {
-                // 获取四个邻近像素
-                uint8_t p11 = source.pixels[(y1 * source.width + x1) * source.channels + c];
-                uint8_t p21 = source.pixels[(y1 * source.width + x2) * source.channels + c];
-                uint8_t p12 = source.pixels[(y2 * source.width + x1) * source.channels + c];
-                uint8_t p22 = source.pixels[(y2 * source.width + x2) * source.channels + c];
-
-                // 双线性插值
-                float value = p11 * (1 - dx) * (1 - dy) +
-                              p21 * dx * (1 - dy) +
-                              p12 * (1 - dx) * dy +
-                              p22 * dx * dy;
-
-                result.pixels[(y * targetWidth + x) * source.channels + c] = 
-                    static_cast<uint8_t>(value);
-            }
-        }
+    result.pixels = PixelBuffer::Allocate(result.GetSize());
+
+    // 可分离两遍定点重采样（运行时分派 SIMD 内核，按行带并行）
+    const size_t dstStride = static_cast<size_t>(targetWidth) * source.channels;
+    if (!ResizeRegionParallel(source, targetWidth, targetHeight,
+                              Rect(0, 0, targetWidth, targetHeight), filter, backend,
+                              [&](int y, const uint8_t* row) {
+                                  std::memcpy(result.pixels.data() + static_cast<size_t>(y) * dstStride,
+                                              row, dstStride);
+                              })) {
+        return ImageData();
     }
 
     return result;
 }
 
+bool ImageProcessor::ResizeInto(ImageData& canvas, const ImageView& source, const Rect& destRect,
+                                ResizeFilter filter, ResizeBackend backend) {
+    if (!canvas.IsValid() || !source.IsValid() || !destRect.IsValid()) {
+        return false;
+    }
+
+    // 目标矩形与画布的交集，换算到缩放后图像的坐标系
+    int startX = std::max(0, destRect.x);
+    int startY = std::max(0, destRect.y);
+    int endX = std::min(canvas.width, destRect.Right());
+    int endY = std::min(canvas.height, destRect.Bottom());
+
+    if (startX >= endX || startY >= endY) {
+        return true;
+    }
+
+    Rect region(startX - destRect.x, startY - destRect.y, endX - startX, endY - startY);
+
+    // 缩放结果逐行直接合成到画布，不生成整幅缩放图像
+    return ResizeRegionParallel(
+        source, destRect.width, destRect.height, region, filter, backend,
+        [&](int y, const uint8_t* row) {
+            size_t canvasOffset =
+                (static_cast<size_t>(destRect.y + y) * canvas.width + startX) * canvas.channels;
+            Compositor::BlendRow(canvas.pixels.data() + canvasOffset, row, region.width,
+                                 source.channels);
+        });
+}
+
+bool ImageProcessor::RotateInto(ImageData& canvas, const ImageView& source,
+                                const AffinePlacement& placement,
+                                ResizeFilter filter, ResizeBackend backend) {
+    if (!source.IsValid()) {
+        return false;
+    }
+
+    // 与不旋转时一致：图层的窄边缩到不足 1 像素时按 1 像素绘制，而不是让整张图处理失败
+    AffinePlacement layer = placement;
+    layer.layerWidth = std::max(1.0, placement.layerWidth);
+    layer.layerHeight = std::max(1.0, placement.layerHeight);
+
+    // 双线性只在缩小不到一半时无混叠；缩得更小时先用可分离滤波器缩到图层尺寸
+    const int layerWidth = static_cast<int>(std::lround(layer.layerWidth));
+    const int layerHeight = static_cast<int>(std::lround(layer.layerHeight));
+    if (layerWidth * 2 < source.width || layerHeight * 2 < source.height) {
+        ImageData reduced = Resize(source, std::min(layerWidth, source.width),
+                                   std::min(layerHeight, source.height), filter, backend);
+        if (!reduced.IsValid()) {
+            return false;
+        }
+        return Rotator::WarpInto(canvas, reduced, layer);
+    }
+
+    return Rotator::WarpInto(canvas, source, layer);
+}
+
 void ImageProcessor::DrawToCanvas(ImageData& canvas, const ImageLayer& layer) {
     if (!canvas.IsValid() || !layer.image.IsValid()) {
         return;
     }
 
-    const ImageData& img = layer.image;
+    const ImageView& img = layer.image;
     const Rect& pos = layer.position;
 
     // 计算实际绘制区域（裁剪到画布范围内）
@@ -127,45 +328,28 @@ void ImageProcessor::DrawToCanvas(ImageData& canvas, const ImageLayer& layer) {
         return;
     }
 
-    // 绘制
-    for (int y = startY; y < endY; ++y) {
-        for (int x = startX; x < endX; ++x) {
-            // 计算源图像坐标
-            int srcX = x - pos.x;
-            int srcY = y - pos.y;
+    // 位置矩形可能大于图像本身，再裁剪到图像范围
+    endX = std::min(endX, pos.x + img.width);
+    endY = std::min(endY, pos.y + img.height);
 
-            if (srcX < 0 || srcX >= img.width || srcY < 0 || srcY >= img.height) {
-                continue;
-            }
+    if (startX >= endX || startY >= endY) {
+        return;
+    }
 
-            size_t canvasOffset = (y * canvas.width + x) * canvas.channels;
-            size_t imgOffset = (srcY * img.width + srcX) * img.channels;
+    // 逐行绘制（按行带并行）
+    const size_t rowBytes = static_cast<size_t>(endX - startX) * 4;
+    ThreadPool::Shared().ParallelFor(startY, endY, RowsPerBlock(rowBytes), [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            size_t canvasOffset = (static_cast<size_t>(y) * canvas.width + startX) * canvas.channels;
 
-            BlendPixel(
+            Compositor::BlendRow(
                 canvas.pixels.data() + canvasOffset,
-                img.pixels.data() + imgOffset,
+                img.Row(y - pos.y) + static_cast<size_t>(startX - pos.x) * img.channels,
+                endX - startX,
                 img.channels
             );
         }
-    }
-}
-
-void ImageProcessor::BlendPixel(uint8_t* dest, const uint8_t* src, int channels) {
-    if (channels == 4) {
-        // Alpha 混合
-        float alpha = src[3] / 255.0f;
-        float invAlpha = 1.0f - alpha;
-
-        dest[0] = static_cast<uint8_t>(src[0] * alpha + dest[0] * invAlpha);
-        dest[1] = static_cast<uint8_t>(src[1] * alpha + dest[1] * invAlpha);
-        dest[2] = static_cast<uint8_t>(src[2] * alpha + dest[2] * invAlpha);
-        dest[3] = 255; // 画布始终不透明
-    } else {
-        // 直接覆盖
-        for (int i = 0; i < channels; ++i) {
-            dest[i] = src[i];
-        }
-    }
+    });
 }
 
 Rect ImageProcessor::CalculatePosition(int imageWidth, int imageHeight,
@@ -271,15 +455,59 @@ std::pair<int, int> ImageProcessor::CalculateScaledSize(int sourceWidth, int sou
     return {sourceWidth, sourceHeight};
 }
 
-ImageData ImageProcessor::Process(const ImageData& source, const ProcessConfig& config,
-                                   const ImageTransformState* transformState) {
+int ImageProcessor::CalculateDecodeScale(int sourceWidth, int sourceHeight,
+                                         const ProcessConfig& config,
+                                         const ImageTransformState* transformState) {
+    if (sourceWidth <= 0 || sourceHeight <= 0 || config.crop.enabled ||
+        (transformState && Rotator::NormalizeDegrees(transformState->rotation) != 0.0)) {
+        return 1;
+    }
+
+    // 与 Process 相同的目标尺寸：用户矩形或缩放模式的结果
+    int targetWidth = 0;
+    int targetHeight = 0;
+    if (transformState && transformState->hasTransform &&
+        transformState->positionX > transformState->scaleX &&
+        transformState->positionY > transformState->scaleY) {
+        targetWidth = static_cast<int>(transformState->positionX - transformState->scaleX);
+        targetHeight = static_cast<int>(transformState->positionY - transformState->scaleY);
+    } else {
+        std::tie(targetWidth, targetHeight) = CalculateScaledSize(
+            sourceWidth, sourceHeight, config.canvas.width, config.canvas.height, config.scaleMode);
+    }
+    if (targetWidth <= 0 || targetHeight <= 0) {
+        return 1;
+    }
+
+    // 缩放 IDCT 的输出尺寸向上取整
+    for (int scale = 8; scale > 1; scale /= 2) {
+        if ((sourceWidth + scale - 1) / scale >= targetWidth &&
+            (sourceHeight + scale - 1) / scale >= targetHeight) {
+            return scale;
+        }
+    }
+    return 1;
+}
+
+ImageData ImageProcessor::Process(const ImageView& source, const ProcessConfig& config,
+                                   const ImageTransformState* transformState,
+                                   const CanvasTemplate* canvasTemplate) {
     if (!source.IsValid()) {
         return ImageData();
     }
 
-    ImageData processed = source;
+    // 各阶段之间只传递视图；缩放结果直接写入画布，不生成中间图像
+    ImageView processed = source;
 
-    // 1. 裁剪
+    // 不透明图层会完全覆盖所在区域，画布只需填充其余部分（如 Fit 模式的上下/左右边条）。
+    // 内置重采样内核保证不透明输入的输出仍然不透明；stb 后端为浮点实现，不做此假设
+    auto createCanvas = [&](const Rect& position, bool resampled) {
+        bool covers = (!resampled || config.resizeBackend == ResizeBackend::Builtin) &&
+                      IsOpaque(processed);
+        return CreateCanvas(config.canvas, covers ? position : Rect(), canvasTemplate);
+    };
+
+    // 1. 裁剪（视图调整，不复制像素）
     if (config.crop.enabled && config.crop.region.IsValid()) {
         processed = Crop(processed, config.crop.region);
         if (!processed.IsValid()) {
@@ -287,83 +515,293 @@ ImageData ImageProcessor::Process(const ImageData& source, const ProcessConfig&
         }
     }
 
-    // 2. 如果有用户变换，应用变换（PS 矩形模型）
-    if (transformState && transformState->hasTransform) {
-        // ✅ PS 矩形模型：transformState 中存储的是矩形的四条边
-        // scaleX = left, scaleY = top, positionX = right, positionY = bottom
-        double rectLeft = transformState->scaleX;
-        double rectTop = transformState->scaleY;
-        double rectRight = transformState->positionX;
-        double rectBottom = transformState->positionY;
-        
-        double rectWidth = rectRight - rectLeft;
-        double rectHeight = rectBottom - rectTop;
-        
-        // 如果矩形有效，使用用户的变换
-        if (rectWidth > 0 && rectHeight > 0) {
-            // 缩放图片到用户指定的尺寸
-            int targetWidth = static_cast<int>(rectWidth);
-            int targetHeight = static_cast<int>(rectHeight);
-            
-            if (targetWidth > 0 && targetHeight > 0) {
-                processed = Resize(processed, targetWidth, targetHeight);
-                if (!processed.IsValid()) {
-                    return ImageData();
-                }
-            }
-            
-            // 创建画布
-            ImageData canvas = CreateCanvas(config.canvas);
-            
-            // 使用用户指定的位置（矩形的左上角）
-            Rect position;
-            position.x = static_cast<int>(rectLeft);
-            position.y = static_cast<int>(rectTop);
-            position.width = processed.width;
-            position.height = processed.height;
-            
-            // 绘制到画布
-            ImageLayer layer;
-            layer.image = processed;
-            layer.position = position;
-            DrawToCanvas(canvas, layer);
-            
-            return canvas;
+    // 2. 旋转：直角旋转无损转置后按普通图像继续处理；其它角度与缩放、合成一起完成
+    const double rotation =
+        transformState ? Rotator::NormalizeDegrees(transformState->rotation) : 0.0;
+    int quarterTurns = 0;
+    const bool rightAngle = Rotator::IsRightAngle(rotation, quarterTurns);
+    ImageData rotated;
+    if (rightAngle && quarterTurns != 0) {
+        rotated = Rotator::RotateQuarterTurns(processed, quarterTurns);
+        if (!rotated.IsValid()) {
+            return ImageData();
         }
+        processed = rotated;
     }
-    
-    // 没有用户变换或矩形无效，使用默认的缩放模式
-    {
-        // 2. 计算缩放尺寸
+
+    // 任意角度：图层缩放到 layerWidth × layerHeight，绕 (centerX, centerY) 旋转后合成
+    auto rotateToCanvas = [&](double layerWidth, double layerHeight,
+                              double centerX, double centerY) {
+        ImageData canvas = CreateCanvas(config.canvas, Rect(), canvasTemplate);
+        AffinePlacement placement;
+        placement.layerWidth = layerWidth;
+        placement.layerHeight = layerHeight;
+        placement.centerX = centerX;
+        placement.centerY = centerY;
+        placement.degrees = rotation;
+        if (!RotateInto(canvas, processed, placement,
+                        config.resizeFilter, config.resizeBackend)) {
+            return ImageData();
+        }
+        return canvas;
+    };
+
+    // 3. 用户变换矩形（PS 矩形模型）或默认缩放模式
+    double rectLeft = 0.0;
+    double rectTop = 0.0;
+    double rectWidth = 0.0;
+    double rectHeight = 0.0;
+    const bool userRect = UserLayerRect(transformState, quarterTurns,
+                                        rectLeft, rectTop, rectWidth, rectHeight);
+
+    if (!rightAngle) {
+        if (userRect) {
+            return rotateToCanvas(rectWidth, rectHeight,
+                                  rectLeft + rectWidth * 0.5, rectTop + rectHeight * 0.5);
+        }
+
+        // 按旋转后的外接矩形计算缩放和对齐，再换算回旋转前的图层尺寸
+        double boundsWidth = 0.0;
+        double boundsHeight = 0.0;
+        Rotator::RotatedBounds(processed.width, processed.height, rotation,
+                               boundsWidth, boundsHeight);
         auto [scaledWidth, scaledHeight] = CalculateScaledSize(
-            processed.width, processed.height,
+            static_cast<int>(std::lround(boundsWidth)), static_cast<int>(std::lround(boundsHeight)),
             config.canvas.width, config.canvas.height,
             config.scaleMode
         );
+        Rect position = CalculatePosition(scaledWidth, scaledHeight,
+                                          config.canvas, config.alignment);
+
+        return rotateToCanvas(processed.width * scaledWidth / boundsWidth,
+                              processed.height * scaledHeight / boundsHeight,
+                              position.x + position.width * 0.5,
+                              position.y + position.height * 0.5);
+    }
+
+    // 4. 计算图层位置，创建画布（只填充图像未覆盖的部分）
+    const Rect position = LayerPosition(processed.width, processed.height, config, transformState,
+                                        quarterTurns);
+    const bool resampled = position.width != processed.width || position.height != processed.height;
+    ImageData canvas = createCanvas(position, resampled);
+
+    // 5. 缩放并合成：只计算落在画布内的部分（Fill 模式下超出画布的部分不再计算）
+    if (resampled) {
+        if (!ResizeInto(canvas, processed, position,
+                        config.resizeFilter, config.resizeBackend)) {
+            return ImageData();
+        }
+        return canvas;
+    }
+
+    // 6. 无需缩放时直接绘制到画布
+    ImageLayer layer;
+    layer.image = processed;
+    layer.position = position;
+    DrawToCanvas(canvas, layer);
+
+    return canvas;
+}
+
+bool ImageProcessor::SupportsStreaming(const ProcessConfig& config,
+                                       const ImageTransformState* transformState) {
+    const bool rotated =
+        transformState && Rotator::NormalizeDegrees(transformState->rotation) != 0.0;
+    return !rotated && config.resizeBackend == ResizeBackend::Builtin &&
+           (config.format == OutputFormat::PNG || config.format == OutputFormat::JPG);
+}
+
+bool ImageProcessor::ProcessStreaming(const RowSource& source, const ProcessConfig& config,
+                                      const ImageTransformState* transformState,
+                                      const CanvasTemplate* canvasTemplate,
+                                      const std::function<bool(const uint8_t* row)>& writeRow) {
+    const Canvas& canvas = config.canvas;
+    if (!source.IsValid() || source.channels > 4 || canvas.width <= 0 || canvas.height <= 0 ||
+        !SupportsStreaming(config, transformState)) {
+        return false;
+    }
+
+    // 1. 裁剪：只保留区域内的源行，每行从区域左边开始
+    Rect crop(0, 0, source.width, source.height);
+    if (config.crop.enabled && config.crop.region.IsValid()) {
+        const int x0 = std::max(0, config.crop.region.x);
+        const int y0 = std::max(0, config.crop.region.y);
+        const int x1 = std::min(source.width, config.crop.region.Right());
+        const int y1 = std::min(source.height, config.crop.region.Bottom());
+        if (x0 >= x1 || y0 >= y1) {
+            return false;
+        }
+        crop = Rect(x0, y0, x1 - x0, y1 - y0);
+    }
 
-        // 3. 缩放
-        if (scaledWidth != processed.width || scaledHeight != processed.height) {
-            processed = Resize(processed, scaledWidth, scaledHeight);
-            if (!processed.IsValid()) {
-                return ImageData();
+    // 2. 图层位置与 Process 相同；只计算落在画布内的部分
+    const Rect position = LayerPosition(crop.width, crop.height, config, transformState, 0);
+    const bool resampled = position.width != crop.width || position.height != crop.height;
+    const int startX = std::max(0, position.x);
+    const int startY = std::max(0, position.y);
+    const int endX = std::min(canvas.width, position.Right());
+    const int endY = std::min(canvas.height, position.Bottom());
+    const bool visible = startX < endX && startY < endY;
+    const Rect region(startX - position.x, startY - position.y, endX - startX, endY - startY);
+
+    // 3. 画布逐行生成：背景来自模板或背景色，图层行合成在上面
+    const size_t rowBytes = static_cast<size_t>(canvas.width) * 4;
+    const bool useTemplate = canvasTemplate && canvasTemplate->Matches(canvas);
+    std::vector<uint8_t> background;
+    if (!useTemplate) {
+        const uint8_t pixel[4] = {
+            canvas.background.r, canvas.background.g, canvas.background.b, canvas.background.a
+        };
+        background.resize(rowBytes);
+        for (size_t offset = 0; offset < rowBytes; offset += 4) {
+            std::memcpy(background.data() + offset, pixel, 4);
+        }
+    }
+    auto backgroundRow = [&](int y) {
+        return useTemplate ? canvasTemplate->image.pixels.data() + static_cast<size_t>(y) * rowBytes
+                           : background.data();
+    };
+
+    bool ok = true;
+    int nextRow = 0;
+    auto flushBackground = [&](int end) {
+        for (; ok && nextRow < end; ++nextRow) {
+            ok = writeRow(backgroundRow(nextRow));
+        }
+    };
+
+    std::vector<uint8_t> canvasRow(rowBytes);
+    auto composeRow = [&](int layerY, const uint8_t* row) {
+        const int y = position.y + layerY;
+        flushBackground(y);
+        if (!ok) {
+            return;
+        }
+        std::memcpy(canvasRow.data(), backgroundRow(y), rowBytes);
+        Compositor::BlendRow(canvasRow.data() + static_cast<size_t>(startX) * 4, row,
+                             region.width, source.channels);
+        ok = writeRow(canvasRow.data());
+        ++nextRow;
+    };
+
+    // 4. 逐行读取源图像：缩放时交给流式重采样器，否则可见行直接合成
+    if (visible) {
+        std::unique_ptr<StreamingResampler> resampler;
+        if (resampled) {
+            resampler = std::make_unique<StreamingResampler>(
+                crop.width, crop.height, source.channels, position.width, position.height,
+                region, config.resizeFilter);
+            if (!resampler->IsValid()) {
+                return false;
             }
         }
 
-        // 4. 创建画布
-        ImageData canvas = CreateCanvas(config.canvas);
+        const size_t pixelOffset = static_cast<size_t>(crop.x) * source.channels;
+        const int lastRow = resampled ? crop.Bottom() : crop.y + region.Bottom();
+        std::vector<uint8_t> sourceRow(static_cast<size_t>(source.width) * source.channels);
+        for (int y = 0; ok && y < lastRow; ++y) {
+            // 逐行检查当前线程的取消令牌：暂停时停在这里，取消后放弃（输出不完整）
+            if (!CancellationToken::Checkpoint() || !source.readRow(sourceRow.data())) {
+                return false;
+            }
+            if (y < crop.y) {
+                continue;
+            }
 
-        // 5. 计算位置
-        Rect position = CalculatePosition(
-            processed.width, processed.height,
-            config.canvas, config.alignment
-        );
+            const uint8_t* row = sourceRow.data() + pixelOffset;
+            if (resampler) {
+                resampler->PushRow(row, composeRow);
+                if (resampler->IsDone()) {
+                    break;
+                }
+            } else if (y - crop.y >= region.y) {
+                composeRow(y - crop.y, row + static_cast<size_t>(region.x) * source.channels);
+            }
+        }
+    }
 
-        // 6. 绘制到画布
-        ImageLayer layer;
-        layer.image = processed;
-        layer.position = position;
-        DrawToCanvas(canvas, layer);
+    // 5. 图层下方剩余的背景行
+    flushBackground(canvas.height);
+    return ok;
+}
 
-        return canvas;
+bool ImageProcessor::PlanFileLoad(const std::string& inputPath, const ProcessConfig& config,
+                                  const ImageTransformState* transformState, int& outDecodeScale) {
+    outDecodeScale = 1;
+    ImageInfo info;
+    if (!ImageLoader::GetInfo(inputPath, info)) {
+        return false;
+    }
+
+    // 输出远小于原图时 JPEG 直接以缩小的分辨率解码
+    if (ImageLoader::SupportsScaledDecode(inputPath)) {
+        outDecodeScale = CalculateDecodeScale(info.width, info.height, config, transformState);
+    }
+
+    // 解码后仍然过大时逐行流式处理，不生成整幅源图像和画布
+    const uint64_t decodedPixels =
+        static_cast<uint64_t>((info.width + outDecodeScale - 1) / outDecodeScale) *
+        ((info.height + outDecodeScale - 1) / outDecodeScale);
+    return config.streamingPixelThreshold > 0 && decodedPixels > config.streamingPixelThreshold &&
+           SupportsStreaming(config, transformState);
+}
+
+bool ImageProcessor::ProcessFile(const std::string& inputPath, const ProcessConfig& config,
+                                 const ImageTransformState* transformState,
+                                 const CanvasTemplate* canvasTemplate,
+                                 std::vector<uint8_t>& outBytes) {
+    outBytes.clear();
+
+    int decodeScale = 1;
+    if (PlanFileLoad(inputPath, config, transformState, decodeScale)) {
+        RowSource source;
+        if (!ImageLoader::OpenRowSource(inputPath, decodeScale, source)) {
+            std::cerr << "Failed to load: " << inputPath << std::endl;
+            return false;
+        }
+
+        const int width = config.canvas.width;
+        const int height = config.canvas.height;
+        bool ok = false;
+        if (config.format == OutputFormat::PNG) {
+            PngRowEncoder encoder(width, height, 4, config.pngCompression, outBytes);
+            ok = ProcessStreaming(source, config, transformState, canvasTemplate,
+                                  [&](const uint8_t* row) { return encoder.WriteRow(row); }) &&
+                 encoder.Finish();
+        } else {
+            JpegRowEncoder encoder(width, height, 4, config.jpgQuality, outBytes);
+            ok = ProcessStreaming(source, config, transformState, canvasTemplate,
+                                  [&](const uint8_t* row) { return encoder.WriteRow(row); }) &&
+                 encoder.Finish();
+        }
+        if (!ok) {
+            // 取消导致的中止不是错误，不输出日志
+            const CancellationToken* token = CancellationToken::Current();
+            if (!token || !token->IsCancelled()) {
+                std::cerr << "Failed to process: " << inputPath << std::endl;
+            }
+            outBytes.clear();
+        }
+        return ok;
+    }
+
+    ImageData loaded;
+    if (!ImageLoader::LoadScaled(inputPath, decodeScale, loaded)) {
+        std::cerr << "Failed to load: " << inputPath << std::endl;
+        return false;
+    }
+
+    ImageData result = Process(loaded, config, transformState, canvasTemplate);
+    loaded = ImageData();
+    if (!result.IsValid()) {
+        std::cerr << "Failed to process: " << inputPath << std::endl;
+        return false;
+    }
+
+    if (!ImageLoader::EncodeToMemory(result, config.format, config.jpgQuality, outBytes,
+                                     config.pngCompression, config.webp)) {
+        std::cerr << "Failed to encode: " << inputPath << std::endl;
+        return false;
     }
+    return true;
 }
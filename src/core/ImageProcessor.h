@@ -1,6 +1,10 @@
 #pragma once
 
+#include "Rotator.h"
 #include "Types.h"
+#include <functional>
+#include <string>
+#include <vector>
 
 /**
  * @brief 图像处理器
@@ -9,8 +13,10 @@
  * - 创建画布
  * - 图像裁剪
  * - 图像缩放
+ * - 图像旋转
  * - 图像合成到画布
  * - 完整的处理流程
+ * - 超大输入的逐行流式处理（内存占用与图像高度无关）
  * 
  * 注意：此类不依赖任何 UI 库
  */
@@ -24,26 +30,78 @@ public:
     static ImageData CreateCanvas(const Canvas& canvas);
 
     /**
-     * @brief 裁剪图像
+     * @brief 创建画布，跳过会被不透明图层完全覆盖的区域
+     * @param canvas 画布配置
+     * @param covered 不透明图层的位置（可超出画布；无效时填充整个画布）
+     * @param canvasTemplate 画布模板（可选，与 canvas 一致时直接复制其背景）
+     * @return 画布图像数据；covered 内的像素未填充，必须由调用方随后完全覆盖
+     */
+    static ImageData CreateCanvas(const Canvas& canvas, const Rect& covered,
+                                  const CanvasTemplate* canvasTemplate = nullptr);
+
+    /**
+     * @brief 创建画布模板（背景只填充一次，供同一批次的任务复制）
+     * @param canvas 画布配置
+     */
+    static CanvasTemplate CreateCanvasTemplate(const Canvas& canvas);
+
+    /**
+     * @brief 判断图像是否完全不透明（合成后会完全覆盖所在区域）
+     */
+    static bool IsOpaque(const ImageView& image);
+
+    /**
+     * @brief 裁剪图像（只调整视图，不复制像素）
      * @param source 源图像
-     * @param region 裁剪区域
-     * @return 裁剪后的图像
+     * @param region 裁剪区域（超出部分会被裁掉）
+     * @return 裁剪后的视图，与 source 共享像素；无交集时返回无效视图
      */
-    static ImageData Crop(const ImageData& source, const Rect& region);
+    static ImageView Crop(const ImageView& source, const Rect& region);
 
     /**
-     * @brief 缩放图像（双线性插值）
+     * @brief 缩放图像（可分离定点重采样，自动使用 SIMD）
      * @param source 源图像
      * @param targetWidth 目标宽度
      * @param targetHeight 目标高度
+     * @param filter 重采样滤波器
+     * @param backend 重采样实现
      * @return 缩放后的图像
      */
-    static ImageData Resize(const ImageData& source, int targetWidth, int targetHeight);
+    static ImageData Resize(const ImageView& source, int targetWidth, int targetHeight,
+                            ResizeFilter filter = ResizeFilter::Auto,
+                            ResizeBackend backend = ResizeBackend::Builtin);
+
+    /**
+     * @brief 缩放图像并直接合成到画布（只计算落在画布内的像素）
+     * @param canvas 画布图像
+     * @param source 源图像
+     * @param destRect 缩放后图像在画布中的位置和尺寸（可以超出画布）
+     * @param filter 重采样滤波器
+     * @param backend 重采样实现
+     * @return 参数无效或缩放失败时返回 false；与画布无交集时直接返回 true
+     */
+    static bool ResizeInto(ImageData& canvas, const ImageView& source, const Rect& destRect,
+                           ResizeFilter filter = ResizeFilter::Auto,
+                           ResizeBackend backend = ResizeBackend::Builtin);
+
+    /**
+     * @brief 缩放并旋转图像，直接合成到画布（一次读取源图像完成缩放、旋转和合成）
+     * @param canvas 画布图像
+     * @param placement 旋转前的图层尺寸（不足 1 像素的边按 1 像素处理）、图层中心和顺时针角度
+     * @param placement 旋转前的图层尺寸、图层中心和顺时针角度
+     * @param filter 缩小到一半以下时预缩小使用的滤波器
+     * @param backend 预缩小使用的重采样实现
+     * @return 参数无效或预缩小失败时返回 false
+     */
+    static bool RotateInto(ImageData& canvas, const ImageView& source,
+                           const AffinePlacement& placement,
+                           ResizeFilter filter = ResizeFilter::Auto,
+                           ResizeBackend backend = ResizeBackend::Builtin);
 
     /**
      * @brief 将图像绘制到画布上
      * @param canvas 画布图像
-     * @param layer 图层（包含图像和位置）
+     * @param layer 图层（包含图像视图和位置）
      */
     static void DrawToCanvas(ImageData& canvas, const ImageLayer& layer);
 
@@ -71,19 +129,81 @@ public:
                                                      int targetWidth, int targetHeight,
                                                      ScaleMode mode);
 
+    /**
+     * @brief 计算加载源图像时可以使用的缩小倍数
+     * @param sourceWidth 原图宽度
+     * @param sourceHeight 原图高度
+     * @param config 处理配置
+     * @param transformState 用户的变换状态（可选）
+     * @return 1、2、4 或 8：按此倍数缩小后仍不小于 Process 的缩放目标尺寸
+     *
+     * 启用裁剪或旋转时返回 1（裁剪区域和旋转外接框都以原图像素为单位）。
+     */
+    static int CalculateDecodeScale(int sourceWidth, int sourceHeight, const ProcessConfig& config,
+                                    const ImageTransformState* transformState = nullptr);
+
     /**
      * @brief 完整处理流程
-     * @param source 源图像
+     * @param source 源图像（只读视图，不会被复制）
      * @param config 处理配置
      * @param transformState 用户的变换状态（可选）
+     * @param canvasTemplate 画布模板（可选，与 config.canvas 一致时复用其背景）
      * @return 处理后的图像
      */
-    static ImageData Process(const ImageData& source, const ProcessConfig& config, 
-                            const ImageTransformState* transformState = nullptr);
+    static ImageData Process(const ImageView& source, const ProcessConfig& config, 
+                            const ImageTransformState* transformState = nullptr,
+                            const CanvasTemplate* canvasTemplate = nullptr);
 
-private:
     /**
-     * @brief 混合两个像素（Alpha 混合）
+     * @brief 处理配置能否逐行流式处理
+     *
+     * 要求不旋转（旋转需要随机访问源图像）、使用内置重采样后端、输出 JPG 或 PNG。
+     */
+    static bool SupportsStreaming(const ProcessConfig& config,
+                                  const ImageTransformState* transformState = nullptr);
+
+    /**
+     * @brief 流式处理流程：源图像逐行读入，画布逐行输出
+     * @param source 逐行读取的源图像（channels 为 1-4）
+     * @param config 处理配置（须满足 SupportsStreaming）
+     * @param transformState 用户的变换状态（可选）
+     * @param canvasTemplate 画布模板（可选，与 config.canvas 一致时复用其背景）
+     * @param writeRow 按 y 递增顺序接收画布的每一行（RGBA，仅在回调期间有效），返回 false 时中止
+     * @return 成功返回 true
+     *
+     * 结果与 Process 逐位一致；只保留滤波窗口内的若干行，内存占用与画布宽度 × taps 成正比。
+     * 图层下方的源行读完后不再读取。
+     * 每读一行检查当前线程的取消令牌（CancellationToken::Checkpoint），取消时返回 false。
+     */
+    static bool ProcessStreaming(const RowSource& source, const ProcessConfig& config,
+                                 const ImageTransformState* transformState,
+                                 const CanvasTemplate* canvasTemplate,
+                                 const std::function<bool(const uint8_t* row)>& writeRow);
+
+    /**
+     * @brief 决定文件的加载方式（只读取文件头部）
+     * @param inputPath 输入文件路径
+     * @param config 处理配置
+     * @param transformState 用户的变换状态（可选）
+     * @param outDecodeScale 输出解码时的缩小倍数（见 CalculateDecodeScale）
+     * @return 应当逐行流式处理时返回 true：解码后的像素数超过 config.streamingPixelThreshold 且配置支持
+     */
+    static bool PlanFileLoad(const std::string& inputPath, const ProcessConfig& config,
+                             const ImageTransformState* transformState, int& outDecodeScale);
+
+    /**
+     * @brief 从文件加载、处理并编码
+     * @param inputPath 输入文件路径
+     * @param config 处理配置（含输出格式）
+     * @param transformState 用户的变换状态（可选）
+     * @param canvasTemplate 画布模板（可选）
+     * @param outBytes 输出编码后的文件内容
+     * @return 成功返回 true
+     *
+     * 按 PlanFileLoad 的结果逐行流式处理（ProcessStreaming），或整幅加载后调用 Process。
      */
-    static void BlendPixel(uint8_t* dest, const uint8_t* src, int channels);
+    static bool ProcessFile(const std::string& inputPath, const ProcessConfig& config,
+                            const ImageTransformState* transformState,
+                            const CanvasTemplate* canvasTemplate,
+                            std::vector<uint8_t>& outBytes);
 };
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include <cstdint>
+
+/**
+ * @file JpegKernels.h
+ * @brief JPEG 编码内核（仅供 JpegWriter 及其 SIMD 实现文件内部使用）
+ *
+ * 正向 DCT 使用 AAN 浮点算法（与 stb_image_write 相同），输出系数带有 AAN 缩放因子，
+ * 缩放因子合并进量化表的倒数中，量化只需一次乘法。
+ */
+
+/**
+ * @brief 8×8 块正向 DCT + 量化
+ * @param block 64 个电平平移后的采样值（行优先）
+ * @param scale 64 个量化系数（1 / (量化步长 × AAN 缩放)，行优先）
+ * @param out 64 个量化后的系数（行优先，即自然顺序）
+ */
+using JpegQuantizeBlockFn = void (*)(const float* block, const float* scale, int16_t* out);
+
+// 标量实现（JpegWriter.cpp）
+void JpegQuantizeBlockScalar(const float* block, const float* scale, int16_t* out);
+
+#if defined(IMGTOOL_ENABLE_SIMD)
+// SSE4.1 实现（JpegWriterSSE41.cpp）：每个寄存器处理 4 列，行列变换之间做 8×8 转置
+void JpegQuantizeBlockSSE41(const float* block, const float* scale, int16_t* out);
+#endif
+
+/**
+ * @brief 一维 AAN 正向 DCT（8 点，原地）
+ *
+ * T 可以是 float，也可以是支持 +、-、乘以 float 的向量类型（一次处理多列）。
+ */
+template <typename T>
+inline void JpegForwardDct8(T& d0, T& d1, T& d2, T& d3, T& d4, T& d5, T& d6, T& d7) {
+    const T tmp0 = d0 + d7;
+    const T tmp7 = d0 - d7;
+    const T tmp1 = d1 + d6;
+    const T tmp6 = d1 - d6;
+    const T tmp2 = d2 + d5;
+    const T tmp5 = d2 - d5;
+    const T tmp3 = d3 + d4;
+    const T tmp4 = d3 - d4;
+
+    // 偶数部分
+    T tmp10 = tmp0 + tmp3;
+    const T tmp13 = tmp0 - tmp3;
+    T tmp11 = tmp1 + tmp2;
+    T tmp12 = tmp1 - tmp2;
+
+    d0 = tmp10 + tmp11;
+    d4 = tmp10 - tmp11;
+
+    const T z1 = (tmp12 + tmp13) * 0.707106781f;
+    d2 = tmp13 + z1;
+    d6 = tmp13 - z1;
+
+    // 奇数部分
+    tmp10 = tmp4 + tmp5;
+    tmp11 = tmp5 + tmp6;
+    tmp12 = tmp6 + tmp7;
+
+    const T z5 = (tmp10 - tmp12) * 0.382683433f;
+    const T z2 = tmp10 * 0.541196100f + z5;
+    const T z4 = tmp12 * 1.306562965f + z5;
+    const T z3 = tmp11 * 0.707106781f;
+
+    const T z11 = tmp7 + z3;
+    const T z13 = tmp7 - z3;
+
+    d5 = z13 + z2;
+    d3 = z13 - z2;
+    d1 = z11 + z4;
+    d7 = z11 - z4;
+}
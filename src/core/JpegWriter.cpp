@@ -0,0 +1,605 @@
+#include "JpegWriter.h"
+#include "JpegKernels.h"
+#include "PixelKernels.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "../task/ThreadPool.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 每个 restart 区间的目标像素数（足够大以摊薄 RSTn 标记和 DC 预测重置的开销）
+constexpr size_t kSegmentPixels = 256 * 1024;
+
+// zigzag 位置 -> 自然顺序下标
+constexpr uint8_t kNaturalOrder[64] = {
+    0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+// 标准量化表（ITU T.81 附录 K，自然顺序）
+constexpr int kLumaQuant[64] = {
+    16, 11, 10, 16, 24,  40,  51,  61,  12, 12, 14, 19, 26,  58,  60,  55,
+    14, 13, 16, 24, 40,  57,  69,  56,  14, 17, 22, 29, 51,  87,  80,  62,
+    18, 22, 37, 56, 68,  109, 103, 77,  24, 35, 55, 64, 81,  104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99};
+constexpr int kChromaQuant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99};
+
+// AAN DCT 输出的缩放因子（已乘以 sqrt(8)）
+constexpr float kAanScale[8] = {
+    1.0f * 2.828427125f,         1.387039845f * 2.828427125f, 1.306562965f * 2.828427125f,
+    1.175875602f * 2.828427125f, 1.0f * 2.828427125f,         0.785694958f * 2.828427125f,
+    0.541196100f * 2.828427125f, 0.275899379f * 2.828427125f};
+
+// 标准 Huffman 表（ITU T.81 附录 K）：各码长的码字数 + 符号
+constexpr uint8_t kDcLumaCounts[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+constexpr uint8_t kDcChromaCounts[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+constexpr uint8_t kDcValues[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+constexpr uint8_t kAcLumaCounts[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+constexpr uint8_t kAcLumaValues[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa};
+constexpr uint8_t kAcChromaCounts[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+constexpr uint8_t kAcChromaValues[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa};
+
+/**
+ * @brief Huffman 编码表（符号 -> 码字、码长）
+ */
+struct HuffmanTable {
+    uint16_t codes[256] = {};
+    uint8_t lengths[256] = {};
+
+    HuffmanTable(const uint8_t* counts, const uint8_t* values) {
+        uint32_t code = 0;
+        int k = 0;
+        for (int length = 1; length <= 16; ++length) {
+            for (int i = 0; i < counts[length - 1]; ++i, ++k) {
+                codes[values[k]] = static_cast<uint16_t>(code++);
+                lengths[values[k]] = static_cast<uint8_t>(length);
+            }
+            code <<= 1;
+        }
+    }
+};
+
+struct HuffmanTables {
+    HuffmanTable dcLuma{kDcLumaCounts, kDcValues};
+    HuffmanTable acLuma{kAcLumaCounts, kAcLumaValues};
+    HuffmanTable dcChroma{kDcChromaCounts, kDcValues};
+    HuffmanTable acChroma{kAcChromaCounts, kAcChromaValues};
+};
+
+const HuffmanTables& Tables() {
+    static const HuffmanTables tables;
+    return tables;
+}
+
+/**
+ * @brief 熵编码数据的比特流（MSB 优先，0xFF 后插入 0x00）
+ */
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : m_Out(out) {}
+
+    void Put(uint32_t bits, int count) {
+        m_Bits = (m_Bits << count) | bits;
+        m_Count += count;
+        if (m_Count >= 32) {
+            Drain();
+        }
+    }
+
+    // 用 1 填充到字节边界（restart 区间和扫描结束时）
+    void Finish() {
+        if (m_Count & 7) {
+            const int pad = 8 - (m_Count & 7);
+            Put((1u << pad) - 1, pad);
+        }
+        Drain();
+    }
+
+private:
+    void Drain() {
+        while (m_Count >= 8) {
+            m_Count -= 8;
+            const uint8_t byte = static_cast<uint8_t>(m_Bits >> m_Count);
+            m_Out.push_back(byte);
+            if (byte == 0xFF) {
+                m_Out.push_back(0x00);
+            }
+        }
+    }
+
+    std::vector<uint8_t>& m_Out;
+    uint64_t m_Bits = 0;
+    int m_Count = 0;
+};
+
+inline int BitLength(int value) {
+    int bits = 0;
+    while (value) {
+        ++bits;
+        value >>= 1;
+    }
+    return bits;
+}
+
+/**
+ * @brief 写一个系数值：先写类别（位数）对应的 Huffman 码，再写附加位
+ */
+inline void PutValue(BitWriter& writer, const HuffmanTable& table, int symbolHigh, int value) {
+    const int magnitude = value < 0 ? -value : value;
+    const int bits = BitLength(magnitude);
+    const int symbol = symbolHigh | bits;
+    writer.Put(table.codes[symbol], table.lengths[symbol]);
+    if (bits) {
+        const int extra = value < 0 ? value - 1 : value;
+        writer.Put(static_cast<uint32_t>(extra) & ((1u << bits) - 1), bits);
+    }
+}
+
+/**
+ * @brief 熵编码一个 8×8 块
+ * @param coefficients 量化后的系数（自然顺序）
+ * @param dcPredictor 同一分量上一个块的 DC 值（更新为本块的 DC）
+ */
+void EncodeBlock(BitWriter& writer, const int16_t* coefficients, int& dcPredictor,
+                 const HuffmanTable& dc, const HuffmanTable& ac) {
+    const int dcValue = coefficients[0];
+    PutValue(writer, dc, 0, dcValue - dcPredictor);
+    dcPredictor = dcValue;
+
+    int run = 0;
+    for (int z = 1; z < 64; ++z) {
+        // baseline 的 AC 系数最多 10 位（质量 100 时极端内容可能超出）
+        const int value = std::clamp<int>(coefficients[kNaturalOrder[z]], -1023, 1023);
+        if (value == 0) {
+            ++run;
+            continue;
+        }
+        while (run >= 16) {
+            writer.Put(ac.codes[0xF0], ac.lengths[0xF0]);  // ZRL：16 个零
+            run -= 16;
+        }
+        PutValue(writer, ac, run << 4, value);
+        run = 0;
+    }
+    if (run > 0) {
+        writer.Put(ac.codes[0x00], ac.lengths[0x00]);  // EOB
+    }
+}
+
+/**
+ * @brief 编码参数（所有 restart 区间共享）
+ */
+struct EncoderSetup {
+    ImageView image;
+    bool gray = false;
+    bool subsample = false;
+    int mcuSize = 8;
+    int mcusPerRow = 0;
+    uint8_t lumaTable[64] = {};    // 量化步长（自然顺序）
+    uint8_t chromaTable[64] = {};
+    float lumaScale[64] = {};      // 1 / (步长 × AAN 缩放)
+    float chromaScale[64] = {};
+    JpegQuantizeBlockFn quantize = JpegQuantizeBlockScalar;
+};
+
+/**
+ * @brief 读取一个 MCU 并转换为电平平移后的 Y、Cb、Cr（超出图像的部分重复边缘像素）
+ *
+ * Y 按 8×8 块依次存放（16×16 的 MCU 为 4 个块），Cb、Cr 为 size × size 行优先。
+ * 灰度图只输出 Y。
+ */
+template <int Channels>
+void LoadMcu(const ImageView& image, int x0, int y0, int size, float* luma, float* cb, float* cr) {
+    for (int r = 0; r < size; ++r) {
+        const uint8_t* row = image.Row(std::min(y0 + r, image.height - 1));
+        for (int c = 0; c < size; ++c) {
+            const uint8_t* p = row + static_cast<size_t>(std::min(x0 + c, image.width - 1)) * Channels;
+            const int index = ((r >> 3) * 2 + (c >> 3)) * 64 + (r & 7) * 8 + (c & 7);
+            if (Channels < 3) {
+                luma[index] = static_cast<float>(p[0]) - 128.0f;
+            } else {
+                const float red = p[0];
+                const float green = p[1];
+                const float blue = p[2];
+                luma[index] = 0.29900f * red + 0.58700f * green + 0.11400f * blue - 128.0f;
+                cb[r * size + c] = -0.16874f * red - 0.33126f * green + 0.50000f * blue;
+                cr[r * size + c] = 0.50000f * red - 0.41869f * green - 0.08131f * blue;
+            }
+        }
+    }
+}
+
+// 16×16 色度取 2×2 平均得到 8×8
+void Downsample(const float* src, float* dst) {
+    for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            const float* p = src + y * 32 + x * 2;
+            dst[y * 8 + x] = (p[0] + p[1] + p[16] + p[17]) * 0.25f;
+        }
+    }
+}
+
+/**
+ * @brief 编码若干 MCU 行（一个 restart 区间）
+ */
+template <int Channels>
+void EncodeMcuRows(const EncoderSetup& setup, int mcuRowBegin, int mcuRowEnd, std::vector<uint8_t>& out) {
+    const HuffmanTables& tables = Tables();
+    BitWriter writer(out);
+    int dcY = 0;
+    int dcCb = 0;
+    int dcCr = 0;
+
+    float luma[256];
+    float cb[256];
+    float cr[256];
+    float block[64];
+    int16_t coefficients[64];
+    const int lumaBlocks = setup.subsample ? 4 : 1;
+
+    for (int mcuRow = mcuRowBegin; mcuRow < mcuRowEnd; ++mcuRow) {
+        const int y0 = mcuRow * setup.mcuSize;
+        for (int mcu = 0; mcu < setup.mcusPerRow; ++mcu) {
+            const int x0 = mcu * setup.mcuSize;
+            LoadMcu<Channels>(setup.image, x0, y0, setup.mcuSize, luma, cb, cr);
+
+            for (int b = 0; b < lumaBlocks; ++b) {
+                setup.quantize(luma + b * 64, setup.lumaScale, coefficients);
+                EncodeBlock(writer, coefficients, dcY, tables.dcLuma, tables.acLuma);
+            }
+            if (setup.gray) {
+                continue;
+            }
+
+            const float* cbBlock = cb;
+            const float* crBlock = cr;
+            float crDown[64];
+            if (setup.subsample) {
+                Downsample(cb, block);
+                Downsample(cr, crDown);
+                cbBlock = block;
+                crBlock = crDown;
+            }
+            setup.quantize(cbBlock, setup.chromaScale, coefficients);
+            EncodeBlock(writer, coefficients, dcCb, tables.dcChroma, tables.acChroma);
+            setup.quantize(crBlock, setup.chromaScale, coefficients);
+            EncodeBlock(writer, coefficients, dcCr, tables.dcChroma, tables.acChroma);
+        }
+    }
+    writer.Finish();
+}
+
+JpegQuantizeBlockFn GetQuantizeBlock(SimdLevel level) {
+#if defined(IMGTOOL_ENABLE_SIMD)
+    // AVX2 没有单独的实现：8×8 块的行列变换各只有 8 路，SSE4.1 两个寄存器已能覆盖
+    if (level >= SimdLevel::SSE41) {
+        return JpegQuantizeBlockSSE41;
+    }
+#else
+    (void)level;
+#endif
+    return JpegQuantizeBlockScalar;
+}
+
+void PutUint16(std::vector<uint8_t>& out, int value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void PutMarker(std::vector<uint8_t>& out, uint8_t marker) {
+    out.push_back(0xFF);
+    out.push_back(marker);
+}
+
+void PutHuffmanTable(std::vector<uint8_t>& out, int tableClass, int id, const uint8_t* counts,
+                     const uint8_t* values, int valueCount) {
+    out.push_back(static_cast<uint8_t>((tableClass << 4) | id));
+    out.insert(out.end(), counts, counts + 16);
+    out.insert(out.end(), values, values + valueCount);
+}
+
+/**
+ * @brief 写 SOI 到 SOS 之间的所有段
+ */
+void WriteHeaders(const EncoderSetup& setup, int restartInterval, std::vector<uint8_t>& out) {
+    const int componentCount = setup.gray ? 1 : 3;
+
+    PutMarker(out, 0xD8);  // SOI
+
+    static const uint8_t kJfif[] = {'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0};
+    PutMarker(out, 0xE0);  // APP0
+    PutUint16(out, 2 + sizeof(kJfif));
+    out.insert(out.end(), kJfif, kJfif + sizeof(kJfif));
+
+    PutMarker(out, 0xDB);  // DQT（按 zigzag 顺序）
+    PutUint16(out, setup.gray ? 2 + 65 : 2 + 2 * 65);
+    for (int t = 0; t < (setup.gray ? 1 : 2); ++t) {
+        const uint8_t* table = t == 0 ? setup.lumaTable : setup.chromaTable;
+        out.push_back(static_cast<uint8_t>(t));
+        for (int z = 0; z < 64; ++z) {
+            out.push_back(table[kNaturalOrder[z]]);
+        }
+    }
+
+    PutMarker(out, 0xC0);  // SOF0
+    PutUint16(out, 8 + 3 * componentCount);
+    out.push_back(8);
+    PutUint16(out, setup.image.height);
+    PutUint16(out, setup.image.width);
+    out.push_back(static_cast<uint8_t>(componentCount));
+    out.push_back(1);
+    out.push_back(setup.subsample ? 0x22 : 0x11);
+    out.push_back(0);
+    if (!setup.gray) {
+        for (uint8_t id = 2; id <= 3; ++id) {
+            out.push_back(id);
+            out.push_back(0x11);
+            out.push_back(1);
+        }
+    }
+
+    PutMarker(out, 0xC4);  // DHT
+    PutUint16(out, setup.gray ? 2 + 17 + 12 + 17 + 162 : 2 + 2 * (17 + 12 + 17 + 162));
+    PutHuffmanTable(out, 0, 0, kDcLumaCounts, kDcValues, 12);
+    PutHuffmanTable(out, 1, 0, kAcLumaCounts, kAcLumaValues, 162);
+    if (!setup.gray) {
+        PutHuffmanTable(out, 0, 1, kDcChromaCounts, kDcValues, 12);
+        PutHuffmanTable(out, 1, 1, kAcChromaCounts, kAcChromaValues, 162);
+    }
+
+    if (restartInterval > 0) {
+        PutMarker(out, 0xDD);  // DRI
+        PutUint16(out, 4);
+        PutUint16(out, restartInterval);
+    }
+
+    PutMarker(out, 0xDA);  // SOS
+    PutUint16(out, 6 + 2 * componentCount);
+    out.push_back(static_cast<uint8_t>(componentCount));
+    out.push_back(1);
+    out.push_back(0x00);
+    if (!setup.gray) {
+        out.push_back(2);
+        out.push_back(0x11);
+        out.push_back(3);
+        out.push_back(0x11);
+    }
+    out.push_back(0);   // 频谱起点
+    out.push_back(63);  // 频谱终点
+    out.push_back(0);   // 逐次逼近
+}
+
+/**
+ * @brief 检查尺寸并计算量化表等编码参数（setup.image 只设置尺寸，像素由调用方提供）
+ */
+bool InitSetup(int width, int height, int channels, int quality, SimdLevel level, EncoderSetup& setup) {
+    if (width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+        std::cerr << "Invalid image data" << std::endl;
+        return false;
+    }
+    if (width > 65535 || height > 65535) {
+        std::cerr << "Image too large for JPEG: " << width << "x" << height << std::endl;
+        return false;
+    }
+
+    // 质量映射与 stb_image_write 相同
+    quality = quality ? quality : 90;
+    setup.image = ImageView(nullptr, width, height, channels, 0);
+    setup.gray = channels < 3;
+    setup.subsample = !setup.gray && quality <= 90;
+    setup.mcuSize = setup.subsample ? 16 : 8;
+    setup.mcusPerRow = (width + setup.mcuSize - 1) / setup.mcuSize;
+    setup.quantize = GetQuantizeBlock(level);
+
+    quality = std::clamp(quality, 1, 100);
+    const int scaleFactor = quality < 50 ? 5000 / quality : 200 - quality * 2;
+    for (int i = 0; i < 64; ++i) {
+        setup.lumaTable[i] = static_cast<uint8_t>(std::clamp((kLumaQuant[i] * scaleFactor + 50) / 100, 1, 255));
+        setup.chromaTable[i] = static_cast<uint8_t>(std::clamp((kChromaQuant[i] * scaleFactor + 50) / 100, 1, 255));
+    }
+    for (int row = 0; row < 8; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            const int i = row * 8 + col;
+            setup.lumaScale[i] = 1.0f / (setup.lumaTable[i] * kAanScale[row] * kAanScale[col]);
+            setup.chromaScale[i] = 1.0f / (setup.chromaTable[i] * kAanScale[row] * kAanScale[col]);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 每个 restart 区间的 MCU 行数（区间长度以 MCU 计，不能超过 65535）
+ */
+int McuRowsPerSegment(const EncoderSetup& setup) {
+    const int mcuRows = (setup.image.height + setup.mcuSize - 1) / setup.mcuSize;
+    const size_t rowPixels = static_cast<size_t>(setup.mcusPerRow) * setup.mcuSize * setup.mcuSize;
+    const int rowsPerSegment = static_cast<int>(std::max<size_t>(1, kSegmentPixels / rowPixels));
+    return std::min({rowsPerSegment, mcuRows, std::max(1, 65535 / setup.mcusPerRow)});
+}
+
+} // namespace
+
+void JpegQuantizeBlockScalar(const float* block, const float* scale, int16_t* out) {
+    float d[64];
+    std::memcpy(d, block, sizeof(d));
+    for (int c = 0; c < 8; ++c) {
+        JpegForwardDct8(d[c], d[8 + c], d[16 + c], d[24 + c], d[32 + c], d[40 + c], d[48 + c], d[56 + c]);
+    }
+    for (int r = 0; r < 64; r += 8) {
+        JpegForwardDct8(d[r], d[r + 1], d[r + 2], d[r + 3], d[r + 4], d[r + 5], d[r + 6], d[r + 7]);
+    }
+    for (int i = 0; i < 64; ++i) {
+        const float v = d[i] * scale[i];
+        out[i] = static_cast<int16_t>(v < 0 ? v - 0.5f : v + 0.5f);
+    }
+}
+
+bool JpegWriter::Encode(const ImageView& image, int quality, std::vector<uint8_t>& outBytes) {
+    return Encode(image, quality, outBytes, CpuFeatures::GetSimdLevel());
+}
+
+bool JpegWriter::Encode(const ImageView& image, int quality, std::vector<uint8_t>& outBytes,
+                        SimdLevel level) {
+    outBytes.clear();
+    if (!image.IsValid()) {
+        std::cerr << "Invalid image data" << std::endl;
+        return false;
+    }
+    EncoderSetup setup;
+    if (!InitSetup(image.width, image.height, image.channels, quality, level, setup)) {
+        return false;
+    }
+    setup.image = image;
+
+    const int mcuRows = (image.height + setup.mcuSize - 1) / setup.mcuSize;
+    const size_t rowPixels = static_cast<size_t>(setup.mcusPerRow) * setup.mcuSize * setup.mcuSize;
+    const int rowsPerSegment = McuRowsPerSegment(setup);
+    const int segmentCount = (mcuRows + rowsPerSegment - 1) / rowsPerSegment;
+
+    std::vector<std::vector<uint8_t>> segments(segmentCount);
+    ThreadPool::Shared().ParallelFor(0, segmentCount, 1, [&](int s0, int s1) {
+        for (int s = s0; s < s1; ++s) {
+            const int rowBegin = s * rowsPerSegment;
+            const int rowEnd = std::min(mcuRows, rowBegin + rowsPerSegment);
+            segments[s].reserve(static_cast<size_t>(rowEnd - rowBegin) * rowPixels / 4);
+            DispatchChannels(image.channels, [&](auto tag) {
+                EncodeMcuRows<decltype(tag)::value>(setup, rowBegin, rowEnd, segments[s]);
+            });
+        }
+    });
+
+    size_t totalSize = 1024;
+    for (const auto& segment : segments) {
+        totalSize += segment.size() + 2;
+    }
+    outBytes.reserve(totalSize);
+
+    WriteHeaders(setup, segmentCount > 1 ? rowsPerSegment * setup.mcusPerRow : 0, outBytes);
+    for (int s = 0; s < segmentCount; ++s) {
+        if (s > 0) {
+            PutMarker(outBytes, static_cast<uint8_t>(0xD0 + ((s - 1) & 7)));  // RSTn
+        }
+        outBytes.insert(outBytes.end(), segments[s].begin(), segments[s].end());
+    }
+    PutMarker(outBytes, 0xD9);  // EOI
+    return true;
+}
+
+bool JpegWriter::Save(const std::string& filePath, const ImageView& image, int quality) {
+    std::vector<uint8_t> bytes;
+    if (!Encode(image, quality, bytes)) {
+        return false;
+    }
+
+    std::ofstream file(fs::path(filePath), std::ios::binary | std::ios::trunc);
+    if (!file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+        std::cerr << "Failed to save JPG: " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+struct JpegRowEncoder::State {
+    EncoderSetup setup;
+    std::vector<uint8_t>* out = nullptr;
+    size_t rowBytes = 0;
+    int rowsPerSegment = 0;        // 每个 restart 区间的像素行数（MCU 行的整数倍）
+    std::vector<uint8_t> rows;     // 当前区间已写入的行
+    int bufferedRows = 0;
+    int rowsWritten = 0;
+    int segmentIndex = 0;
+};
+
+JpegRowEncoder::JpegRowEncoder(int width, int height, int channels, int quality,
+                               std::vector<uint8_t>& outBytes, SimdLevel level) {
+    outBytes.clear();
+    auto state = std::make_unique<State>();
+    if (!InitSetup(width, height, channels, quality, level, state->setup)) {
+        return;
+    }
+
+    const int mcuRowsPerSegment = McuRowsPerSegment(state->setup);
+    const int mcuRows = (height + state->setup.mcuSize - 1) / state->setup.mcuSize;
+    state->out = &outBytes;
+    state->rowBytes = static_cast<size_t>(width) * channels;
+    state->rowsPerSegment = mcuRowsPerSegment * state->setup.mcuSize;
+    state->rows.resize(state->rowBytes * std::min(state->rowsPerSegment, height));
+
+    WriteHeaders(state->setup,
+                 mcuRows > mcuRowsPerSegment ? mcuRowsPerSegment * state->setup.mcusPerRow : 0, outBytes);
+    m_State = std::move(state);
+}
+
+JpegRowEncoder::~JpegRowEncoder() = default;
+
+bool JpegRowEncoder::WriteRow(const uint8_t* row) {
+    if (!m_State || m_State->rowsWritten >= m_State->setup.image.height) {
+        return false;
+    }
+
+    State& state = *m_State;
+    std::memcpy(state.rows.data() + static_cast<size_t>(state.bufferedRows) * state.rowBytes, row,
+                state.rowBytes);
+    ++state.bufferedRows;
+    ++state.rowsWritten;
+    if (state.bufferedRows < state.rowsPerSegment && state.rowsWritten < state.setup.image.height) {
+        return true;
+    }
+
+    // 区间已攒满：以缓冲的行作为图像编码（最后一个区间底部不足一个 MCU 时同样重复最后一行）
+    EncoderSetup segmentSetup = state.setup;
+    segmentSetup.image = ImageView(state.rows.data(), state.setup.image.width, state.bufferedRows,
+                                   state.setup.image.channels, state.rowBytes);
+    const int mcuRows = (state.bufferedRows + segmentSetup.mcuSize - 1) / segmentSetup.mcuSize;
+    if (state.segmentIndex > 0) {
+        PutMarker(*state.out, static_cast<uint8_t>(0xD0 + ((state.segmentIndex - 1) & 7)));  // RSTn
+    }
+    DispatchChannels(segmentSetup.image.channels, [&](auto tag) {
+        EncodeMcuRows<decltype(tag)::value>(segmentSetup, 0, mcuRows, *state.out);
+    });
+    ++state.segmentIndex;
+    state.bufferedRows = 0;
+    return true;
+}
+
+bool JpegRowEncoder::Finish() {
+    if (!m_State || m_State->rowsWritten != m_State->setup.image.height) {
+        std::cerr << "JPEG stream ended before all rows were written" << std::endl;
+        return false;
+    }
+    PutMarker(*m_State->out, 0xD9);  // EOI
+    m_State.reset();
+    return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include "Types.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief JPEG 编码器（baseline，标准 Huffman 表）
+ *
+ * 职责：
+ * - 质量参数与 stb_image_write 含义相同：同样的量化表缩放方式，质量 ≤ 90 时色度 4:2:0 采样，否则 4:4:4
+ * - 正向 DCT + 量化按 CPU 特性分派到 SIMD 内核
+ * - 大图按 MCU 行切成若干 restart 区间，在线程池上并行编码后拼接（区间之间插入 RSTn 标记）
+ *
+ * 输入为 1-4 通道 8 位图像：1、2 通道输出灰度 JPEG，3、4 通道输出 YCbCr（alpha 被忽略）。
+ */
+class JpegWriter {
+public:
+    /**
+     * @brief 编码到内存
+     * @param image 图像
+     * @param quality 质量（1-100）
+     * @param outBytes 输出 JPEG 文件内容
+     * @return 成功返回 true
+     */
+    static bool Encode(const ImageView& image, int quality, std::vector<uint8_t>& outBytes);
+
+    /**
+     * @brief 编码到内存（指定 SIMD 等级，用于对比标量与 SIMD 输出）
+     */
+    static bool Encode(const ImageView& image, int quality, std::vector<uint8_t>& outBytes,
+                       SimdLevel level);
+
+    /**
+     * @brief 编码并写入文件
+     * @param filePath 文件路径
+     * @param image 图像
+     * @param quality 质量（1-100）
+     * @return 成功返回 true
+     */
+    static bool Save(const std::string& filePath, const ImageView& image, int quality);
+};
+
+/**
+ * @brief 逐行 JPEG 编码器（流式处理用，整幅图像不必同时在内存中）
+ *
+ * 各行按顺序写入，每攒够一个 restart 区间就编码并追加到输出，只缓冲一个区间的行。
+ * 参数和区间划分与 JpegWriter::Encode 相同，输出逐字节一致，只是各区间依次编码而不并行。
+ */
+class JpegRowEncoder {
+public:
+    /**
+     * @param width 宽度
+     * @param height 高度
+     * @param channels 通道数（1-4）
+     * @param quality 质量（1-100）
+     * @param outBytes 输出 JPEG 文件内容（先清空，随写入逐步追加）
+     * @param level SIMD 等级
+     */
+    JpegRowEncoder(int width, int height, int channels, int quality, std::vector<uint8_t>& outBytes,
+                   SimdLevel level = CpuFeatures::GetSimdLevel());
+    ~JpegRowEncoder();
+
+    JpegRowEncoder(const JpegRowEncoder&) = delete;
+    JpegRowEncoder& operator=(const JpegRowEncoder&) = delete;
+
+    /**
+     * @brief 写入下一行（width * channels 字节）
+     * @return 参数无效或行数已满时返回 false
+     */
+    bool WriteRow(const uint8_t* row);
+
+    /**
+     * @brief 结束编码（写入全部行后调用）
+     * @return 行数不足时返回 false
+     */
+    bool Finish();
+
+private:
+    struct State;
+    std::unique_ptr<State> m_State;
+};
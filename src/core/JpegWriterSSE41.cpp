@@ -0,0 +1,68 @@
+#include "JpegKernels.h"
+
+#if defined(IMGTOOL_ENABLE_SIMD)
+
+#include <smmintrin.h>
+
+namespace {
+
+// 让 JpegForwardDct8 可以直接作用在 4 路浮点向量上
+struct Float4 {
+    __m128 v;
+};
+
+inline Float4 operator+(Float4 a, Float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline Float4 operator-(Float4 a, Float4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline Float4 operator*(Float4 a, float b) { return {_mm_mul_ps(a.v, _mm_set1_ps(b))}; }
+
+// 对 8 行 × 4 列做列方向的一维 DCT
+inline void Dct8(Float4* r) {
+    JpegForwardDct8(r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7]);
+}
+
+// lo[i] 为第 i 行的 0-3 列，hi[i] 为 4-7 列；转置后仍按同样方式存放
+inline void Transpose8x8(Float4* lo, Float4* hi) {
+    _MM_TRANSPOSE4_PS(lo[0].v, lo[1].v, lo[2].v, lo[3].v);
+    _MM_TRANSPOSE4_PS(hi[4].v, hi[5].v, hi[6].v, hi[7].v);
+    _MM_TRANSPOSE4_PS(hi[0].v, hi[1].v, hi[2].v, hi[3].v);
+    _MM_TRANSPOSE4_PS(lo[4].v, lo[5].v, lo[6].v, lo[7].v);
+    // 右上与左下两个 4×4 子块交换位置
+    for (int i = 0; i < 4; ++i) {
+        const Float4 t = hi[i];
+        hi[i] = lo[i + 4];
+        lo[i + 4] = t;
+    }
+}
+
+// 四舍五入（远离零，与标量版本一致）后转换为整数
+inline __m128i RoundToInt(__m128 v) {
+    const __m128 half = _mm_or_ps(_mm_and_ps(v, _mm_set1_ps(-0.0f)), _mm_set1_ps(0.5f));
+    return _mm_cvttps_epi32(_mm_add_ps(v, half));
+}
+
+} // namespace
+
+void JpegQuantizeBlockSSE41(const float* block, const float* scale, int16_t* out) {
+    Float4 lo[8];
+    Float4 hi[8];
+    for (int i = 0; i < 8; ++i) {
+        lo[i].v = _mm_loadu_ps(block + i * 8);
+        hi[i].v = _mm_loadu_ps(block + i * 8 + 4);
+    }
+
+    // 先按列变换，转置后再按列变换（即原来的行方向），最后转置回行优先
+    Dct8(lo);
+    Dct8(hi);
+    Transpose8x8(lo, hi);
+    Dct8(lo);
+    Dct8(hi);
+    Transpose8x8(lo, hi);
+
+    for (int i = 0; i < 8; ++i) {
+        const __m128i a = RoundToInt(_mm_mul_ps(lo[i].v, _mm_loadu_ps(scale + i * 8)));
+        const __m128i b = RoundToInt(_mm_mul_ps(hi[i].v, _mm_loadu_ps(scale + i * 8 + 4)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 8), _mm_packs_epi32(a, b));
+    }
+}
+
+#endif // IMGTOOL_ENABLE_SIMD
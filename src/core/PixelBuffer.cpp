@@ -0,0 +1,140 @@
+#include "PixelBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+void FreeOwned(void* data) {
+    delete[] static_cast<uint8_t*>(data);
+}
+
+} // namespace
+
+PixelBuffer::PixelBuffer(size_t size) : PixelBuffer(size, 0) {}
+
+PixelBuffer::PixelBuffer(size_t size, uint8_t value) {
+    Reallocate(size);
+    if (size > 0) {
+        std::memset(m_Data.get(), value, size);
+    }
+}
+
+PixelBuffer::PixelBuffer(const PixelBuffer& other)
+    : m_Data(other.m_Data), m_Size(other.m_Size), m_Capacity(other.m_Capacity) {}
+
+PixelBuffer& PixelBuffer::operator=(const PixelBuffer& other) {
+    if (this != &other) {
+        m_Data = other.m_Data;
+        m_Size = other.m_Size;
+        m_Capacity = other.m_Capacity;
+    }
+    return *this;
+}
+
+PixelBuffer::PixelBuffer(PixelBuffer&& other) noexcept
+    : m_Data(std::move(other.m_Data)), m_Size(other.m_Size), m_Capacity(other.m_Capacity) {
+    other.m_Size = 0;
+    other.m_Capacity = 0;
+}
+
+PixelBuffer& PixelBuffer::operator=(PixelBuffer&& other) noexcept {
+    if (this != &other) {
+        m_Data = std::move(other.m_Data);
+        m_Size = other.m_Size;
+        m_Capacity = other.m_Capacity;
+        other.m_Size = 0;
+        other.m_Capacity = 0;
+    }
+    return *this;
+}
+
+PixelBuffer PixelBuffer::Allocate(size_t size) {
+    PixelBuffer buffer;
+    buffer.Reallocate(size);
+    return buffer;
+}
+
+PixelBuffer PixelBuffer::Adopt(uint8_t* data, size_t size, Deleter deleter) {
+    PixelBuffer buffer;
+    if (data) {
+        buffer.m_Data = std::shared_ptr<uint8_t>(data, deleter);
+    }
+    buffer.m_Size = data ? size : 0;
+    buffer.m_Capacity = buffer.m_Size;
+    return buffer;
+}
+
+void PixelBuffer::resize(size_t size) {
+    if (size <= m_Capacity && !IsShared()) {
+        if (size > m_Size) {
+            std::memset(m_Data.get() + m_Size, 0, size - m_Size);
+        }
+        m_Size = size;
+        return;
+    }
+
+    PixelBuffer grown = Allocate(size);
+    const size_t kept = std::min(size, m_Size);
+    if (kept > 0) {
+        std::memcpy(grown.m_Data.get(), m_Data.get(), kept);
+    }
+    if (size > kept) {
+        std::memset(grown.m_Data.get() + kept, 0, size - kept);
+    }
+    *this = std::move(grown);
+}
+
+void PixelBuffer::assign(const uint8_t* first, const uint8_t* last) {
+    const size_t size = static_cast<size_t>(last - first);
+    if (size > m_Capacity || IsShared()) {
+        // 共享时 [first, last) 可能就在共享的内存里，先持有旧内存再重新分配
+        const std::shared_ptr<uint8_t> previous = m_Data;
+        Reallocate(size);
+        if (size > 0) {
+            std::memcpy(m_Data.get(), first, size);
+        }
+        return;
+    }
+    m_Size = size;
+    if (size > 0) {
+        std::memmove(m_Data.get(), first, size);
+    }
+}
+
+void PixelBuffer::assign(size_t count, uint8_t value) {
+    if (count > m_Capacity || IsShared()) {
+        Reallocate(count);
+    }
+    m_Size = count;
+    if (count > 0) {
+        std::memset(m_Data.get(), value, count);
+    }
+}
+
+void PixelBuffer::clear() {
+    m_Data.reset();
+    m_Size = 0;
+    m_Capacity = 0;
+}
+
+bool PixelBuffer::operator==(const PixelBuffer& other) const {
+    return m_Size == other.m_Size &&
+           (m_Size == 0 || m_Data == other.m_Data ||
+            std::memcmp(m_Data.get(), other.m_Data.get(), m_Size) == 0);
+}
+
+void PixelBuffer::Reallocate(size_t size) {
+    m_Data = size > 0 ? std::shared_ptr<uint8_t>(new uint8_t[size], FreeOwned) : nullptr;
+    m_Size = size;
+    m_Capacity = size;
+}
+
+void PixelBuffer::Detach() {
+    if (!IsShared()) {
+        return;
+    }
+
+    const std::shared_ptr<uint8_t> shared = std::move(m_Data);
+    Reallocate(m_Size);
+    std::memcpy(m_Data.get(), shared.get(), m_Size);
+}
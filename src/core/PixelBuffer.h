@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief 像素缓冲（引用计数，写时复制）
+ *
+ * 职责：
+ * - 持有一块连续的像素内存，接口与 std::vector<uint8_t> 的常用部分一致
+ * - 可以直接接管解码器分配的内存（附带释放函数），避免解码后再复制一遍
+ * - Allocate() 分配不初始化的内存，供随后会被完整写入的结果图像使用
+ * - 复制只增加引用计数：预览缓存、撤销历史和批处理任务共享同一份像素
+ *
+ * 注意：
+ * - 非 const 的访问（data()、operator[]、begin()/end()、resize）在内存被共享时先复制出独占的一份；
+ *   只读访问应通过 const 引用进行，否则会产生不必要的复制
+ * - 取得写指针之后再复制缓冲，两者会共享内存，不得再通过旧的写指针修改
+ * - 引用计数是线程安全的；同一个对象的并发写入仍需调用方同步
+ */
+class PixelBuffer {
+public:
+    using Deleter = void (*)(void*);
+
+    PixelBuffer() = default;
+
+    /**
+     * @brief 分配 size 字节并清零
+     */
+    explicit PixelBuffer(size_t size);
+
+    /**
+     * @brief 分配 size 字节并填充为 value
+     */
+    PixelBuffer(size_t size, uint8_t value);
+
+    PixelBuffer(const PixelBuffer& other);
+    PixelBuffer& operator=(const PixelBuffer& other);
+    PixelBuffer(PixelBuffer&& other) noexcept;
+    PixelBuffer& operator=(PixelBuffer&& other) noexcept;
+    ~PixelBuffer() = default;
+
+    /**
+     * @brief 分配 size 字节（内容未初始化）
+     */
+    static PixelBuffer Allocate(size_t size);
+
+    /**
+     * @brief 接管外部分配的内存
+     * @param data 内存首地址（之后由本对象负责释放）
+     * @param size 字节数
+     * @param deleter 释放函数（例如 stbi_image_free）
+     */
+    static PixelBuffer Adopt(uint8_t* data, size_t size, Deleter deleter);
+
+    uint8_t* data() { Detach(); return m_Data.get(); }
+    const uint8_t* data() const { return m_Data.get(); }
+    size_t size() const { return m_Size; }
+    bool empty() const { return m_Size == 0; }
+
+    uint8_t* begin() { return data(); }
+    uint8_t* end() { return data() + m_Size; }
+    const uint8_t* begin() const { return data(); }
+    const uint8_t* end() const { return data() + m_Size; }
+
+    uint8_t& operator[](size_t index) { return data()[index]; }
+    const uint8_t& operator[](size_t index) const { return m_Data.get()[index]; }
+
+    /**
+     * @brief 内存是否与其它 PixelBuffer 共享
+     */
+    bool IsShared() const { return m_Data && m_Data.use_count() > 1; }
+
+    /**
+     * @brief 两个缓冲是否共享同一块内存
+     */
+    bool SharesWith(const PixelBuffer& other) const {
+        return m_Data && m_Data == other.m_Data;
+    }
+
+    /**
+     * @brief 改变大小（保留原有内容，新增部分清零）
+     */
+    void resize(size_t size);
+
+    /**
+     * @brief 用 [first, last) 的内容替换
+     */
+    void assign(const uint8_t* first, const uint8_t* last);
+
+    /**
+     * @brief 替换为 count 个 value
+     */
+    void assign(size_t count, uint8_t value);
+
+    void clear();
+
+    bool operator==(const PixelBuffer& other) const;
+    bool operator!=(const PixelBuffer& other) const { return !(*this == other); }
+
+private:
+    // 重新分配为 size 字节（未初始化，原内容丢弃）
+    void Reallocate(size_t size);
+
+    // 内存被共享时复制出独占的一份
+    void Detach();
+
+    std::shared_ptr<uint8_t> m_Data;
+    size_t m_Size = 0;
+    size_t m_Capacity = 0;
+};
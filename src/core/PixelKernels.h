@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @file PixelKernels.h
+ * @brief 按通道数特化的像素内核
+ *
+ * 通道数作为模板参数，最内层循环中不再有运行时分支，编译器可以针对每种格式展开和向量化。
+ * 调用方在行（或整幅图像）级别通过 DispatchChannels 做一次分派。
+ *
+ * 支持的格式：1 = Gray，2 = Gray + Alpha，3 = RGB，4 = RGBA
+ */
+
+/**
+ * @brief 像素格式的编译期属性
+ */
+template <int Channels>
+struct PixelTraits {
+    static_assert(Channels >= 1 && Channels <= 4, "unsupported channel count");
+
+    static constexpr int kChannels = Channels;
+    static constexpr bool kHasAlpha = (Channels == 2 || Channels == 4);
+    static constexpr int kAlphaIndex = Channels - 1;          // 仅 kHasAlpha 时有效
+    static constexpr int kColorChannels = kHasAlpha ? Channels - 1 : Channels;
+};
+
+/**
+ * @brief 按运行时通道数调用对应的特化版本
+ * @param channels 通道数（1-4）
+ * @param fn 可调用对象，参数为 std::integral_constant<int, Channels>
+ * @return 通道数不受支持时返回 false（不调用 fn）
+ */
+template <typename Fn>
+inline bool DispatchChannels(int channels, Fn&& fn) {
+    switch (channels) {
+        case 1: fn(std::integral_constant<int, 1>()); return true;
+        case 2: fn(std::integral_constant<int, 2>()); return true;
+        case 3: fn(std::integral_constant<int, 3>()); return true;
+        case 4: fn(std::integral_constant<int, 4>()); return true;
+        default: return false;
+    }
+}
+
+/**
+ * @brief 读取一个像素并展开为 (r, g, b, a)，无 alpha 的格式 a = 255
+ */
+template <int Channels>
+inline void LoadRGBA(const uint8_t* p, uint32_t rgba[4]) {
+    if (Channels >= 3) {
+        rgba[0] = p[0];
+        rgba[1] = p[1];
+        rgba[2] = p[2];
+    } else {
+        rgba[0] = rgba[1] = rgba[2] = p[0];
+    }
+    rgba[3] = PixelTraits<Channels>::kHasAlpha ? p[PixelTraits<Channels>::kAlphaIndex] : 255;
+}
+
+/**
+ * @brief 一行像素转换为 RGBA
+ * @tparam Premultiply 为 true 时输出预乘 alpha 的颜色（round(c * a / 255)）
+ */
+template <int Channels, bool Premultiply = false>
+inline void ConvertRowToRGBA(uint8_t* dst, const uint8_t* src, int count) {
+    for (int x = 0; x < count; ++x) {
+        uint32_t rgba[4];
+        LoadRGBA<Channels>(src, rgba);
+        if (Premultiply && PixelTraits<Channels>::kHasAlpha) {
+            for (int c = 0; c < 3; ++c) {
+                const uint32_t v = rgba[c] * rgba[3] + 128;
+                rgba[c] = (v + (v >> 8)) >> 8;
+            }
+        }
+        dst[0] = static_cast<uint8_t>(rgba[0]);
+        dst[1] = static_cast<uint8_t>(rgba[1]);
+        dst[2] = static_cast<uint8_t>(rgba[2]);
+        dst[3] = static_cast<uint8_t>(rgba[3]);
+        dst += 4;
+        src += Channels;
+    }
+}
+
+/**
+ * @brief 一行像素转换为 RGB（丢弃 alpha，灰度复制到三个通道）
+ */
+template <int Channels>
+inline void ConvertRowToRGB(uint8_t* dst, const uint8_t* src, int count) {
+    for (int x = 0; x < count; ++x) {
+        if (Channels >= 3) {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        } else {
+            dst[0] = dst[1] = dst[2] = src[0];
+        }
+        dst += 3;
+        src += Channels;
+    }
+}
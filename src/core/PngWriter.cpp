@@ -0,0 +1,428 @@
+#include "PngWriter.h"
+#include "Deflate.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "../task/ThreadPool.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 每个压缩段的目标大小（足够大以保持压缩率，又能让多核都有事做）
+constexpr size_t kSegmentBytes = 512 * 1024;
+
+// 行滤波每个并行块处理的目标字节数
+constexpr size_t kFilterBlockBytes = 256 * 1024;
+
+enum FilterType : uint8_t {
+    FilterNone = 0,
+    FilterSub = 1,
+    FilterUp = 2,
+    FilterAverage = 3,
+    FilterPaeth = 4
+};
+
+/**
+ * @brief CRC-32（slice-by-8）
+ */
+class Crc32 {
+public:
+    static uint32_t Update(uint32_t crc, const uint8_t* data, size_t size) {
+        static const Crc32 instance;
+        const auto& t = instance.m_Table;
+        crc = ~crc;
+        while (size >= 8) {
+            const uint32_t lo = crc ^ (data[0] | (data[1] << 8) | (data[2] << 16) |
+                                       (static_cast<uint32_t>(data[3]) << 24));
+            const uint32_t hi = data[4] | (data[5] << 8) | (data[6] << 16) |
+                                (static_cast<uint32_t>(data[7]) << 24);
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                  t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+            data += 8;
+            size -= 8;
+        }
+        while (size-- > 0) {
+            crc = t[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+private:
+    Crc32() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            m_Table[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int s = 1; s < 8; ++s) {
+                m_Table[s][i] = m_Table[0][m_Table[s - 1][i] & 0xFF] ^ (m_Table[s - 1][i] >> 8);
+            }
+        }
+    }
+
+    uint32_t m_Table[8][256];
+};
+
+void PutUint32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/**
+ * @brief 写一个 PNG 块（长度、类型、数据、CRC）
+ */
+void PutChunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, size_t size,
+              uint32_t dataCrc) {
+    PutUint32(out, static_cast<uint32_t>(size));
+    out.insert(out.end(), type, type + 4);
+    if (size > 0) {
+        out.insert(out.end(), data, data + size);
+    }
+    PutUint32(out, dataCrc);
+}
+
+uint32_t ChunkCrc(const char type[4], const uint8_t* data, size_t size) {
+    uint32_t crc = Crc32::Update(0, reinterpret_cast<const uint8_t*>(type), 4);
+    return Crc32::Update(crc, data, size);
+}
+
+inline uint8_t Paeth(int a, int b, int c) {
+    const int p = a + b - c;
+    const int pa = std::abs(p - a);
+    const int pb = std::abs(p - b);
+    const int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return static_cast<uint8_t>(a);
+    }
+    return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+/**
+ * @brief 对一行应用滤波器
+ * @param prior 上一行原始数据（第一行传全零行）
+ */
+void FilterRow(FilterType type, const uint8_t* row, const uint8_t* prior, size_t rowBytes, int bpp,
+               uint8_t* dst) {
+    const size_t left = std::min(static_cast<size_t>(bpp), rowBytes);
+    switch (type) {
+        case FilterNone:
+            std::memcpy(dst, row, rowBytes);
+            break;
+        case FilterSub:
+            std::memcpy(dst, row, left);
+            for (size_t i = left; i < rowBytes; ++i) {
+                dst[i] = static_cast<uint8_t>(row[i] - row[i - bpp]);
+            }
+            break;
+        case FilterUp:
+            for (size_t i = 0; i < rowBytes; ++i) {
+                dst[i] = static_cast<uint8_t>(row[i] - prior[i]);
+            }
+            break;
+        case FilterAverage:
+            for (size_t i = 0; i < left; ++i) {
+                dst[i] = static_cast<uint8_t>(row[i] - (prior[i] >> 1));
+            }
+            for (size_t i = left; i < rowBytes; ++i) {
+                dst[i] = static_cast<uint8_t>(row[i] - ((row[i - bpp] + prior[i]) >> 1));
+            }
+            break;
+        case FilterPaeth:
+            for (size_t i = 0; i < left; ++i) {
+                dst[i] = static_cast<uint8_t>(row[i] - prior[i]);
+            }
+            for (size_t i = left; i < rowBytes; ++i) {
+                dst[i] = static_cast<uint8_t>(row[i] - Paeth(row[i - bpp], prior[i], prior[i - bpp]));
+            }
+            break;
+    }
+}
+
+/**
+ * @brief 残差按有符号字节取绝对值后求和（libpng 的启发式），超过 limit 时提前返回
+ */
+uint64_t FilterCost(const uint8_t* filtered, size_t size, uint64_t limit) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; ++i) {
+        sum += static_cast<uint64_t>(std::abs(static_cast<int>(static_cast<int8_t>(filtered[i]))));
+        if ((i & 1023) == 1023 && sum >= limit) {
+            break;
+        }
+    }
+    return sum;
+}
+
+/**
+ * @brief 对一行滤波，输出以滤波类型字节开头的一行
+ * @param prior 上一行原始数据（第一行传全零行）
+ * @param trial Default 级别试算用的临时行（rowBytes 字节）
+ */
+void FilterLine(PngCompression level, const uint8_t* row, const uint8_t* prior, size_t rowBytes,
+                int bpp, uint8_t* line, uint8_t* trial) {
+    if (level == PngCompression::Store) {
+        line[0] = FilterNone;
+        std::memcpy(line + 1, row, rowBytes);
+    } else if (level == PngCompression::Fast) {
+        line[0] = FilterPaeth;
+        FilterRow(FilterPaeth, row, prior, rowBytes, bpp, line + 1);
+    } else {
+        // 逐个尝试滤波器，最好的结果留在 line 中
+        uint64_t bestCost = UINT64_MAX;
+        for (uint8_t type = FilterNone; type <= FilterPaeth; ++type) {
+            uint8_t* dst = bestCost == UINT64_MAX ? line + 1 : trial;
+            FilterRow(static_cast<FilterType>(type), row, prior, rowBytes, bpp, dst);
+            const uint64_t cost = FilterCost(dst, rowBytes, bestCost);
+            if (cost < bestCost) {
+                if (dst != line + 1) {
+                    std::memcpy(line + 1, dst, rowBytes);
+                }
+                line[0] = type;
+                bestCost = cost;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 生成滤波后的图像数据（每行以滤波类型字节开头）
+ */
+void FilterImage(const ImageView& image, PngCompression level, std::vector<uint8_t>& filtered) {
+    const size_t rowBytes = static_cast<size_t>(image.width) * image.channels;
+    const size_t lineBytes = rowBytes + 1;
+    filtered.resize(lineBytes * image.height);
+
+    const int rowsPerBlock = std::max(1, static_cast<int>(kFilterBlockBytes / lineBytes));
+    ThreadPool::Shared().ParallelFor(0, image.height, rowsPerBlock, [&](int y0, int y1) {
+        const std::vector<uint8_t> zeroRow(rowBytes, 0);
+        std::vector<uint8_t> trial(level == PngCompression::Default ? rowBytes : 0);
+        for (int y = y0; y < y1; ++y) {
+            FilterLine(level, image.Row(y), y > 0 ? image.Row(y - 1) : zeroRow.data(), rowBytes,
+                       image.channels, filtered.data() + static_cast<size_t>(y) * lineBytes, trial.data());
+        }
+    });
+}
+
+Deflate::Strategy ToStrategy(PngCompression level) {
+    return level == PngCompression::Store ? Deflate::Strategy::Store
+         : level == PngCompression::Fast  ? Deflate::Strategy::FixedHuffman
+                                          : Deflate::Strategy::Dynamic;
+}
+
+// 每段的行数（按整行切段）
+size_t RowsPerSegment(size_t lineBytes) {
+    return std::max<size_t>(1, kSegmentBytes / lineBytes);
+}
+
+// zlib 头：deflate，32 KB 窗口；FLEVEL 只是提示（0 = 最快，2 = 默认）
+void PutZlibHeader(std::vector<uint8_t>& out, PngCompression level) {
+    out.push_back(0x78);
+    out.push_back(level == PngCompression::Default ? 0x9C : 0x01);
+}
+
+/**
+ * @brief 写 PNG 签名和 IHDR 块
+ */
+void PutHeader(std::vector<uint8_t>& out, int width, int height, int channels) {
+    static const uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.insert(out.end(), kSignature, kSignature + 8);
+
+    static const uint8_t kColorTypes[5] = {0, 0, 4, 2, 6};
+    uint8_t header[13];
+    for (int i = 0; i < 4; ++i) {
+        header[i] = static_cast<uint8_t>(static_cast<uint32_t>(width) >> (24 - 8 * i));
+        header[4 + i] = static_cast<uint8_t>(static_cast<uint32_t>(height) >> (24 - 8 * i));
+    }
+    header[8] = 8;                       // 位深
+    header[9] = kColorTypes[channels];   // 颜色类型
+    header[10] = 0;                      // 压缩方法
+    header[11] = 0;                      // 滤波方法
+    header[12] = 0;                      // 不隔行
+    PutChunk(out, "IHDR", header, sizeof(header), ChunkCrc("IHDR", header, sizeof(header)));
+}
+
+} // namespace
+
+bool PngWriter::Encode(const ImageView& image, PngCompression level, std::vector<uint8_t>& outBytes) {
+    outBytes.clear();
+    if (!image.IsValid() || image.channels < 1 || image.channels > 4) {
+        std::cerr << "Invalid image data" << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> filtered;
+    FilterImage(image, level, filtered);
+
+    // 按整行切段，每段独立压缩（前一段末尾 32 KB 作为匹配的历史窗口）
+    const size_t lineBytes = static_cast<size_t>(image.width) * image.channels + 1;
+    const size_t rowsPerSegment = RowsPerSegment(lineBytes);
+    const size_t segmentCount = (static_cast<size_t>(image.height) + rowsPerSegment - 1) / rowsPerSegment;
+    const Deflate::Strategy strategy = ToStrategy(level);
+
+    std::vector<std::vector<uint8_t>> segments(segmentCount);
+    std::vector<uint32_t> adlers(segmentCount);
+    ThreadPool::Shared().ParallelFor(0, static_cast<int>(segmentCount), 1, [&](int s0, int s1) {
+        for (int s = s0; s < s1; ++s) {
+            const size_t begin = static_cast<size_t>(s) * rowsPerSegment * lineBytes;
+            const size_t end = std::min(filtered.size(), begin + rowsPerSegment * lineBytes);
+            const size_t historyBegin = begin > Deflate::kWindowSize ? begin - Deflate::kWindowSize : 0;
+            std::vector<uint8_t>& segment = segments[s];
+            segment.reserve(level == PngCompression::Store ? end - begin + 64 : (end - begin) / 2);
+            if (s == 0) {
+                PutZlibHeader(segment, level);
+            }
+            Deflate::CompressSegment(filtered.data(), historyBegin, begin, end, strategy,
+                                     static_cast<size_t>(s) + 1 == segmentCount, segment);
+            adlers[s] = Deflate::Adler32(filtered.data() + begin, end - begin);
+        }
+    });
+
+    uint32_t adler = adlers[0];
+    for (size_t s = 1; s < segmentCount; ++s) {
+        const size_t begin = s * rowsPerSegment * lineBytes;
+        const size_t end = std::min(filtered.size(), begin + rowsPerSegment * lineBytes);
+        adler = Deflate::Adler32Combine(adler, adlers[s], end - begin);
+    }
+    PutUint32(segments.back(), adler);
+
+    std::vector<uint32_t> crcs(segmentCount);
+    ThreadPool::Shared().ParallelFor(0, static_cast<int>(segmentCount), 1, [&](int s0, int s1) {
+        for (int s = s0; s < s1; ++s) {
+            crcs[s] = ChunkCrc("IDAT", segments[s].data(), segments[s].size());
+        }
+    });
+
+    size_t totalSize = 8 + 25 + 12;
+    for (const auto& segment : segments) {
+        totalSize += segment.size() + 12;
+    }
+    outBytes.reserve(totalSize);
+
+    PutHeader(outBytes, image.width, image.height, image.channels);
+
+    for (size_t s = 0; s < segmentCount; ++s) {
+        PutChunk(outBytes, "IDAT", segments[s].data(), segments[s].size(), crcs[s]);
+    }
+    PutChunk(outBytes, "IEND", nullptr, 0, ChunkCrc("IEND", nullptr, 0));
+    return true;
+}
+
+bool PngWriter::Save(const std::string& filePath, const ImageView& image, PngCompression level) {
+    std::vector<uint8_t> bytes;
+    if (!Encode(image, level, bytes)) {
+        return false;
+    }
+
+    std::ofstream file(fs::path(filePath), std::ios::binary | std::ios::trunc);
+    if (!file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+        std::cerr << "Failed to save PNG: " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+struct PngRowEncoder::State {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    PngCompression level = PngCompression::Default;
+    size_t rowBytes = 0;
+    size_t lineBytes = 0;
+    size_t rowsPerSegment = 0;
+    std::vector<uint8_t>* out = nullptr;
+
+    std::vector<uint8_t> prior;     // 上一行原始数据
+    std::vector<uint8_t> trial;
+    std::vector<uint8_t> window;    // 历史窗口 + 当前段滤波后的数据
+    size_t historyBytes = 0;        // window 开头属于历史窗口的字节数
+    size_t segmentRows = 0;
+    int rowsWritten = 0;
+    bool firstSegment = true;
+    uint32_t adler = 1;
+};
+
+PngRowEncoder::PngRowEncoder(int width, int height, int channels, PngCompression level,
+                             std::vector<uint8_t>& outBytes) {
+    outBytes.clear();
+    if (width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+        std::cerr << "Invalid image data" << std::endl;
+        return;
+    }
+
+    m_State = std::make_unique<State>();
+    State& state = *m_State;
+    state.width = width;
+    state.height = height;
+    state.channels = channels;
+    state.level = level;
+    state.rowBytes = static_cast<size_t>(width) * channels;
+    state.lineBytes = state.rowBytes + 1;
+    state.rowsPerSegment = RowsPerSegment(state.lineBytes);
+    state.out = &outBytes;
+    state.prior.assign(state.rowBytes, 0);
+    state.trial.resize(level == PngCompression::Default ? state.rowBytes : 0);
+    state.window.reserve(Deflate::kWindowSize + state.rowsPerSegment * state.lineBytes);
+
+    PutHeader(outBytes, width, height, channels);
+}
+
+PngRowEncoder::~PngRowEncoder() = default;
+
+bool PngRowEncoder::WriteRow(const uint8_t* row) {
+    if (!m_State || m_State->rowsWritten >= m_State->height) {
+        return false;
+    }
+
+    State& state = *m_State;
+    const size_t offset = state.window.size();
+    state.window.resize(offset + state.lineBytes);
+    FilterLine(state.level, row, state.prior.data(), state.rowBytes, state.channels,
+               state.window.data() + offset, state.trial.data());
+    std::memcpy(state.prior.data(), row, state.rowBytes);
+    ++state.rowsWritten;
+
+    if (++state.segmentRows < state.rowsPerSegment && state.rowsWritten < state.height) {
+        return true;
+    }
+
+    // 段已攒满：与 Encode 相同的切段方式，输出逐字节一致
+    const bool isFinal = state.rowsWritten == state.height;
+    std::vector<uint8_t> segment;
+    if (state.firstSegment) {
+        PutZlibHeader(segment, state.level);
+        state.firstSegment = false;
+    }
+    Deflate::CompressSegment(state.window.data(), 0, state.historyBytes, state.window.size(),
+                             ToStrategy(state.level), isFinal, segment);
+    state.adler = Deflate::Adler32(state.window.data() + state.historyBytes,
+                                   state.window.size() - state.historyBytes, state.adler);
+    if (isFinal) {
+        PutUint32(segment, state.adler);
+    }
+    PutChunk(*state.out, "IDAT", segment.data(), segment.size(),
+             ChunkCrc("IDAT", segment.data(), segment.size()));
+
+    // 只保留最后 32 KB 作为下一段的历史窗口
+    state.historyBytes = std::min(state.window.size(), Deflate::kWindowSize);
+    state.window.erase(state.window.begin(), state.window.end() - state.historyBytes);
+    state.segmentRows = 0;
+    return true;
+}
+
+bool PngRowEncoder::Finish() {
+    if (!m_State || m_State->rowsWritten != m_State->height) {
+        std::cerr << "PNG stream ended before all rows were written" << std::endl;
+        return false;
+    }
+    PutChunk(*m_State->out, "IEND", nullptr, 0, ChunkCrc("IEND", nullptr, 0));
+    m_State.reset();
+    return true;
+}
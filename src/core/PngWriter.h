@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Types.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief PNG 编码器
+ *
+ * 职责：
+ * - 三个压缩级别（见 PngCompression）
+ * - 行滤波按行带并行；Default 级别逐行尝试五种滤波器，选择残差绝对值之和最小的一种
+ * - 滤波后的数据按行切成若干段，在线程池上并行压缩（分段方式见 Deflate），每段写成一个 IDAT 块
+ *
+ * 支持 1-4 通道 8 位图像（灰度、灰度 + alpha、RGB、RGBA），输入可以带行跨度。
+ */
+class PngWriter {
+public:
+    /**
+     * @brief 编码到内存
+     * @param image 图像
+     * @param level 压缩级别
+     * @param outBytes 输出 PNG 文件内容
+     * @return 成功返回 true
+     */
+    static bool Encode(const ImageView& image, PngCompression level, std::vector<uint8_t>& outBytes);
+
+    /**
+     * @brief 编码并写入文件
+     * @param filePath 文件路径
+     * @param image 图像
+     * @param level 压缩级别
+     * @return 成功返回 true
+     */
+    static bool Save(const std::string& filePath, const ImageView& image, PngCompression level);
+};
+
+/**
+ * @brief 逐行 PNG 编码器（流式处理用，整幅图像不必同时在内存中）
+ *
+ * 各行按顺序写入，每攒够一段就压缩并追加一个 IDAT 块，只保留当前段和 32 KB 历史窗口。
+ * 切段方式与 PngWriter::Encode 相同，输出逐字节一致，只是各段依次压缩而不并行。
+ */
+class PngRowEncoder {
+public:
+    /**
+     * @param width 宽度
+     * @param height 高度
+     * @param channels 通道数（1-4）
+     * @param level 压缩级别
+     * @param outBytes 输出 PNG 文件内容（先清空，随写入逐步追加）
+     */
+    PngRowEncoder(int width, int height, int channels, PngCompression level,
+                  std::vector<uint8_t>& outBytes);
+    ~PngRowEncoder();
+
+    PngRowEncoder(const PngRowEncoder&) = delete;
+    PngRowEncoder& operator=(const PngRowEncoder&) = delete;
+
+    /**
+     * @brief 写入下一行（width * channels 字节）
+     * @return 参数无效或行数已满时返回 false
+     */
+    bool WriteRow(const uint8_t* row);
+
+    /**
+     * @brief 结束编码（写入全部行后调用）
+     * @return 行数不足时返回 false
+     */
+    bool Finish();
+
+private:
+    struct State;
+    std::unique_ptr<State> m_State;
+};
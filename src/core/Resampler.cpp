@@ -0,0 +1,512 @@
+#include "Resampler.h"
+#include "ResamplerKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define STB_IMAGE_RESIZE_IMPLEMENTATION
+#include <stb_image_resize2.h>
+
+namespace {
+
+/**
+ * @brief 连续滤波函数（以 0 为中心）
+ *
+ * 缩小时滤波器按缩放比例展开（filterScale = max(1, src / dst)），
+ * 这样每个输出像素会覆盖所有对应的源像素，避免混叠。
+ */
+struct FilterKernel {
+    double (*support)(double filterScale);          // 半径（源像素单位）
+    double (*eval)(double x, double filterScale);   // 权重函数（x 为源像素单位的距离）
+};
+
+constexpr double kPi = 3.14159265358979323846;
+
+double Sinc(double x) {
+    if (x == 0.0) {
+        return 1.0;
+    }
+    x *= kPi;
+    return std::sin(x) / x;
+}
+
+double TriangleSupport(double filterScale) { return filterScale; }
+
+double TriangleEval(double x, double filterScale) {
+    x = std::fabs(x / filterScale);
+    return x < 1.0 ? 1.0 - x : 0.0;
+}
+
+// 区域平均：源像素 [x - 0.5, x + 0.5] 与输出像素窗口 [-s/2, s/2] 的重叠长度
+double AreaSupport(double filterScale) { return (filterScale + 1.0) * 0.5; }
+
+double AreaEval(double x, double filterScale) {
+    double halfWindow = filterScale * 0.5;
+    double overlap = std::min(x + 0.5, halfWindow) - std::max(x - 0.5, -halfWindow);
+    return overlap > 0.0 ? overlap : 0.0;
+}
+
+double MitchellSupport(double filterScale) { return 2.0 * filterScale; }
+
+double MitchellEval(double x, double filterScale) {
+    // B = C = 1/3
+    x = std::fabs(x / filterScale);
+    if (x < 1.0) {
+        return (7.0 * x * x * x - 12.0 * x * x + 16.0 / 3.0) / 6.0;
+    }
+    if (x < 2.0) {
+        return (-7.0 / 3.0 * x * x * x + 12.0 * x * x - 20.0 * x + 32.0 / 3.0) / 6.0;
+    }
+    return 0.0;
+}
+
+double Lanczos3Support(double filterScale) { return 3.0 * filterScale; }
+
+double Lanczos3Eval(double x, double filterScale) {
+    x = std::fabs(x / filterScale);
+    return x < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+}
+
+const FilterKernel& GetFilterKernel(ResizeFilter filter) {
+    static const FilterKernel bilinear = {TriangleSupport, TriangleEval};
+    static const FilterKernel area = {AreaSupport, AreaEval};
+    static const FilterKernel mitchell = {MitchellSupport, MitchellEval};
+    static const FilterKernel lanczos3 = {Lanczos3Support, Lanczos3Eval};
+
+    switch (filter) {
+        case ResizeFilter::Area:     return area;
+        case ResizeFilter::Mitchell: return mitchell;
+        case ResizeFilter::Lanczos3: return lanczos3;
+        case ResizeFilter::Auto:
+        case ResizeFilter::Bilinear: break;
+    }
+    return bilinear;
+}
+
+// 只为输出区间 [begin, begin + count) 构建权重（其余输出像素不会被计算）
+ResampleAxis BuildAxisWithFilter(int srcSize, int dstSize, int begin, int count,
+                                 const FilterKernel& filter) {
+    ResampleAxis axis;
+    axis.srcSize = srcSize;
+    axis.dstSize = count;
+    if (srcSize <= 0 || dstSize <= 0 || count <= 0) {
+        return axis;
+    }
+
+    const double scale = static_cast<double>(srcSize) / dstSize;
+    const double filterScale = std::max(1.0, scale);
+    const double support = filter.support(filterScale);
+    const int taps = std::min(srcSize, std::max(1, static_cast<int>(std::ceil(support * 2.0))));
+    const int one = 1 << ResampleAxis::kPrecisionBits;
+
+    axis.taps = taps;
+    axis.start.resize(count);
+    axis.weights.assign(static_cast<size_t>(count) * taps, 0);
+
+    std::vector<double> raw(taps);
+    for (int x = 0; x < count; ++x) {
+        // 像素中心对齐：输出像素中心映射回源坐标
+        const double center = (begin + x + 0.5) * scale - 0.5;
+        int lo = static_cast<int>(std::floor(center - support)) + 1;
+        int hi = static_cast<int>(std::ceil(center + support)) - 1;
+        lo = std::max(lo, 0);
+        hi = std::min(hi, srcSize - 1);
+        if (hi - lo + 1 > taps) {
+            hi = lo + taps - 1;
+        }
+
+        double sum = 0.0;
+        int count = 0;
+        if (lo <= hi) {
+            count = hi - lo + 1;
+            for (int i = 0; i < count; ++i) {
+                raw[i] = filter.eval(lo + i - center, filterScale);
+                sum += raw[i];
+            }
+        }
+
+        // 越界（或权重全为 0）时退化为最近邻
+        if (count == 0 || sum == 0.0) {
+            lo = std::min(std::max(static_cast<int>(std::lround(center)), 0), srcSize - 1);
+            count = 1;
+            raw[0] = 1.0;
+            sum = 1.0;
+        }
+
+        // 统一 taps：靠近右边界时整体左移，前面补 0
+        int start = std::min(lo, srcSize - taps);
+        int offset = lo - start;
+        axis.start[x] = start;
+
+        int16_t* w = axis.weights.data() + static_cast<size_t>(x) * taps;
+        int total = 0;
+        int largest = offset;
+        for (int i = 0; i < count; ++i) {
+            int q = static_cast<int>(std::lround(raw[i] / sum * one));
+            w[offset + i] = static_cast<int16_t>(q);
+            total += q;
+            if (std::abs(q) > std::abs(w[largest])) {
+                largest = offset + i;
+            }
+        }
+
+        // 量化误差补到最大的权重上，保证权重和恰好为 1.0
+        w[largest] = static_cast<int16_t>(w[largest] + (one - total));
+    }
+
+    return axis;
+}
+
+// stb_image_resize2 后端：x 已由 stb 换算到滤波器坐标
+float StbLanczos3Kernel(float x, float scale, void* userData) {
+    (void)scale;
+    (void)userData;
+    x = std::fabs(x);
+    return x < 3.0f ? static_cast<float>(Sinc(x) * Sinc(x / 3.0)) : 0.0f;
+}
+
+float StbLanczos3Support(float scale, void* userData) {
+    (void)scale;
+    (void)userData;
+    return 3.0f;
+}
+
+stbir_filter ToStbFilter(ResizeFilter filter) {
+    switch (filter) {
+        case ResizeFilter::Area:     return STBIR_FILTER_BOX;
+        case ResizeFilter::Mitchell: return STBIR_FILTER_MITCHELL;
+        case ResizeFilter::Lanczos3: return STBIR_FILTER_MITCHELL;  // 由回调覆盖
+        case ResizeFilter::Auto:
+        case ResizeFilter::Bilinear: break;
+    }
+    return STBIR_FILTER_TRIANGLE;
+}
+
+void InitStbResize(STBIR_RESIZE& resize, const uint8_t* src, int srcWidth, int srcHeight,
+                   size_t srcStride, int channels,
+                   uint8_t* dst, int dstWidth, int dstHeight, size_t dstStride,
+                   ResizeFilter filter) {
+    // 与内置内核保持一致：不做 alpha 加权，按普通通道处理
+    static const stbir_pixel_layout layouts[] = {
+        STBIR_1CHANNEL, STBIR_2CHANNEL, STBIR_RGB, STBIR_4CHANNEL
+    };
+
+    stbir_resize_init(&resize, src, srcWidth, srcHeight, static_cast<int>(srcStride),
+                      dst, dstWidth, dstHeight, static_cast<int>(dstStride),
+                      layouts[channels - 1], STBIR_TYPE_UINT8);
+    stbir_set_edgemodes(&resize, STBIR_EDGE_CLAMP, STBIR_EDGE_CLAMP);
+
+    // Auto 按各方向的缩放比例分别选择；stb 没有内置 Lanczos，通过回调提供
+    ResizeFilter filterX = Resampler::ResolveFilter(filter, srcWidth, dstWidth);
+    ResizeFilter filterY = Resampler::ResolveFilter(filter, srcHeight, dstHeight);
+    stbir_set_filters(&resize, ToStbFilter(filterX), ToStbFilter(filterY));
+    const bool lanczosX = filterX == ResizeFilter::Lanczos3;
+    const bool lanczosY = filterY == ResizeFilter::Lanczos3;
+    if (lanczosX || lanczosY) {
+        stbir_set_filter_callbacks(&resize,
+                                   lanczosX ? StbLanczos3Kernel : nullptr,
+                                   lanczosX ? StbLanczos3Support : nullptr,
+                                   lanczosY ? StbLanczos3Kernel : nullptr,
+                                   lanczosY ? StbLanczos3Support : nullptr);
+    }
+}
+
+const ResampleKernels& GetKernels(SimdLevel level) {
+    static const ResampleKernels scalar = {ResampleHorizontalScalar, ResampleVerticalScalar};
+#if defined(IMGTOOL_ENABLE_SIMD)
+    static const ResampleKernels sse41 = {ResampleHorizontalSSE41, ResampleVerticalSSE41};
+    static const ResampleKernels avx2 = {ResampleHorizontalAVX2, ResampleVerticalAVX2};
+
+    switch (level) {
+        case SimdLevel::AVX2:  return avx2;
+        case SimdLevel::SSE41: return sse41;
+        case SimdLevel::Scalar: break;
+    }
+#else
+    (void)level;
+#endif
+    return scalar;
+}
+
+/**
+ * @brief 构建可见列的水平权重表，起点改为相对于所需源列范围 [colBegin, colBegin + colCount)
+ */
+ResampleAxis BuildRegionAxisX(int srcWidth, int dstWidth, const Rect& region, ResizeFilter filter,
+                              int& colBegin, int& colCount) {
+    ResampleAxis axis = Resampler::BuildAxis(srcWidth, dstWidth, region.x, region.width, filter);
+    colBegin = axis.start.front();
+    colCount = axis.start.back() + axis.taps - colBegin;
+    for (int32_t& start : axis.start) {
+        start -= colBegin;
+    }
+    return axis;
+}
+
+} // namespace
+
+void ResampleHorizontalScalar(const uint8_t* src, int srcWidth, uint8_t* dst,
+                              int channels, const ResampleAxis& axis) {
+    (void)srcWidth;
+    DispatchChannels(channels, [&](auto tag) {
+        constexpr int kChannels = decltype(tag)::value;
+        for (int x = 0; x < axis.dstSize; ++x) {
+            ResampleHorizontalPixel<kChannels>(src, dst + static_cast<size_t>(x) * kChannels,
+                                               axis, x);
+        }
+    });
+}
+
+void ResampleVerticalScalar(const uint8_t* const* rows, const int16_t* weights,
+                            int taps, uint8_t* dst, size_t bytes) {
+    ResampleVerticalRange(rows, weights, taps, dst, 0, bytes);
+}
+
+ResizeFilter Resampler::ResolveFilter(ResizeFilter filter, int srcSize, int dstSize) {
+    if (filter != ResizeFilter::Auto) {
+        return filter;
+    }
+    // 大比例缩小时区域平均既快（权重均匀）又不混叠；其余情况双线性足够
+    return srcSize >= dstSize * 2 ? ResizeFilter::Area : ResizeFilter::Bilinear;
+}
+
+ResampleAxis Resampler::BuildAxis(int srcSize, int dstSize, ResizeFilter filter) {
+    return BuildAxis(srcSize, dstSize, 0, dstSize, filter);
+}
+
+ResampleAxis Resampler::BuildAxis(int srcSize, int dstSize, int begin, int count,
+                                  ResizeFilter filter) {
+    filter = ResolveFilter(filter, srcSize, dstSize);
+    return BuildAxisWithFilter(srcSize, dstSize, begin, count, GetFilterKernel(filter));
+}
+
+bool Resampler::Resize(const uint8_t* src, int srcWidth, int srcHeight, size_t srcStride,
+                       int channels,
+                       uint8_t* dst, int dstWidth, int dstHeight, size_t dstStride,
+                       ResizeFilter filter, ResizeBackend backend) {
+    if (backend == ResizeBackend::Stb) {
+        return ResizeStb(src, srcWidth, srcHeight, srcStride, channels,
+                         dst, dstWidth, dstHeight, dstStride, filter);
+    }
+    return Resize(src, srcWidth, srcHeight, srcStride, channels,
+                  dst, dstWidth, dstHeight, dstStride, filter, CpuFeatures::GetSimdLevel());
+}
+
+bool Resampler::Resize(const uint8_t* src, int srcWidth, int srcHeight, size_t srcStride,
+                       int channels,
+                       uint8_t* dst, int dstWidth, int dstHeight, size_t dstStride,
+                       ResizeFilter filter, SimdLevel level) {
+    if (!dst) {
+        return false;
+    }
+
+    const size_t dstRowBytes = static_cast<size_t>(dstWidth) * channels;
+    return ResizeRegion(ImageView(src, srcWidth, srcHeight, channels, srcStride),
+                        dstWidth, dstHeight, Rect(0, 0, dstWidth, dstHeight), filter, level,
+                        [&](int y, const uint8_t* row) {
+                            std::memcpy(dst + static_cast<size_t>(y) * dstStride, row, dstRowBytes);
+                        });
+}
+
+bool Resampler::ResizeRegion(const ImageView& source, int dstWidth, int dstHeight,
+                             const Rect& region, ResizeFilter filter, ResizeBackend backend,
+                             const ResampleRowSink& sink) {
+    if (backend == ResizeBackend::Stb) {
+        return ResizeRegionStb(source, dstWidth, dstHeight, region, filter, sink);
+    }
+    return ResizeRegion(source, dstWidth, dstHeight, region, filter,
+                        CpuFeatures::GetSimdLevel(), sink);
+}
+
+bool Resampler::ResizeRegion(const ImageView& source, int dstWidth, int dstHeight,
+                             const Rect& region, ResizeFilter filter, SimdLevel level,
+                             const ResampleRowSink& sink) {
+    const int channels = source.channels;
+    if (!source.IsValid() || dstWidth <= 0 || dstHeight <= 0 || channels > 4 ||
+        !region.IsValid() || region.x < 0 || region.y < 0 ||
+        region.Right() > dstWidth || region.Bottom() > dstHeight) {
+        return false;
+    }
+
+    const ResampleKernels& kernels = GetKernels(level);
+    const size_t rowBytes = static_cast<size_t>(region.width) * channels;
+    const bool resampleX = source.width != dstWidth;
+    const bool resampleY = source.height != dstHeight;
+
+    // 水平方向：只构建可见列的权重，并把起点改为相对于所需源列范围
+    ResampleAxis axisX;
+    int colBegin = region.x;
+    int colCount = region.width;
+    if (resampleX) {
+        axisX = BuildRegionAxisX(source.width, dstWidth, region, filter, colBegin, colCount);
+    }
+
+    // 取一行水平重采样结果（无需水平重采样时直接引用源行）
+    std::vector<uint8_t> scratch(resampleX ? rowBytes : 0);
+    auto horizontalRow = [&](int srcY, uint8_t* out) -> const uint8_t* {
+        const uint8_t* srcRow = source.Row(srcY) + static_cast<size_t>(colBegin) * channels;
+        if (!resampleX) {
+            return srcRow;
+        }
+        kernels.horizontal(srcRow, colCount, out, channels, axisX);
+        return out;
+    };
+
+    if (!resampleY) {
+        for (int y = region.y; y < region.Bottom(); ++y) {
+            sink(y, horizontalRow(y, scratch.data()));
+        }
+        return true;
+    }
+
+    // 垂直方向：滑动窗口环形缓冲，只保留 taps 行中间结果，每个源行只水平重采样一次
+    ResampleAxis axisY = BuildAxis(source.height, dstHeight, region.y, region.height, filter);
+    const int taps = axisY.taps;
+    std::vector<uint8_t> ring(static_cast<size_t>(taps) * rowBytes);
+    std::vector<int> ringRow(taps, -1);
+    std::vector<const uint8_t*> rows(taps);
+    std::vector<uint8_t> output(rowBytes);
+
+    for (int i = 0; i < region.height; ++i) {
+        const int first = axisY.start[i];
+        for (int k = 0; k < taps; ++k) {
+            const int srcY = first + k;
+            const int slot = srcY % taps;
+            uint8_t* slotData = ring.data() + static_cast<size_t>(slot) * rowBytes;
+            if (!resampleX) {
+                rows[k] = horizontalRow(srcY, nullptr);
+                continue;
+            }
+            if (ringRow[slot] != srcY) {
+                horizontalRow(srcY, slotData);
+                ringRow[slot] = srcY;
+            }
+            rows[k] = slotData;
+        }
+
+        kernels.vertical(rows.data(), axisY.weights.data() + static_cast<size_t>(i) * taps,
+                         taps, output.data(), rowBytes);
+        sink(region.y + i, output.data());
+    }
+
+    return true;
+}
+
+StreamingResampler::StreamingResampler(int srcWidth, int srcHeight, int channels,
+                                       int dstWidth, int dstHeight, const Rect& region,
+                                       ResizeFilter filter, SimdLevel level)
+    : m_Kernels(&GetKernels(level)), m_Channels(channels), m_Region(region) {
+    if (srcWidth <= 0 || srcHeight <= 0 || channels < 1 || channels > 4 ||
+        dstWidth <= 0 || dstHeight <= 0 || !region.IsValid() || region.x < 0 || region.y < 0 ||
+        region.Right() > dstWidth || region.Bottom() > dstHeight) {
+        m_Region = Rect();
+        return;
+    }
+
+    m_Valid = true;
+    m_RowBytes = static_cast<size_t>(region.width) * channels;
+    m_ResampleX = srcWidth != dstWidth;
+    m_ResampleY = srcHeight != dstHeight;
+    m_ColBegin = region.x;
+    m_ColCount = region.width;
+    if (m_ResampleX) {
+        m_AxisX = BuildRegionAxisX(srcWidth, dstWidth, region, filter, m_ColBegin, m_ColCount);
+    }
+
+    if (m_ResampleY) {
+        m_AxisY = Resampler::BuildAxis(srcHeight, dstHeight, region.y, region.height, filter);
+        m_Ring.resize(static_cast<size_t>(m_AxisY.taps) * m_RowBytes);
+        m_Rows.resize(m_AxisY.taps);
+    }
+    m_Output.resize(m_RowBytes);
+}
+
+const uint8_t* StreamingResampler::HorizontalRow(const uint8_t* srcRow, uint8_t* out) const {
+    srcRow += static_cast<size_t>(m_ColBegin) * m_Channels;
+    if (!m_ResampleX) {
+        return srcRow;
+    }
+    m_Kernels->horizontal(srcRow, m_ColCount, out, m_Channels, m_AxisX);
+    return out;
+}
+
+void StreamingResampler::PushRow(const uint8_t* srcRow, const ResampleRowSink& sink) {
+    const int srcY = m_NextSource++;
+    if (IsDone()) {
+        return;
+    }
+
+    // 无需垂直重采样：区域内的源行直接对应目标行
+    if (!m_ResampleY) {
+        if (srcY >= m_Region.y) {
+            sink(srcY, HorizontalRow(srcRow, m_Output.data()));
+            ++m_NextOutput;
+        }
+        return;
+    }
+
+    // 之后的目标行都用不到的源行直接跳过
+    if (srcY < m_AxisY.start[m_NextOutput]) {
+        return;
+    }
+
+    // 窗口内的行按源行号取模存放：目标行的 taps 个源行连续，到齐时互不覆盖
+    const int taps = m_AxisY.taps;
+    uint8_t* slot = m_Ring.data() + static_cast<size_t>(srcY % taps) * m_RowBytes;
+    const uint8_t* row = HorizontalRow(srcRow, slot);
+    if (row != slot) {
+        std::memcpy(slot, row, m_RowBytes);
+    }
+
+    while (!IsDone() && m_AxisY.start[m_NextOutput] + taps - 1 <= srcY) {
+        const int first = m_AxisY.start[m_NextOutput];
+        for (int k = 0; k < taps; ++k) {
+            m_Rows[k] = m_Ring.data() + static_cast<size_t>((first + k) % taps) * m_RowBytes;
+        }
+        m_Kernels->vertical(m_Rows.data(),
+                            m_AxisY.weights.data() + static_cast<size_t>(m_NextOutput) * taps,
+                            taps, m_Output.data(), m_RowBytes);
+        sink(m_Region.y + m_NextOutput, m_Output.data());
+        ++m_NextOutput;
+    }
+}
+
+bool Resampler::ResizeStb(const uint8_t* src, int srcWidth, int srcHeight, size_t srcStride,
+                          int channels,
+                          uint8_t* dst, int dstWidth, int dstHeight, size_t dstStride,
+                          ResizeFilter filter) {
+    if (!src || !dst || srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0 ||
+        channels < 1 || channels > 4) {
+        return false;
+    }
+
+    STBIR_RESIZE resize;
+    InitStbResize(resize, src, srcWidth, srcHeight, srcStride, channels,
+                  dst, dstWidth, dstHeight, dstStride, filter);
+    return stbir_resize_extended(&resize) != 0;
+}
+
+bool Resampler::ResizeRegionStb(const ImageView& source, int dstWidth, int dstHeight,
+                                const Rect& region, ResizeFilter filter,
+                                const ResampleRowSink& sink) {
+    const int channels = source.channels;
+    if (!source.IsValid() || dstWidth <= 0 || dstHeight <= 0 || channels > 4 ||
+        !region.IsValid() || region.x < 0 || region.y < 0 ||
+        region.Right() > dstWidth || region.Bottom() > dstHeight) {
+        return false;
+    }
+
+    // 当前 stb 版本的输出子区域会把整幅输入映射到子区域上（比例错误），
+    // 因此对照后端仍计算整幅图像，再逐行交出可见区域
+    const size_t dstRowBytes = static_cast<size_t>(dstWidth) * channels;
+    std::vector<uint8_t> output(dstRowBytes * dstHeight);
+    if (!ResizeStb(source.data, source.width, source.height, source.stride, channels,
+                   output.data(), dstWidth, dstHeight, dstRowBytes, filter)) {
+        return false;
+    }
+
+    for (int y = region.y; y < region.Bottom(); ++y) {
+        sink(y, output.data() + static_cast<size_t>(y) * dstRowBytes +
+                    static_cast<size_t>(region.x) * channels);
+    }
+    return true;
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include "Types.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief 单个方向的重采样权重表（16 位定点）
+ *
+ * 每个输出像素对应 taps 个连续的源像素，权重之和恰好为 1 << kPrecisionBits。
+ * 所有输出像素使用相同的 taps（不足的部分补 0），便于 SIMD 内核统一处理。
+ */
+struct ResampleAxis {
+    static constexpr int kPrecisionBits = 14;
+
+    int srcSize = 0;
+    int dstSize = 0;
+    int taps = 0;                  // 每个输出像素的采样点数
+    std::vector<int32_t> start;    // 每个输出像素的首个源索引（dstSize 个）
+    std::vector<int16_t> weights;  // 定点权重（dstSize * taps 个）
+};
+
+/**
+ * @brief 逐行接收重采样结果
+ * @param y 目标行号（完整目标图像坐标系）
+ * @param row 该行可见区域的像素（region.width * channels 字节，仅在回调期间有效）
+ */
+using ResampleRowSink = std::function<void(int y, const uint8_t* row)>;
+
+struct ResampleKernels;
+
+/**
+ * @brief 可分离的两遍重采样器
+ *
+ * 职责：
+ * - 预先计算每列、每行的定点权重表
+ * - 先水平后垂直两遍重采样
+ * - 按运行时检测到的指令集分派 SSE4.1 / AVX2 / 标量内核
+ * - 可选滤波器（双线性 / 区域平均 / Mitchell / Lanczos3），缩小时自动展开滤波半径
+ * - 可切换到 stb_image_resize2 后端，便于对照质量与性能
+ * - 只计算目标图像中的可见区域，逐行交给调用方（无整幅中间缓冲）
+ *
+ * 注意：所有内核使用完全相同的整数运算，标量与 SIMD 输出逐位一致
+ */
+class Resampler {
+public:
+    /**
+     * @brief 解析 Auto 滤波器
+     * @param filter 配置的滤波器
+     * @param srcSize 该方向的源尺寸
+     * @param dstSize 该方向的目标尺寸
+     * @return 实际使用的滤波器（缩小 2 倍以上为 Area，否则为 Bilinear）
+     */
+    static ResizeFilter ResolveFilter(ResizeFilter filter, int srcSize, int dstSize);
+
+    /**
+     * @brief 构建一个方向的权重表
+     * @param srcSize 源尺寸
+     * @param dstSize 目标尺寸
+     * @param filter 滤波器
+     */
+    static ResampleAxis BuildAxis(int srcSize, int dstSize,
+                                  ResizeFilter filter = ResizeFilter::Bilinear);
+
+    /**
+     * @brief 只为输出区间 [begin, begin + count) 构建权重表
+     * @return dstSize 为 count 的权重表，start 仍是源图像中的绝对索引
+     */
+    static ResampleAxis BuildAxis(int srcSize, int dstSize, int begin, int count,
+                                  ResizeFilter filter);
+
+    /**
+     * @brief 缩放像素数据
+     * @param src 源像素首地址
+     * @param srcWidth 源宽度
+     * @param srcHeight 源高度
+     * @param srcStride 源每行字节数
+     * @param channels 通道数（1-4）
+     * @param dst 目标像素首地址
+     * @param dstWidth 目标宽度
+     * @param dstHeight 目标高度
+     * @param dstStride 目标每行字节数
+     * @param filter 滤波器
+     * @param backend 实现（内置内核使用当前可用的最高 SIMD 等级）
+     * @return 参数无效时返回 false
+     */
+    static bool Resize(const uint8_t* src, int srcWidth, int srcHeight, size_t srcStride,
+                       int channels,
+                       uint8_t* dst, int dstWidth, int dstHeight, size_t dstStride,
+                       ResizeFilter filter = ResizeFilter::Auto,
+                       ResizeBackend backend = ResizeBackend::Builtin);
+
+    /**
+     * @brief 使用内置内核缩放（指定 SIMD 等级，用于校验各内核输出一致）
+     */
+    static bool Resize(const uint8_t* src, int srcWidth, int srcHeight, size_t srcStride,
+                       int channels,
+                       uint8_t* dst, int dstWidth, int dstHeight, size_t dstStride,
+                       ResizeFilter filter, SimdLevel level);
+
+    /**
+     * @brief 只计算目标图像的一个区域，逐行输出
+     * @param source 源图像
+     * @param dstWidth 完整目标宽度
+     * @param dstHeight 完整目标高度
+     * @param region 需要计算的区域（必须位于完整目标范围内）
+     * @param filter 滤波器
+     * @param backend 实现
+     * @param sink 行回调（按 y 递增顺序调用）
+     * @return 参数无效时返回 false
+     *
+     * 内置内核只保留滤波窗口内的若干行中间结果，内存占用与 region.width × taps 成正比。
+     */
+    static bool ResizeRegion(const ImageView& source, int dstWidth, int dstHeight,
+                             const Rect& region, ResizeFilter filter, ResizeBackend backend,
+                             const ResampleRowSink& sink);
+
+    /**
+     * @brief 只计算目标图像的一个区域（内置内核，指定 SIMD 等级）
+     */
+    static bool ResizeRegion(const ImageView& source, int dstWidth, int dstHeight,
+                             const Rect& region, ResizeFilter filter, SimdLevel level,
+                             const ResampleRowSink& sink);
+
+    /**
+     * @brief 使用 stb_image_resize2 缩放（浮点实现，作为对照后端）
+     */
+    static bool ResizeStb(const uint8_t* src, int srcWidth, int srcHeight, size_t srcStride,
+                          int channels,
+                          uint8_t* dst, int dstWidth, int dstHeight, size_t dstStride,
+                          ResizeFilter filter);
+
+    /**
+     * @brief 使用 stb_image_resize2 输出目标图像的一个区域
+     *
+     * stb 的输出子区域会改变缩放比例，这里仍计算整幅图像后再截取，仅作对照用。
+     */
+    static bool ResizeRegionStb(const ImageView& source, int dstWidth, int dstHeight,
+                                const Rect& region, ResizeFilter filter,
+                                const ResampleRowSink& sink);
+};
+
+/**
+ * @brief 流式重采样器：源图像逐行按顺序输入，目标行在所需的源行到齐后立即输出
+ *
+ * 与 Resampler::ResizeRegion 使用相同的权重表和内核，输出逐位一致；
+ * 只保留滤波窗口内的 taps 行水平重采样结果，内存占用与 region.width × taps 成正比，与源图像高度无关。
+ */
+class StreamingResampler {
+public:
+    /**
+     * @param srcWidth 源宽度
+     * @param srcHeight 源高度
+     * @param channels 通道数（1-4）
+     * @param dstWidth 完整目标宽度
+     * @param dstHeight 完整目标高度
+     * @param region 需要计算的区域（必须位于完整目标范围内）
+     * @param filter 滤波器
+     * @param level SIMD 等级
+     */
+    StreamingResampler(int srcWidth, int srcHeight, int channels, int dstWidth, int dstHeight,
+                       const Rect& region, ResizeFilter filter,
+                       SimdLevel level = CpuFeatures::GetSimdLevel());
+
+    /**
+     * @brief 参数是否有效
+     */
+    bool IsValid() const { return m_Valid; }
+
+    /**
+     * @brief 输入下一行源像素（srcWidth * channels 字节）
+     * @param sink 本行到齐后可以计算的目标行（按 y 递增顺序调用，可能为零行或多行）
+     */
+    void PushRow(const uint8_t* srcRow, const ResampleRowSink& sink);
+
+    /**
+     * @brief 区域内的目标行是否都已输出（之后的源行不再需要）
+     */
+    bool IsDone() const { return m_NextOutput >= m_Region.height; }
+
+private:
+    const uint8_t* HorizontalRow(const uint8_t* srcRow, uint8_t* out) const;
+
+    const ResampleKernels* m_Kernels = nullptr;
+    bool m_Valid = false;
+    int m_Channels = 0;
+    Rect m_Region;
+    size_t m_RowBytes = 0;
+    bool m_ResampleX = false;
+    bool m_ResampleY = false;
+    ResampleAxis m_AxisX;
+    int m_ColBegin = 0;
+    int m_ColCount = 0;
+    ResampleAxis m_AxisY;
+    std::vector<uint8_t> m_Ring;       // taps 行水平重采样结果（按源行号取模存放）
+    std::vector<const uint8_t*> m_Rows;
+    std::vector<uint8_t> m_Output;
+    int m_NextSource = 0;              // 下一个输入的源行号
+    int m_NextOutput = 0;              // 下一个输出的目标行（相对 region.y）
+};
@@ -0,0 +1,119 @@
+#include "ResamplerKernels.h"
+
+#if defined(IMGTOOL_ENABLE_SIMD)
+
+#include <cstring>
+#include <immintrin.h>
+
+namespace {
+
+inline __m128i LoadWeightPair(const int16_t* w) {
+    int32_t pair;
+    std::memcpy(&pair, w, sizeof(pair));
+    return _mm_set1_epi32(pair);
+}
+
+// 低 128 位使用 (w0, w1)，高 128 位使用 (w2, w3)
+inline __m256i LoadWeightQuad(const int16_t* w) {
+    const __m256i v = _mm256_castsi128_si256(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(w)));
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1));
+}
+
+} // namespace
+
+void ResampleHorizontalAVX2(const uint8_t* src, int srcWidth, uint8_t* dst,
+                            int channels, const ResampleAxis& axis) {
+    if (channels != 3 && channels != 4) {
+        ResampleHorizontalScalar(src, srcWidth, dst, channels, axis);
+        return;
+    }
+
+    const __m128i shuffle = (channels == 4)
+        ? _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15)
+        : _mm_setr_epi8(0, 3, 1, 4, 2, 5, -1, -1, 6, 9, 7, 10, 8, 11, -1, -1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi32(1 << (ResampleAxis::kPrecisionBits - 1));
+    const size_t rowBytes = static_cast<size_t>(srcWidth) * channels;
+    const int taps = axis.taps;
+
+    for (int x = 0; x < axis.dstSize; ++x) {
+        const size_t base = static_cast<size_t>(axis.start[x]) * channels;
+        const uint8_t* p = src + base;
+        const int16_t* w = axis.weights.data() + static_cast<size_t>(x) * taps;
+        const size_t readable = rowBytes - base;
+
+        // 256 位累加器：低 128 位累加第 k、k+1 个 tap，高 128 位累加第 k+2、k+3 个 tap
+        __m256i wide = _mm256_setzero_si256();
+        int k = 0;
+        for (; k + 4 <= taps && static_cast<size_t>(k) * channels + 16 <= readable; k += 4) {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + k * channels));
+            pixels = _mm_shuffle_epi8(pixels, shuffle);
+            wide = _mm256_add_epi32(wide, _mm256_madd_epi16(_mm256_cvtepu8_epi16(pixels),
+                                                            LoadWeightQuad(w + k)));
+        }
+
+        __m128i acc = _mm_add_epi32(half, _mm_add_epi32(_mm256_castsi256_si128(wide),
+                                                        _mm256_extracti128_si256(wide, 1)));
+
+        for (; k + 2 <= taps && static_cast<size_t>(k) * channels + 8 <= readable; k += 2) {
+            __m128i pixels = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + k * channels));
+            pixels = _mm_shuffle_epi8(pixels, shuffle);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero),
+                                                    LoadWeightPair(w + k)));
+        }
+
+        for (; k < taps; ++k) {
+            const uint8_t* q = p + k * channels;
+            __m128i pixel = _mm_setr_epi32(q[0], q[1], q[2], channels == 4 ? q[3] : 0);
+            acc = _mm_add_epi32(acc, _mm_mullo_epi32(pixel, _mm_set1_epi32(w[k])));
+        }
+
+        __m128i v = _mm_srai_epi32(acc, ResampleAxis::kPrecisionBits);
+        v = _mm_packus_epi16(_mm_packs_epi32(v, v), zero);
+        int32_t packed = _mm_cvtsi128_si32(v);
+        std::memcpy(dst + static_cast<size_t>(x) * channels, &packed, channels);
+    }
+}
+
+void ResampleVerticalAVX2(const uint8_t* const* rows, const int16_t* weights,
+                          int taps, uint8_t* dst, size_t bytes) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i half = _mm256_set1_epi32(1 << (ResampleAxis::kPrecisionBits - 1));
+
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i acc0 = half, acc1 = half, acc2 = half, acc3 = half;
+
+        for (int k = 0; k < taps; k += 2) {
+            const bool pair = k + 1 < taps;
+            const int16_t w[2] = {weights[k], pair ? weights[k + 1] : int16_t(0)};
+            int32_t packedWeights;
+            std::memcpy(&packedWeights, w, sizeof(packedWeights));
+            const __m256i wv = _mm256_set1_epi32(packedWeights);
+
+            __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + i));
+            __m256i r1 = pair ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k + 1] + i))
+                              : zero;
+
+            // unpack/pack 都在 128 位通道内进行，最终打包后字节顺序自然还原
+            __m256i lo = _mm256_unpacklo_epi8(r0, r1);
+            __m256i hi = _mm256_unpackhi_epi8(r0, r1);
+            acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero), wv));
+            acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero), wv));
+            acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero), wv));
+            acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero), wv));
+        }
+
+        acc0 = _mm256_srai_epi32(acc0, ResampleAxis::kPrecisionBits);
+        acc1 = _mm256_srai_epi32(acc1, ResampleAxis::kPrecisionBits);
+        acc2 = _mm256_srai_epi32(acc2, ResampleAxis::kPrecisionBits);
+        acc3 = _mm256_srai_epi32(acc3, ResampleAxis::kPrecisionBits);
+        __m256i out = _mm256_packus_epi16(_mm256_packs_epi32(acc0, acc1),
+                                          _mm256_packs_epi32(acc2, acc3));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+    }
+
+    ResampleVerticalRange(rows, weights, taps, dst, i, bytes);
+}
+
+#endif // IMGTOOL_ENABLE_SIMD
@@ -0,0 +1,118 @@
+#include "ResamplerKernels.h"
+
+#if defined(IMGTOOL_ENABLE_SIMD)
+
+#include <cstring>
+#include <smmintrin.h>
+
+namespace {
+
+inline __m128i LoadWeightPair(const int16_t* w) {
+    int32_t pair;
+    std::memcpy(&pair, w, sizeof(pair));
+    return _mm_set1_epi32(pair);
+}
+
+inline void StorePixel(uint8_t* dst, __m128i acc, int channels) {
+    __m128i v = _mm_srai_epi32(acc, ResampleAxis::kPrecisionBits);
+    v = _mm_packs_epi32(v, v);
+    v = _mm_packus_epi16(v, v);
+    int32_t packed = _mm_cvtsi128_si32(v);
+    std::memcpy(dst, &packed, channels);
+}
+
+} // namespace
+
+void ResampleHorizontalSSE41(const uint8_t* src, int srcWidth, uint8_t* dst,
+                             int channels, const ResampleAxis& axis) {
+    if (channels != 3 && channels != 4) {
+        ResampleHorizontalScalar(src, srcWidth, dst, channels, axis);
+        return;
+    }
+
+    // 把相邻两个像素重排成 (c0, c1) 交错的形式，便于 madd 一次完成两个 tap
+    const __m128i shuffle = (channels == 4)
+        ? _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15)
+        : _mm_setr_epi8(0, 3, 1, 4, 2, 5, -1, -1, 6, 9, 7, 10, 8, 11, -1, -1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi32(1 << (ResampleAxis::kPrecisionBits - 1));
+    const size_t rowBytes = static_cast<size_t>(srcWidth) * channels;
+    const int taps = axis.taps;
+
+    for (int x = 0; x < axis.dstSize; ++x) {
+        const size_t base = static_cast<size_t>(axis.start[x]) * channels;
+        const uint8_t* p = src + base;
+        const int16_t* w = axis.weights.data() + static_cast<size_t>(x) * taps;
+        const size_t readable = rowBytes - base;
+
+        __m128i acc = half;
+        int k = 0;
+
+        // 每次 4 个 tap（一次 16 字节加载，3 通道时需保证不越过行尾）
+        for (; k + 4 <= taps && static_cast<size_t>(k) * channels + 16 <= readable; k += 4) {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + k * channels));
+            pixels = _mm_shuffle_epi8(pixels, shuffle);
+            __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+            __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(lo, LoadWeightPair(w + k)));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(hi, LoadWeightPair(w + k + 2)));
+        }
+
+        // 每次 2 个 tap（8 字节加载）
+        for (; k + 2 <= taps && static_cast<size_t>(k) * channels + 8 <= readable; k += 2) {
+            __m128i pixels = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + k * channels));
+            pixels = _mm_shuffle_epi8(pixels, shuffle);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero),
+                                                    LoadWeightPair(w + k)));
+        }
+
+        // 剩余的单个 tap
+        for (; k < taps; ++k) {
+            const uint8_t* q = p + k * channels;
+            __m128i pixel = _mm_setr_epi32(q[0], q[1], q[2], channels == 4 ? q[3] : 0);
+            acc = _mm_add_epi32(acc, _mm_mullo_epi32(pixel, _mm_set1_epi32(w[k])));
+        }
+
+        StorePixel(dst + static_cast<size_t>(x) * channels, acc, channels);
+    }
+}
+
+void ResampleVerticalSSE41(const uint8_t* const* rows, const int16_t* weights,
+                           int taps, uint8_t* dst, size_t bytes) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi32(1 << (ResampleAxis::kPrecisionBits - 1));
+
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i acc0 = half, acc1 = half, acc2 = half, acc3 = half;
+
+        for (int k = 0; k < taps; k += 2) {
+            const bool pair = k + 1 < taps;
+            const int16_t w[2] = {weights[k], pair ? weights[k + 1] : int16_t(0)};
+            const __m128i wv = LoadWeightPair(w);
+
+            __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + i));
+            __m128i r1 = pair ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k + 1] + i))
+                              : zero;
+
+            // 两行交错后扩展为 16 位，madd 一次完成两行的乘加
+            __m128i lo = _mm_unpacklo_epi8(r0, r1);
+            __m128i hi = _mm_unpackhi_epi8(r0, r1);
+            acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), wv));
+            acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), wv));
+            acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), wv));
+            acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), wv));
+        }
+
+        acc0 = _mm_srai_epi32(acc0, ResampleAxis::kPrecisionBits);
+        acc1 = _mm_srai_epi32(acc1, ResampleAxis::kPrecisionBits);
+        acc2 = _mm_srai_epi32(acc2, ResampleAxis::kPrecisionBits);
+        acc3 = _mm_srai_epi32(acc3, ResampleAxis::kPrecisionBits);
+        __m128i out = _mm_packus_epi16(_mm_packs_epi32(acc0, acc1), _mm_packs_epi32(acc2, acc3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+    }
+
+    ResampleVerticalRange(rows, weights, taps, dst, i, bytes);
+}
+
+#endif // IMGTOOL_ENABLE_SIMD
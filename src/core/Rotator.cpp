@@ -0,0 +1,248 @@
+#include "Rotator.h"
+#include "RotatorKernels.h"
+#include "Compositor.h"
+#include "../task/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kRightAngleEpsilon = 1e-4;
+constexpr int kTransposeBlock = 64;
+
+WarpRowFn GetWarpRow(SimdLevel level) {
+#if defined(IMGTOOL_ENABLE_SIMD)
+    // AVX2 没有单独的实现：每个像素只有 4 个采样点，SSE4.1 已经用满一个寄存器
+    if (level >= SimdLevel::SSE41) {
+        return WarpRowSSE41;
+    }
+#else
+    (void)level;
+#endif
+    return WarpRowScalar;
+}
+
+/**
+ * @brief 按目标图像分块复制像素（64×64 块，读写都留在缓存内）
+ * @param map 目标坐标 -> 源坐标
+ */
+template <int Channels, typename Map>
+void TransposeBlocked(const ImageView& source, ImageData& result, Map map) {
+    const size_t dstStride = static_cast<size_t>(result.width) * Channels;
+
+    ThreadPool::Shared().ParallelFor(0, result.height, kTransposeBlock, [&](int y0, int y1) {
+        for (int bx = 0; bx < result.width; bx += kTransposeBlock) {
+            const int bx1 = std::min(result.width, bx + kTransposeBlock);
+            for (int y = y0; y < y1; ++y) {
+                uint8_t* dst = result.pixels.data() + static_cast<size_t>(y) * dstStride;
+                for (int x = bx; x < bx1; ++x) {
+                    int sx, sy;
+                    map(x, y, sx, sy);
+                    std::memcpy(dst + static_cast<size_t>(x) * Channels,
+                                source.Row(sy) + static_cast<size_t>(sx) * Channels, Channels);
+                }
+            }
+        }
+    });
+}
+
+template <int Channels>
+void RotateQuarter(const ImageView& source, ImageData& result, int quarterTurns) {
+    const int w = source.width;
+    const int h = source.height;
+    switch (quarterTurns) {
+        case 1: // 顺时针 90 度：dst(x, y) = src(y, h - 1 - x)
+            TransposeBlocked<Channels>(source, result, [h](int x, int y, int& sx, int& sy) {
+                sx = y;
+                sy = h - 1 - x;
+            });
+            break;
+        case 2: // 180 度：dst(x, y) = src(w - 1 - x, h - 1 - y)
+            TransposeBlocked<Channels>(source, result, [w, h](int x, int y, int& sx, int& sy) {
+                sx = w - 1 - x;
+                sy = h - 1 - y;
+            });
+            break;
+        case 3: // 顺时针 270 度：dst(x, y) = src(w - 1 - y, x)
+            TransposeBlocked<Channels>(source, result, [w](int x, int y, int& sx, int& sy) {
+                sx = w - 1 - y;
+                sy = x;
+            });
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief 求 a + b * x 落在 (lo, hi) 内的 x 区间，与 [x0, x1) 取交集
+ */
+void ClipSpan(double a, double b, double lo, double hi, double& x0, double& x1) {
+    if (std::abs(b) < 1e-12) {
+        if (a <= lo || a >= hi) {
+            x1 = x0;
+        }
+        return;
+    }
+    double t0 = (lo - a) / b;
+    double t1 = (hi - a) / b;
+    if (t0 > t1) {
+        std::swap(t0, t1);
+    }
+    x0 = std::max(x0, t0);
+    x1 = std::min(x1, t1);
+}
+
+} // namespace
+
+void WarpRowScalar(const WarpRow& row, uint8_t* dst, int count) {
+    DispatchChannels(row.channels, [&](auto tag) {
+        int64_t u = row.u;
+        int64_t v = row.v;
+        for (int x = 0; x < count; ++x) {
+            WarpPixel<decltype(tag)::value>(row, u, v, dst + static_cast<size_t>(x) * 4);
+            u += row.du;
+            v += row.dv;
+        }
+    });
+}
+
+double Rotator::NormalizeDegrees(double degrees) {
+    if (!std::isfinite(degrees)) {
+        return 0.0;
+    }
+    double result = std::fmod(degrees, 360.0);
+    if (result < 0.0) {
+        result += 360.0;
+    }
+    return result >= 360.0 ? 0.0 : result;
+}
+
+bool Rotator::IsRightAngle(double degrees, int& quarterTurns) {
+    const double normalized = NormalizeDegrees(degrees);
+    const double turns = normalized / 90.0;
+    const double nearest = std::round(turns);
+    if (std::abs(turns - nearest) * 90.0 > kRightAngleEpsilon) {
+        return false;
+    }
+    quarterTurns = static_cast<int>(nearest) % 4;
+    return true;
+}
+
+ImageData Rotator::RotateQuarterTurns(const ImageView& source, int quarterTurns) {
+    ImageData result;
+    if (!source.IsValid()) {
+        return result;
+    }
+
+    quarterTurns = ((quarterTurns % 4) + 4) % 4;
+    const bool swapAxes = (quarterTurns % 2) != 0;
+    result.width = swapAxes ? source.height : source.width;
+    result.height = swapAxes ? source.width : source.height;
+    result.channels = source.channels;
+    result.pixels = PixelBuffer::Allocate(result.GetSize());
+
+    if (quarterTurns == 0) {
+        const size_t rowBytes = static_cast<size_t>(source.width) * source.channels;
+        for (int y = 0; y < source.height; ++y) {
+            std::memcpy(result.pixels.data() + static_cast<size_t>(y) * rowBytes,
+                        source.Row(y), rowBytes);
+        }
+        return result;
+    }
+
+    const bool supported = DispatchChannels(source.channels, [&](auto tag) {
+        RotateQuarter<decltype(tag)::value>(source, result, quarterTurns);
+    });
+    if (!supported) {
+        return ImageData();
+    }
+    return result;
+}
+
+void Rotator::RotatedBounds(double width, double height, double degrees,
+                            double& outWidth, double& outHeight) {
+    const double radians = NormalizeDegrees(degrees) * kPi / 180.0;
+    const double c = std::abs(std::cos(radians));
+    const double s = std::abs(std::sin(radians));
+    outWidth = width * c + height * s;
+    outHeight = width * s + height * c;
+}
+
+bool Rotator::WarpInto(ImageData& canvas, const ImageView& source,
+                       const AffinePlacement& placement) {
+    return WarpInto(canvas, source, placement, CpuFeatures::GetSimdLevel());
+}
+
+bool Rotator::WarpInto(ImageData& canvas, const ImageView& source,
+                       const AffinePlacement& placement, SimdLevel level) {
+    if (!canvas.IsValid() || canvas.channels != 4 || !source.IsValid() ||
+        source.channels < 1 || source.channels > 4 ||
+        placement.layerWidth <= 0.0 || placement.layerHeight <= 0.0) {
+        return false;
+    }
+
+    const double radians = NormalizeDegrees(placement.degrees) * kPi / 180.0;
+    const double cosA = std::cos(radians);
+    const double sinA = std::sin(radians);
+    const double scaleX = source.width / placement.layerWidth;
+    const double scaleY = source.height / placement.layerHeight;
+
+    // 逆映射：画布像素中心 (x + 0.5, y + 0.5) -> 源坐标（源像素中心为整数点）
+    //   u = w / 2 - 0.5 + scaleX * ( cos * dx + sin * dy)
+    //   v = h / 2 - 0.5 + scaleY * (-sin * dx + cos * dy)
+    const double duDx = scaleX * cosA;
+    const double dvDx = -scaleY * sinA;
+    const double duDy = scaleX * sinA;
+    const double dvDy = scaleY * cosA;
+    const double originX = 0.5 - placement.centerX;
+    const double originY = 0.5 - placement.centerY;
+    const double u0 = source.width * 0.5 - 0.5 + duDx * originX + duDy * originY;
+    const double v0 = source.height * 0.5 - 0.5 + dvDx * originX + dvDy * originY;
+
+    const double fixedOne = static_cast<double>(1 << kWarpCoordBits);
+    const WarpRowFn warpRow = GetWarpRow(level);
+    const size_t canvasStride = static_cast<size_t>(canvas.width) * 4;
+
+    ThreadPool::Shared().ParallelFor(0, canvas.height, kTransposeBlock, [&](int y0, int y1) {
+        std::vector<uint8_t> buffer(canvasStride);
+
+        for (int y = y0; y < y1; ++y) {
+            const double rowU = u0 + duDy * y;
+            const double rowV = v0 + dvDy * y;
+
+            // 只有 (-1, size) 内的采样点有非零贡献，其余像素保持画布原样
+            double spanBegin = 0.0;
+            double spanEnd = canvas.width;
+            ClipSpan(rowU, duDx, -1.0, source.width, spanBegin, spanEnd);
+            ClipSpan(rowV, dvDx, -1.0, source.height, spanBegin, spanEnd);
+            if (spanBegin >= spanEnd) {
+                continue;
+            }
+            const int x0 = std::max(0, static_cast<int>(std::floor(spanBegin)) - 1);
+            const int x1 = std::min(canvas.width, static_cast<int>(std::ceil(spanEnd)) + 1);
+            if (x0 >= x1) {
+                continue;
+            }
+
+            WarpRow row;
+            row.src = source.data;
+            row.width = source.width;
+            row.height = source.height;
+            row.channels = source.channels;
+            row.stride = source.stride;
+            row.u = std::llround((rowU + duDx * x0) * fixedOne);
+            row.v = std::llround((rowV + dvDx * x0) * fixedOne);
+            row.du = std::llround(duDx * fixedOne);
+            row.dv = std::llround(dvDx * fixedOne);
+
+            warpRow(row, buffer.data(), x1 - x0);
+            Compositor::BlendRowPremultiplied(canvas.pixels.data() + y * canvasStride + x0 * 4,
+                                              buffer.data(), x1 - x0, level);
+        }
+    });
+
+    return true;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include "Types.h"
+
+/**
+ * @brief 图层的仿射放置：缩放到 layerWidth × layerHeight 后绕中心旋转
+ */
+struct AffinePlacement {
+    double layerWidth = 0.0;   // 旋转前的图层宽度（画布像素）
+    double layerHeight = 0.0;  // 旋转前的图层高度（画布像素）
+    double centerX = 0.0;      // 图层中心在画布中的位置
+    double centerY = 0.0;
+    double degrees = 0.0;      // 顺时针旋转角度
+};
+
+/**
+ * @brief 旋转
+ *
+ * 职责：
+ * - 90/180/270 度无损旋转（分块转置，缓存友好）
+ * - 任意角度：缩放 + 旋转 + 合成一次完成（双线性仿射变换，直接写入画布）
+ * - 按运行时检测到的指令集分派 SSE4.1 / 标量内核
+ *
+ * 注意：角度均为顺时针、以度为单位；所有内核使用相同的整数运算，标量与 SIMD 输出逐位一致
+ */
+class Rotator {
+public:
+    /**
+     * @brief 把角度规范到 [0, 360)
+     */
+    static double NormalizeDegrees(double degrees);
+
+    /**
+     * @brief 判断是否为直角旋转
+     * @param degrees 角度
+     * @param quarterTurns 输出顺时针 90 度的次数（0-3）
+     * @return 是直角（含 0 度）时返回 true
+     */
+    static bool IsRightAngle(double degrees, int& quarterTurns);
+
+    /**
+     * @brief 无损直角旋转
+     * @param source 源图像
+     * @param quarterTurns 顺时针 90 度的次数（0-3）
+     * @return 旋转后的图像（紧密排列）
+     */
+    static ImageData RotateQuarterTurns(const ImageView& source, int quarterTurns);
+
+    /**
+     * @brief 计算图像旋转后的外接矩形尺寸
+     */
+    static void RotatedBounds(double width, double height, double degrees,
+                              double& outWidth, double& outHeight);
+
+    /**
+     * @brief 把源图像按仿射放置直接合成到画布
+     * @param canvas 画布图像（RGBA）
+     * @param source 源图像（1-4 通道）
+     * @param placement 图层的尺寸、中心和角度
+     * @return 参数无效时返回 false
+     *
+     * 双线性采样，图层边缘按覆盖率抗锯齿。缩小到一半以下时调用方应先用 Resampler 预缩小，
+     * 否则会产生混叠。
+     */
+    static bool WarpInto(ImageData& canvas, const ImageView& source,
+                         const AffinePlacement& placement);
+
+    /**
+     * @brief 仿射合成（指定 SIMD 等级，用于校验各内核输出一致）
+     */
+    static bool WarpInto(ImageData& canvas, const ImageView& source,
+                         const AffinePlacement& placement, SimdLevel level);
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Rotator.h"
+#include "CompositorKernels.h"
+#include "PixelKernels.h"
+
+/**
+ * @file RotatorKernels.h
+ * @brief 仿射变换内核（仅供 Rotator 及其 SIMD 实现文件内部使用）
+ *
+ * 坐标为 16.16 定点；双线性权重每个方向 7 位，合计 14 位（与 Resampler 相同）。
+ * 输出为预乘 alpha 的 RGBA，落在源图像外的采样点视为完全透明。
+ */
+
+constexpr int kWarpCoordBits = 16;
+constexpr int kWarpFracBits = 7;
+constexpr int kWarpWeightBits = kWarpFracBits * 2;
+
+/**
+ * @brief 一行仿射采样的参数
+ */
+struct WarpRow {
+    const uint8_t* src = nullptr;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    size_t stride = 0;
+    int64_t u = 0;   // 第一个输出像素的采样坐标（以源像素中心为整数点）
+    int64_t v = 0;
+    int64_t du = 0;  // 每个输出像素的步进
+    int64_t dv = 0;
+};
+
+using WarpRowFn = void (*)(const WarpRow& row, uint8_t* dst, int count);
+
+// 标量实现（Rotator.cpp）
+void WarpRowScalar(const WarpRow& row, uint8_t* dst, int count);
+
+#if defined(IMGTOOL_ENABLE_SIMD)
+// SSE4.1 实现（RotatorSSE41.cpp）
+void WarpRowSSE41(const WarpRow& row, uint8_t* dst, int count);
+#endif
+
+/**
+ * @brief 单个输出像素的双线性采样（标量，处理任意位置，包括图像边缘）
+ *
+ * 累加 w * (c * a) 与 w * (255 * a)，再依次 >> 14、/ 255 得到预乘结果。
+ */
+template <int Channels>
+inline void WarpPixel(const WarpRow& row, int64_t u, int64_t v, uint8_t* dst) {
+    const int x0 = static_cast<int>(u >> kWarpCoordBits);
+    const int y0 = static_cast<int>(v >> kWarpCoordBits);
+    const int fx = static_cast<int>((u >> (kWarpCoordBits - kWarpFracBits)) & ((1 << kWarpFracBits) - 1));
+    const int fy = static_cast<int>((v >> (kWarpCoordBits - kWarpFracBits)) & ((1 << kWarpFracBits) - 1));
+    const int one = 1 << kWarpFracBits;
+    const uint32_t weights[4] = {
+        static_cast<uint32_t>((one - fx) * (one - fy)), static_cast<uint32_t>(fx * (one - fy)),
+        static_cast<uint32_t>((one - fx) * fy),         static_cast<uint32_t>(fx * fy)
+    };
+
+    uint32_t acc[4] = {0, 0, 0, 0};
+    for (int k = 0; k < 4; ++k) {
+        const int x = x0 + (k & 1);
+        const int y = y0 + (k >> 1);
+        if (x < 0 || y < 0 || x >= row.width || y >= row.height) {
+            continue;
+        }
+        uint32_t rgba[4];
+        LoadRGBA<Channels>(row.src + static_cast<size_t>(y) * row.stride +
+                           static_cast<size_t>(x) * Channels, rgba);
+        acc[0] += weights[k] * (rgba[0] * rgba[3]);
+        acc[1] += weights[k] * (rgba[1] * rgba[3]);
+        acc[2] += weights[k] * (rgba[2] * rgba[3]);
+        acc[3] += weights[k] * (255 * rgba[3]);
+    }
+
+    const uint32_t half = 1u << (kWarpWeightBits - 1);
+    for (int c = 0; c < 4; ++c) {
+        dst[c] = static_cast<uint8_t>(CompositeDiv255((acc[c] + half) >> kWarpWeightBits));
+    }
+}
+
+/**
+ * @brief 单个输出像素的双线性采样（运行时通道数，供 SIMD 内核处理边缘像素）
+ */
+inline void WarpPixel(const WarpRow& row, int64_t u, int64_t v, uint8_t* dst) {
+    DispatchChannels(row.channels, [&](auto tag) {
+        WarpPixel<decltype(tag)::value>(row, u, v, dst);
+    });
+}
@@ -0,0 +1,86 @@
+#include "RotatorKernels.h"
+#include <cstring>
+
+#if defined(IMGTOOL_ENABLE_SIMD)
+
+#include <smmintrin.h>
+
+namespace {
+
+// 读取一个像素到 32 位通道 (r, g, b, a)
+inline __m128i LoadPixel(const uint8_t* p, int channels) {
+    if (channels == 4) {
+        int32_t value;
+        std::memcpy(&value, p, 4);
+        return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(value));
+    }
+    // RGB 只读 3 个字节，避免越过图像末尾
+    const uint32_t value = p[0] | (p[1] << 8) | (p[2] << 16) | 0xFF000000u;
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int>(value)));
+}
+
+// (c * a, c * a, c * a, 255 * a)
+inline __m128i Premultiply(__m128i px) {
+    const __m128i alpha = _mm_shuffle_epi32(px, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128i color = _mm_blend_epi16(px, _mm_set1_epi32(255), 0xC0);
+    return _mm_mullo_epi32(color, alpha);
+}
+
+// 与 CompositeDiv255 相同的 32 位版本
+inline __m128i Div255(__m128i x) {
+    x = _mm_add_epi32(x, _mm_set1_epi32(128));
+    return _mm_srli_epi32(_mm_add_epi32(x, _mm_srli_epi32(x, 8)), 8);
+}
+
+} // namespace
+
+void WarpRowSSE41(const WarpRow& row, uint8_t* dst, int count) {
+    // 灰度图没有向量化收益，全部走标量
+    if (row.channels != 3 && row.channels != 4) {
+        WarpRowScalar(row, dst, count);
+        return;
+    }
+
+    const int one = 1 << kWarpFracBits;
+    const int fracMask = one - 1;
+    const int fracShift = kWarpCoordBits - kWarpFracBits;
+    const __m128i half = _mm_set1_epi32(1 << (kWarpWeightBits - 1));
+    const size_t pixelBytes = static_cast<size_t>(row.channels);
+
+    int64_t u = row.u;
+    int64_t v = row.v;
+    for (int x = 0; x < count; ++x, u += row.du, v += row.dv) {
+        const int x0 = static_cast<int>(u >> kWarpCoordBits);
+        const int y0 = static_cast<int>(v >> kWarpCoordBits);
+
+        // 4 个采样点不全在图像内时由标量版本处理（边缘抗锯齿）
+        if (x0 < 0 || y0 < 0 || x0 + 1 >= row.width || y0 + 1 >= row.height) {
+            WarpPixel(row, u, v, dst + static_cast<size_t>(x) * 4);
+            continue;
+        }
+
+        const int fx = static_cast<int>(u >> fracShift) & fracMask;
+        const int fy = static_cast<int>(v >> fracShift) & fracMask;
+
+        const uint8_t* p0 = row.src + static_cast<size_t>(y0) * row.stride +
+                            static_cast<size_t>(x0) * pixelBytes;
+        const uint8_t* p1 = p0 + row.stride;
+
+        __m128i acc = _mm_mullo_epi32(Premultiply(LoadPixel(p0, row.channels)),
+                                      _mm_set1_epi32((one - fx) * (one - fy)));
+        acc = _mm_add_epi32(acc, _mm_mullo_epi32(Premultiply(LoadPixel(p0 + pixelBytes, row.channels)),
+                                                 _mm_set1_epi32(fx * (one - fy))));
+        acc = _mm_add_epi32(acc, _mm_mullo_epi32(Premultiply(LoadPixel(p1, row.channels)),
+                                                 _mm_set1_epi32((one - fx) * fy)));
+        acc = _mm_add_epi32(acc, _mm_mullo_epi32(Premultiply(LoadPixel(p1 + pixelBytes, row.channels)),
+                                                 _mm_set1_epi32(fx * fy)));
+
+        // 累加值最大 16384 * 255 * 255，无符号 32 位不会溢出
+        __m128i out = Div255(_mm_srli_epi32(_mm_add_epi32(acc, half), kWarpWeightBits));
+        out = _mm_packus_epi16(_mm_packus_epi32(out, out), out);
+        const int32_t value = _mm_cvtsi128_si32(out);
+        std::memcpy(dst + static_cast<size_t>(x) * 4, &value, 4);
+    }
+}
+
+#endif // IMGTOOL_ENABLE_SIMD
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "PixelBuffer.h"
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -59,7 +61,7 @@ struct ImageData {
     int width = 0;
     int height = 0;
     int channels = 0;
-    std::vector<uint8_t> pixels;
+    PixelBuffer pixels;  // 可直接接管解码器分配的内存
 
     bool IsValid() const {
         return width > 0 && height > 0 && channels > 0 && !pixels.empty();
@@ -70,17 +72,94 @@ struct ImageData {
     }
 };
 
+/**
+ * @brief 图像视图（不拥有像素数据，支持行跨度）
+ *
+ * 用于在处理流程各阶段之间传递图像而不复制像素。
+ * 视图的生命周期不能超过其引用的像素缓冲。
+ */
+struct ImageView {
+    const uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    size_t stride = 0;  // 每行字节数
+
+    ImageView() = default;
+    ImageView(const uint8_t* data, int w, int h, int c, size_t stride)
+        : data(data), width(w), height(h), channels(c), stride(stride) {}
+
+    // 允许从 ImageData 隐式构造（紧密排列，stride = width * channels）
+    ImageView(const ImageData& image)
+        : data(image.pixels.data()), width(image.width), height(image.height),
+          channels(image.channels), stride(static_cast<size_t>(image.width) * image.channels) {}
+
+    bool IsValid() const {
+        return data != nullptr && width > 0 && height > 0 && channels > 0;
+    }
+
+    const uint8_t* Row(int y) const {
+        return data + static_cast<size_t>(y) * stride;
+    }
+
+    /**
+     * @brief 子区域视图（区域会被裁剪到视图范围内，无交集时返回无效视图）
+     */
+    ImageView SubView(const Rect& region) const {
+        int x0 = region.x > 0 ? region.x : 0;
+        int y0 = region.y > 0 ? region.y : 0;
+        int x1 = region.Right() < width ? region.Right() : width;
+        int y1 = region.Bottom() < height ? region.Bottom() : height;
+        if (!IsValid() || x1 <= x0 || y1 <= y0) {
+            return ImageView();
+        }
+        return ImageView(Row(y0) + static_cast<size_t>(x0) * channels,
+                         x1 - x0, y1 - y0, channels, stride);
+    }
+};
+
 /**
  * @brief 图层（图像在画布中的位置）
  */
 struct ImageLayer {
-    ImageData image;
+    ImageView image;    // 图层像素（只引用，不复制）
     Rect position;      // 在画布中的位置
     float scale = 1.0f; // 缩放比例
 
     ImageLayer() = default;
 };
 
+/**
+ * @brief 按行顺序读取的图像（流式处理的输入，整幅图像不必同时在内存中）
+ */
+struct RowSource {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::function<bool(uint8_t* row)> readRow;  // 读取下一行（width * channels 字节），出错返回 false
+
+    bool IsValid() const {
+        return width > 0 && height > 0 && channels > 0 && readRow != nullptr;
+    }
+};
+
+/**
+ * @brief 画布模板（预先填充好背景色，同一批次内的任务共享，按需复制）
+ */
+struct CanvasTemplate {
+    Canvas canvas;      // 模板对应的画布配置
+    ImageData image;    // 已填充背景的 RGBA 像素
+
+    bool Matches(const Canvas& other) const {
+        return image.IsValid() &&
+               canvas.width == other.width && canvas.height == other.height &&
+               canvas.background.r == other.background.r &&
+               canvas.background.g == other.background.g &&
+               canvas.background.b == other.background.b &&
+               canvas.background.a == other.background.a;
+    }
+};
+
 /**
  * @brief 裁剪参数
  */
@@ -105,6 +184,25 @@ enum class ScaleMode {
     FixedHeight     // 固定高度
 };
 
+/**
+ * @brief 重采样滤波器
+ */
+enum class ResizeFilter {
+    Auto,       // 自动（缩小 2 倍以上用区域平均，其余用双线性）
+    Bilinear,   // 双线性（三角滤波，缩小时按比例展开）
+    Area,       // 区域平均（按源像素覆盖面积加权）
+    Mitchell,   // Mitchell-Netravali（B = C = 1/3）
+    Lanczos3    // Lanczos（a = 3）
+};
+
+/**
+ * @brief 重采样实现
+ */
+enum class ResizeBackend {
+    Builtin,    // 内置定点 SIMD 内核
+    Stb         // stb_image_resize2（用于对照测试）
+};
+
 /**
  * @brief 对齐方式
  */
@@ -125,7 +223,26 @@ enum class Alignment {
  */
 enum class OutputFormat {
     JPG,
-    PNG
+    PNG,
+    WebP    // 需要 libwebp（IMGTOOL_ENABLE_WEBP）
+};
+
+/**
+ * @brief PNG 压缩级别
+ */
+enum class PngCompression {
+    Store,    // 不压缩（最快，文件最大）
+    Fast,     // 单一滤波器 + 固定 Huffman 编码
+    Default   // 逐行选择滤波器 + 哈希链匹配 + 动态 Huffman 编码
+};
+
+/**
+ * @brief WebP 编码参数
+ */
+struct WebpOptions {
+    bool lossless = false;  // 无损压缩
+    int quality = 90;       // 有损：画质；无损：压缩力度（0-100）
+    int method = 4;         // 速度与文件大小的权衡（0 = 最快，6 = 最慢、文件最小）
 };
 
 /**
@@ -138,6 +255,11 @@ struct ProcessConfig {
     Alignment alignment = Alignment::MiddleCenter;
     OutputFormat format = OutputFormat::PNG;
     int jpgQuality = 95; // 1-100
+    PngCompression pngCompression = PngCompression::Default;
+    WebpOptions webp;
+    ResizeFilter resizeFilter = ResizeFilter::Auto;
+    ResizeBackend resizeBackend = ResizeBackend::Builtin;
+    uint64_t streamingPixelThreshold = 100000000;  // 输入超过该像素数时逐行流式处理（0 = 从不）
 
     ProcessConfig() = default;
 };
@@ -150,7 +272,7 @@ struct ImageTransformState {
     float scaleY = 1.0f;
     float positionX = 0.0f;
     float positionY = 0.0f;
-    float rotation = 0.0f;
+    float rotation = 0.0f;      // 顺时针旋转角度（度）
     bool hasTransform = false;  // 是否有自定义变换
     
     ImageTransformState() = default;
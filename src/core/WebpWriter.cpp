@@ -0,0 +1,143 @@
+#include "WebpWriter.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#if defined(IMGTOOL_HAS_LIBWEBP)
+#include <webp/encode.h>
+#endif
+
+namespace fs = std::filesystem;
+
+#if defined(IMGTOOL_HAS_LIBWEBP)
+
+namespace {
+
+/**
+ * @brief 把 1、2 通道图像展开为 RGB / RGBA（libwebp 只接受 RGB(A) 输入）
+ */
+std::vector<uint8_t> ExpandGray(const ImageView& image) {
+    const int outChannels = image.channels == 2 ? 4 : 3;
+    std::vector<uint8_t> out(static_cast<size_t>(image.width) * image.height * outChannels);
+    uint8_t* dst = out.data();
+    for (int y = 0; y < image.height; ++y) {
+        const uint8_t* src = image.Row(y);
+        for (int x = 0; x < image.width; ++x) {
+            const uint8_t gray = src[x * image.channels];
+            dst[0] = gray;
+            dst[1] = gray;
+            dst[2] = gray;
+            if (outChannels == 4) {
+                dst[3] = src[x * image.channels + 1];
+            }
+            dst += outChannels;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+bool WebpWriter::IsAvailable() {
+    return true;
+}
+
+bool WebpWriter::Encode(const ImageView& image, const WebpOptions& options, std::vector<uint8_t>& outBytes) {
+    outBytes.clear();
+    if (!image.IsValid() || image.channels < 1 || image.channels > 4) {
+        std::cerr << "Invalid image data" << std::endl;
+        return false;
+    }
+    if (image.width > WEBP_MAX_DIMENSION || image.height > WEBP_MAX_DIMENSION) {
+        std::cerr << "Image too large for WebP: " << image.width << "x" << image.height << std::endl;
+        return false;
+    }
+
+    WebPConfig config;
+    if (!WebPConfigPreset(&config, WEBP_PRESET_DEFAULT, static_cast<float>(std::clamp(options.quality, 0, 100)))) {
+        std::cerr << "WebP version mismatch" << std::endl;
+        return false;
+    }
+    config.lossless = options.lossless ? 1 : 0;
+    config.method = std::clamp(options.method, 0, 6);
+    if (!WebPValidateConfig(&config)) {
+        std::cerr << "Invalid WebP config" << std::endl;
+        return false;
+    }
+
+    WebPPicture picture;
+    if (!WebPPictureInit(&picture)) {
+        std::cerr << "WebP version mismatch" << std::endl;
+        return false;
+    }
+    // 无损编码直接使用 ARGB；有损编码由导入函数转换为 YUV420
+    picture.use_argb = config.lossless;
+    picture.width = image.width;
+    picture.height = image.height;
+
+    std::vector<uint8_t> expanded;
+    const uint8_t* pixels = image.data;
+    int stride = static_cast<int>(image.stride);
+    int channels = image.channels;
+    if (channels <= 2) {
+        expanded = ExpandGray(image);
+        channels = channels == 2 ? 4 : 3;
+        pixels = expanded.data();
+        stride = image.width * channels;
+    }
+
+    const int imported = channels == 4 ? WebPPictureImportRGBA(&picture, pixels, stride)
+                                       : WebPPictureImportRGB(&picture, pixels, stride);
+    if (!imported) {
+        std::cerr << "Failed to import image into WebP picture" << std::endl;
+        WebPPictureFree(&picture);
+        return false;
+    }
+    expanded = std::vector<uint8_t>();  // 导入时已复制，提前释放
+
+    WebPMemoryWriter writer;
+    WebPMemoryWriterInit(&writer);
+    picture.writer = WebPMemoryWrite;
+    picture.custom_ptr = &writer;
+
+    const bool ok = WebPEncode(&config, &picture) != 0;
+    if (ok) {
+        outBytes.assign(writer.mem, writer.mem + writer.size);
+    } else {
+        std::cerr << "WebP encode failed (error " << picture.error_code << ")" << std::endl;
+    }
+
+    WebPMemoryWriterClear(&writer);
+    WebPPictureFree(&picture);
+    return ok;
+}
+
+#else
+
+bool WebpWriter::IsAvailable() {
+    return false;
+}
+
+bool WebpWriter::Encode(const ImageView& /*image*/, const WebpOptions& /*options*/,
+                        std::vector<uint8_t>& outBytes) {
+    outBytes.clear();
+    std::cerr << "WebP support not compiled in (IMGTOOL_ENABLE_WEBP)" << std::endl;
+    return false;
+}
+
+#endif
+
+bool WebpWriter::Save(const std::string& filePath, const ImageView& image, const WebpOptions& options) {
+    std::vector<uint8_t> bytes;
+    if (!Encode(image, options, bytes)) {
+        return false;
+    }
+
+    std::ofstream file(fs::path(filePath), std::ios::binary | std::ios::trunc);
+    if (!file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+        std::cerr << "Failed to save WebP: " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
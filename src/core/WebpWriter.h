@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Types.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief WebP 编码器（libwebp 封装）
+ *
+ * 职责：
+ * - 有损 / 无损两种模式，画质与压缩力度见 WebpOptions
+ * - 1、3 通道输出不带 alpha 的 WebP，2、4 通道保留 alpha
+ *
+ * 未启用 IMGTOOL_ENABLE_WEBP 时 IsAvailable() 返回 false，编码总是失败。
+ */
+class WebpWriter {
+public:
+    /**
+     * @brief 是否编译了 WebP 支持
+     */
+    static bool IsAvailable();
+
+    /**
+     * @brief 编码到内存
+     * @param image 图像
+     * @param options 编码参数
+     * @param outBytes 输出 WebP 文件内容
+     * @return 成功返回 true
+     */
+    static bool Encode(const ImageView& image, const WebpOptions& options, std::vector<uint8_t>& outBytes);
+
+    /**
+     * @brief 编码并写入文件
+     * @param filePath 文件路径
+     * @param image 图像
+     * @param options 编码参数
+     * @return 成功返回 true
+     */
+    static bool Save(const std::string& filePath, const ImageView& image, const WebpOptions& options);
+};
@@ -0,0 +1,495 @@
+#include "AsyncFileWriter.h"
+#include "utils/Logger.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <filesystem>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define IMGTOOL_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace {
+
+// 单次写请求的最大字节数
+constexpr size_t kWriteChunk = 4 * 1024 * 1024;
+
+// io_uring 模式下同时在写的文件数
+constexpr unsigned kMaxOpenFiles = 8;
+
+#ifdef _WIN32
+
+bool WriteWholeFile(const std::string& filePath, const std::vector<uint8_t>& bytes) {
+    // UTF-8 路径转换为宽字符，支持中文文件名
+    const std::wstring wpath = std::filesystem::path(filePath).wstring();
+    HANDLE file = CreateFileW(wpath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        Logger::Error("Failed to create " + filePath + " (error " + std::to_string(GetLastError()) + ")");
+        return false;
+    }
+
+    size_t offset = 0;
+    bool ok = true;
+    while (offset < bytes.size()) {
+        const DWORD chunk = static_cast<DWORD>(std::min(bytes.size() - offset, kWriteChunk));
+        DWORD written = 0;
+        if (!WriteFile(file, bytes.data() + offset, chunk, &written, nullptr) || written == 0) {
+            Logger::Error("Failed to write " + filePath + " (error " + std::to_string(GetLastError()) + ")");
+            ok = false;
+            break;
+        }
+        offset += written;
+    }
+    CloseHandle(file);
+    return ok;
+}
+
+#else
+
+int OpenForWrite(const std::string& filePath) {
+    int fd;
+    do {
+        fd = open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0) {
+        Logger::Error("Failed to create " + filePath + ": " + std::strerror(errno));
+    }
+    return fd;
+}
+
+bool CloseFile(int fd, const std::string& filePath) {
+    // 部分文件系统（NFS 等）在 close 时才报告写入错误
+    if (close(fd) != 0 && errno != EINTR) {
+        Logger::Error("Failed to close " + filePath + ": " + std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 从 offset 开始用 pwrite 写完剩余内容
+ */
+bool WriteFrom(int fd, const std::string& filePath, const std::vector<uint8_t>& bytes, size_t offset) {
+    while (offset < bytes.size()) {
+        const size_t chunk = std::min(bytes.size() - offset, kWriteChunk);
+        const ssize_t written = pwrite(fd, bytes.data() + offset, chunk, static_cast<off_t>(offset));
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            Logger::Error("Failed to write " + filePath + ": " +
+                          (written < 0 ? std::strerror(errno) : "no progress"));
+            return false;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool WriteWholeFile(const std::string& filePath, const std::vector<uint8_t>& bytes) {
+    const int fd = OpenForWrite(filePath);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = WriteFrom(fd, filePath, bytes, 0);
+    return CloseFile(fd, filePath) && ok;
+}
+
+#endif
+
+} // namespace
+
+#if defined(IMGTOOL_HAS_IO_URING)
+
+/**
+ * @brief 最小的 io_uring 封装（直接使用系统调用，不依赖 liburing）
+ *
+ * 只有写入线程使用，提交队列和完成队列都是单生产者单消费者。
+ */
+class AsyncFileWriter::Ring {
+public:
+    ~Ring() {
+        if (m_Sqes) munmap(m_Sqes, m_SqesSize);
+        if (m_CqPtr && m_CqPtr != m_SqPtr) munmap(m_CqPtr, m_CqSize);
+        if (m_SqPtr) munmap(m_SqPtr, m_SqSize);
+        if (m_Fd >= 0) close(m_Fd);
+    }
+
+    bool Init(unsigned entries) {
+        io_uring_params params{};
+        m_Fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (m_Fd < 0) {
+            return false;
+        }
+        // IORING_OP_WRITE 与 IORING_FEAT_RW_CUR_POS 同在 5.6 引入
+        if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+            return false;
+        }
+
+        m_SqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_CqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMap) {
+            m_SqSize = m_CqSize = std::max(m_SqSize, m_CqSize);
+        }
+
+        m_SqPtr = Map(m_SqSize, IORING_OFF_SQ_RING);
+        if (!m_SqPtr) {
+            return false;
+        }
+        m_CqPtr = singleMap ? m_SqPtr : Map(m_CqSize, IORING_OFF_CQ_RING);
+        if (!m_CqPtr) {
+            return false;
+        }
+        m_SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        m_Sqes = static_cast<io_uring_sqe*>(Map(m_SqesSize, IORING_OFF_SQES));
+        if (!m_Sqes) {
+            return false;
+        }
+
+        uint8_t* sq = static_cast<uint8_t*>(m_SqPtr);
+        uint8_t* cq = static_cast<uint8_t*>(m_CqPtr);
+        m_SqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        m_SqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        m_SqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        m_SqEntries = params.sq_entries;
+        m_SqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        m_CqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        m_CqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        m_CqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        m_Cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    /**
+     * @brief 加入一个写请求（提交队列已满时返回 false）
+     */
+    bool QueueWrite(int fd, const void* data, size_t size, uint64_t offset, uint64_t userData) {
+        const unsigned tail = *m_SqTail;
+        if (tail - __atomic_load_n(m_SqHead, __ATOMIC_ACQUIRE) >= m_SqEntries) {
+            return false;
+        }
+        const unsigned index = tail & m_SqMask;
+        io_uring_sqe& sqe = m_Sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_WRITE;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(data);
+        sqe.len = static_cast<uint32_t>(size);
+        sqe.off = offset;
+        sqe.user_data = userData;
+        m_SqArray[index] = index;
+        __atomic_store_n(m_SqTail, tail + 1, __ATOMIC_RELEASE);
+        ++m_Unsubmitted;
+        return true;
+    }
+
+    /**
+     * @brief 提交所有排队的请求并至少等待一个完成
+     * @return 系统调用失败时返回 false（errno 保留）
+     */
+    bool SubmitAndWait() {
+        while (true) {
+            const long result = syscall(__NR_io_uring_enter, m_Fd, m_Unsubmitted, 1,
+                                        IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (result >= 0) {
+                m_Unsubmitted -= static_cast<unsigned>(result);
+                return true;
+            }
+            if (errno != EINTR) {
+                return false;
+            }
+        }
+    }
+
+    /**
+     * @brief 取出一个完成事件（没有时返回 false）
+     */
+    bool PopCompletion(uint64_t& userData, int& result) {
+        const unsigned head = *m_CqHead;
+        if (head == __atomic_load_n(m_CqTail, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+        const io_uring_cqe& cqe = m_Cqes[head & m_CqMask];
+        userData = cqe.user_data;
+        result = cqe.res;
+        __atomic_store_n(m_CqHead, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    /**
+     * @brief 撤回内核尚未取走的请求，并等待已提交的请求全部完成（完成事件被丢弃）
+     * @param outstanding 已加入队列但还没有取出完成事件的请求数
+     * @return 等待失败时返回 false，此时在途请求仍可能读取它们的缓冲区
+     */
+    bool Drain(unsigned outstanding) {
+        // 没有 SQPOLL 时内核只在 io_uring_enter 中读取尾指针，可以直接回退
+        const unsigned head = __atomic_load_n(m_SqHead, __ATOMIC_ACQUIRE);
+        outstanding -= *m_SqTail - head;
+        __atomic_store_n(m_SqTail, head, __ATOMIC_RELEASE);
+        m_Unsubmitted = 0;
+
+        uint64_t userData = 0;
+        int result = 0;
+        while (outstanding > 0) {
+            if (PopCompletion(userData, result)) {
+                --outstanding;
+                continue;
+            }
+            const long entered = syscall(__NR_io_uring_enter, m_Fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (entered < 0 && errno != EINTR) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    void* Map(size_t size, off_t offset) {
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_Fd, offset);
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+
+    int m_Fd = -1;
+    void* m_SqPtr = nullptr;
+    void* m_CqPtr = nullptr;
+    size_t m_SqSize = 0;
+    size_t m_CqSize = 0;
+    io_uring_sqe* m_Sqes = nullptr;
+    size_t m_SqesSize = 0;
+
+    unsigned* m_SqHead = nullptr;
+    unsigned* m_SqTail = nullptr;
+    unsigned* m_SqArray = nullptr;
+    unsigned m_SqMask = 0;
+    unsigned m_SqEntries = 0;
+    unsigned m_Unsubmitted = 0;
+
+    unsigned* m_CqHead = nullptr;
+    unsigned* m_CqTail = nullptr;
+    unsigned m_CqMask = 0;
+    io_uring_cqe* m_Cqes = nullptr;
+};
+
+#else
+
+class AsyncFileWriter::Ring {};
+
+#endif
+
+AsyncFileWriter::AsyncFileWriter(size_t maxInFlightBytes)
+    : m_MaxInFlightBytes(maxInFlightBytes) {
+#if defined(IMGTOOL_HAS_IO_URING)
+    auto ring = std::make_unique<Ring>();
+    if (ring->Init(kMaxOpenFiles)) {
+        m_Ring = std::move(ring);
+        m_UseRing = true;
+    } else {
+        Logger::Info("io_uring unavailable, using pwrite for output files");
+    }
+#endif
+    m_Thread = std::thread(&AsyncFileWriter::WriterThread, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_JobAvailable.notify_all();
+    if (m_Thread.joinable()) {
+        m_Thread.join();
+    }
+}
+
+void AsyncFileWriter::Write(std::string filePath, std::vector<uint8_t> bytes, Completion onComplete) {
+    const size_t size = bytes.size();
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_SpaceAvailable.wait(lock, [&]() {
+            return m_InFlightJobs == 0 || m_InFlightBytes + size <= m_MaxInFlightBytes;
+        });
+        m_InFlightBytes += size;
+        m_InFlightJobs++;
+        m_Queue.push_back({std::move(filePath), std::move(bytes), std::move(onComplete)});
+    }
+    m_JobAvailable.notify_one();
+}
+
+void AsyncFileWriter::Flush() {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_SpaceAvailable.wait(lock, [this]() { return m_InFlightJobs == 0; });
+}
+
+size_t AsyncFileWriter::GetInFlightBytes() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_InFlightBytes;
+}
+
+void AsyncFileWriter::WriterThread() {
+    while (true) {
+        std::deque<Job> jobs;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_JobAvailable.wait(lock, [this]() { return m_Stop || !m_Queue.empty(); });
+            if (m_Queue.empty()) {
+                return;  // 已停止且没有剩余文件
+            }
+            jobs.swap(m_Queue);
+        }
+        m_BusySince = std::chrono::steady_clock::now();
+
+        if (m_UseRing && !WriteWithRing(jobs)) {
+            m_UseRing = false;
+        }
+        WriteBlocking(jobs);
+    }
+}
+
+void AsyncFileWriter::WriteBlocking(std::deque<Job>& jobs) {
+    while (!jobs.empty()) {
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        Complete(job, WriteWholeFile(job.path, job.bytes));
+    }
+}
+
+#if defined(IMGTOOL_HAS_IO_URING)
+
+bool AsyncFileWriter::WriteWithRing(std::deque<Job>& jobs) {
+    struct Active {
+        Job job;
+        int fd = -1;
+        size_t offset = 0;
+    };
+    std::vector<std::unique_ptr<Active>> active;
+
+    auto queueNext = [this](Active& file) {
+        const size_t chunk = std::min(file.job.bytes.size() - file.offset, kWriteChunk);
+        // 每个文件最多一个在途请求，提交队列的容量等于同时打开的文件数，不会满
+        return m_Ring->QueueWrite(file.fd, file.job.bytes.data() + file.offset, chunk, file.offset,
+                                  reinterpret_cast<uint64_t>(&file));
+    };
+    auto finish = [&](Active& file, bool success) {
+        success = CloseFile(file.fd, file.job.path) && success;
+        Complete(file.job, success);
+        active.erase(std::find_if(active.begin(), active.end(),
+                                  [&](const std::unique_ptr<Active>& a) { return a.get() == &file; }));
+    };
+
+    while (true) {
+        // 补满空出的位置：先用本批次的文件，再从队列中取新到的文件
+        while (active.size() < kMaxOpenFiles) {
+            if (jobs.empty()) {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (m_Queue.empty()) {
+                    break;
+                }
+                jobs.push_back(std::move(m_Queue.front()));
+                m_Queue.pop_front();
+            }
+            auto file = std::make_unique<Active>();
+            file->job = std::move(jobs.front());
+            jobs.pop_front();
+
+            file->fd = OpenForWrite(file->job.path);
+            if (file->fd < 0) {
+                Complete(file->job, false);
+                continue;
+            }
+            if (file->job.bytes.empty()) {
+                Complete(file->job, CloseFile(file->fd, file->job.path));
+                continue;
+            }
+            queueNext(*file);
+            active.push_back(std::move(file));
+        }
+        if (active.empty()) {
+            return true;
+        }
+
+        if (!m_Ring->SubmitAndWait()) {
+            // io_uring 本身出错：已打开的文件改用 pwrite 从头写完（按偏移写入，重复写同一位置无害）。
+            // 每个文件正好有一个请求在队列中或在途，必须等它们结束才能关闭文件、释放缓冲区
+            Logger::Warning(std::string("io_uring_enter failed, falling back to pwrite: ") + std::strerror(errno));
+            const bool drained = m_Ring->Drain(static_cast<unsigned>(active.size()));
+            if (!drained) {
+                Logger::Error(std::string("Failed to wait for io_uring writes: ") + std::strerror(errno));
+            }
+            while (!active.empty()) {
+                Active& file = *active.front();
+                const bool success = WriteFrom(file.fd, file.job.path, file.job.bytes, 0);
+                if (!drained) {
+                    // 内核可能仍在读取原缓冲区，只能泄漏；换入同样大小的缓冲区以保持在途字节的计数
+                    auto* stranded = new std::vector<uint8_t>(file.job.bytes.size());
+                    stranded->swap(file.job.bytes);
+                }
+                finish(file, success);
+            }
+            return false;
+        }
+
+        uint64_t userData = 0;
+        int result = 0;
+        while (m_Ring->PopCompletion(userData, result)) {
+            Active& file = *reinterpret_cast<Active*>(userData);
+            if (result == -EINTR || result == -EAGAIN) {
+                queueNext(file);
+                continue;
+            }
+            if (result <= 0) {
+                Logger::Error("Failed to write " + file.job.path + ": " +
+                              (result < 0 ? std::strerror(-result) : "no progress"));
+                finish(file, false);
+                continue;
+            }
+            file.offset += static_cast<size_t>(result);
+            if (file.offset >= file.job.bytes.size()) {
+                finish(file, true);
+            } else {
+                queueNext(file);
+            }
+        }
+    }
+}
+
+#else
+
+bool AsyncFileWriter::WriteWithRing(std::deque<Job>&) {
+    return false;
+}
+
+#endif
+
+void AsyncFileWriter::Complete(Job& job, bool success) {
+    // 把上一个文件完成以来的时间计入工作时间（写入线程从取到文件起一直在工作）
+    const auto now = std::chrono::steady_clock::now();
+    m_BusyMicros += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - m_BusySince).count());
+    m_BusySince = now;
+
+    if (job.onComplete) {
+        job.onComplete(success);
+    }
+    const size_t size = job.bytes.size();
+    std::vector<uint8_t>().swap(job.bytes);  // 尽早释放内存
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_InFlightBytes -= size;
+        m_InFlightJobs--;
+    }
+    m_SpaceAvailable.notify_all();
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 异步文件写入器
+ *
+ * 职责：
+ * - 编码线程把编码好的文件内容交给写入器后立即返回，由专门的写入线程完成磁盘写入
+ * - 整个文件以大块顺序写入：Linux 上优先使用 io_uring（多个文件的写请求同时在途），
+ *   不可用时（内核太旧、被容器禁用）退回 pwrite；Windows 使用 WriteFile
+ * - 在途字节数有上限：超过上限时 Write() 阻塞，输出盘较慢时编码线程自然减速，内存不会无限增长
+ *
+ * 注意：完成回调在写入线程上调用，应尽量简短
+ */
+class AsyncFileWriter {
+public:
+    using Completion = std::function<void(bool success)>;
+
+    // 默认的在途字节上限
+    static constexpr size_t kDefaultMaxInFlightBytes = 256 * 1024 * 1024;
+
+    /**
+     * @brief 构造函数（启动写入线程）
+     * @param maxInFlightBytes 已提交但尚未写完的字节数上限
+     */
+    explicit AsyncFileWriter(size_t maxInFlightBytes = kDefaultMaxInFlightBytes);
+
+    /**
+     * @brief 析构函数（写完所有已提交的文件后退出）
+     */
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    /**
+     * @brief 提交一个文件（覆盖已有文件）
+     * @param filePath 文件路径（UTF-8）
+     * @param bytes 文件内容（所有权转移给写入器）
+     * @param onComplete 写入完成或失败后调用（可为空）
+     *
+     * 在途字节数加上本文件超过上限时阻塞，直到已有文件写完腾出空间；
+     * 没有在途文件时总是立即接受（单个文件可以超过上限）。
+     */
+    void Write(std::string filePath, std::vector<uint8_t> bytes, Completion onComplete = nullptr);
+
+    /**
+     * @brief 等待所有已提交的文件写完
+     */
+    void Flush();
+
+    /**
+     * @brief 当前在途字节数
+     */
+    size_t GetInFlightBytes() const;
+
+    /**
+     * @brief 写入线程累计的工作时间（微秒，不含等待新文件的空闲时间）
+     *
+     * 在调用每个文件的完成回调之前更新，回调中读取到的值已包含该文件。
+     */
+    uint64_t GetBusyMicroseconds() const { return m_BusyMicros.load(); }
+
+    /**
+     * @brief 是否在使用 io_uring
+     */
+    bool UsesIoUring() const { return m_UseRing; }
+
+private:
+    struct Job {
+        std::string path;
+        std::vector<uint8_t> bytes;
+        Completion onComplete;
+    };
+
+    void WriterThread();
+
+    /**
+     * @brief 逐个文件同步写入（pwrite / WriteFile）
+     */
+    void WriteBlocking(std::deque<Job>& jobs);
+
+    /**
+     * @brief 通过 io_uring 同时写入多个文件（队列中新到的文件会补进空出的位置）
+     * @return io_uring 出错需要退回同步写入时返回 false（未完成的文件留在 jobs 中）
+     */
+    bool WriteWithRing(std::deque<Job>& jobs);
+
+    /**
+     * @brief 完成一个文件：调用回调并释放在途字节
+     */
+    void Complete(Job& job, bool success);
+
+private:
+    class Ring;
+
+    const size_t m_MaxInFlightBytes;
+    std::unique_ptr<Ring> m_Ring;         // io_uring 不可用时为空
+    std::atomic<bool> m_UseRing{false};   // 出错后退回同步写入
+
+    std::atomic<uint64_t> m_BusyMicros{0};
+    std::chrono::steady_clock::time_point m_BusySince;  // 只由写入线程访问
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_JobAvailable;  // 写入线程等待新文件
+    std::condition_variable m_SpaceAvailable; // Write() 等待在途字节下降；Flush() 等待清空
+    std::deque<Job> m_Queue;
+    size_t m_InFlightBytes = 0;
+    size_t m_InFlightJobs = 0;
+    bool m_Stop = false;
+
+    std::thread m_Thread;
+};
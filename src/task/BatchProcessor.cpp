@@ -1,16 +1,240 @@
 #include "BatchProcessor.h"
+#include "BoundedQueue.h"
+#include "CancellationToken.h"
+#include "ThreadPool.h"
 #include "core/ImageLoader.h"
 #include "core/ImageProcessor.h"
+#include "utils/MappedFile.h"
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <filesystem>
 #include <iostream>
+#include <utility>
 
-BatchProcessor::BatchProcessor() = default;
+/**
+ * @brief 一张图片在流水线中的状态（各阶段依次填充，用完的数据尽早释放）
+ */
+struct BatchProcessor::Job {
+    const BatchTask* task = nullptr;
+    const ImageTransformState* transform = nullptr;  // 用户的变换状态（没有变换时为空）
+    bool failed = false;
+    bool streaming = false;        // 超大图片：解码阶段一次完成解码、处理和编码
+    int decodeScale = 1;
+    MappedFile file;               // 读取阶段读入的文件内容
+    ImageData image;               // 解码结果
+    ImageData canvas;              // 处理结果
+    std::vector<uint8_t> encoded;  // 编码结果
+};
+
+/**
+ * @brief 一个批次的流水线：任务列表、阶段之间的队列和各阶段的线程
+ */
+struct BatchProcessor::Pipeline {
+    using JobQueue = BoundedQueue<std::unique_ptr<Job>>;
+
+    BatchProcessor& owner;
+    BatchProgress& progress;
+    std::vector<BatchTask> tasks;
+    CanvasTemplate canvasTemplate;  // 同一批次通常共用一个画布配置：背景只填充一次，各任务按需复制
+    std::atomic<size_t> nextTask{0};
+    CancellationToken token;  // 各阶段线程绑定的取消令牌
+
+    JobQueue decodeQueue;
+    JobQueue processQueue;
+    JobQueue encodeQueue;
+    std::vector<std::thread> threads;
+
+    Pipeline(BatchProcessor& processor, std::vector<BatchTask> batch, size_t queueCapacity)
+        : owner(processor), progress(processor.m_Progress), tasks(std::move(batch)),
+          decodeQueue(queueCapacity), processQueue(queueCapacity), encodeQueue(queueCapacity) {}
+
+    ~Pipeline() {
+        Join();
+    }
+
+    /**
+     * @brief 等待所有阶段线程退出（所有队列都会在上游线程退出时关闭，这里只需等待）
+     */
+    void Join() {
+        for (auto& thread : threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    /**
+     * @brief 启动一个阶段
+     * @param count 线程数
+     * @param input 输入队列（为空时从任务列表领取新任务）
+     * @param output 输出队列（为空表示最后一级）；该阶段最后一个退出的线程关闭它
+     * @param work 处理一个任务（失败时设置 job.failed，任务仍交给下一阶段）
+     *
+     * 每个任务开始前等待暂停结束；取消后任务不再执行，也不交给下一阶段，在这里计入 cancelled。
+     */
+    void Launch(size_t count, JobQueue* input, JobQueue* output, std::function<void(Job&)> work) {
+        auto alive = std::make_shared<std::atomic<size_t>>(count);
+        for (size_t i = 0; i < count; ++i) {
+            threads.emplace_back([this, count, input, output, work, alive]() {
+                // 内核（ParallelFor、流式处理）通过线程绑定的令牌响应暂停和取消
+                CancellationToken::ScopedToken scopedToken(&token);
+
+                std::unique_ptr<Job> job;
+                while (input ? input->Pop(job) : Take(job)) {
+                    const bool run = token.WaitWhilePaused();
+                    if (run) {
+                        // 剩余图片少于本阶段线程数时，空闲的核心用于单张图片内部的分块并行；
+                        // 否则跨图片并行已经占满所有核心，单张图片在本线程上串行处理
+                        const size_t remaining = progress.total - progress.GetFinished();
+                        ThreadPool::ScopedParallelism parallelism(remaining < count);
+
+                        try {
+                            work(*job);
+                        } catch (const std::exception& e) {
+                            std::cerr << "Exception processing " << job->task->inputPath << ": "
+                                      << e.what() << std::endl;
+                            job->failed = true;
+                        }
+                    }
+
+                    // 最后一级的 work 已经计数；之前的阶段在取消后丢弃任务，不再交给下游
+                    if (!run || (output && token.IsCancelled())) {
+                        progress.cancelled++;
+                        owner.NotifyProgress();
+                    } else if (output) {
+                        output->Push(std::move(job));
+                    }
+                    job.reset();
+                }
+                if (--*alive == 0 && output) {
+                    output->Close();
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief 从任务列表领取下一个任务
+     * @return 任务已领完时返回 false
+     */
+    bool Take(std::unique_ptr<Job>& job) {
+        const size_t index = nextTask++;
+        if (index >= tasks.size()) {
+            return false;
+        }
+        job = std::make_unique<Job>();
+        job->task = &tasks[index];
+        return true;
+    }
+
+    /**
+     * @brief 取消：不再领取新任务，尚未领取的任务立即计入 cancelled
+     * @return 尚未领取的任务数
+     */
+    size_t Cancel() {
+        token.Cancel();
+        const size_t taken = std::min(nextTask.exchange(tasks.size()), tasks.size());
+        const size_t abandoned = tasks.size() - taken;
+        progress.cancelled += abandoned;
+        owner.NotifyProgress();
+        return abandoned;
+    }
+};
+
+namespace {
+
+size_t ResolveThreads(size_t count) {
+    return count > 0 ? count : std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+bool UsesPreprocessed(const BatchTask& task) {
+    return task.usePreprocessed && task.preprocessedImage.IsValid();
+}
+
+/**
+ * @brief 作用域计时：析构时把经过的时间（微秒）累加到 total
+ */
+class ScopedStageTimer {
+public:
+    explicit ScopedStageTimer(std::atomic<uint64_t>& total)
+        : m_Total(total), m_Start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedStageTimer() {
+        m_Total += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - m_Start).count());
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    std::atomic<uint64_t>& m_Total;
+    std::chrono::steady_clock::time_point m_Start;
+};
+
+/**
+ * @brief 按时间加权的指数移动平均速率
+ *
+ * 两次采样相隔 dt 秒时，新速率的权重为 1 - exp(-dt / kTimeConstant)，与采样频率无关。
+ * 平均值从 0 开始，按批次开始以来已累积的权重修正，开始阶段不会偏低。
+ */
+class RateMeter {
+public:
+    static constexpr double kTimeConstant = 5.0;  // 秒
+
+    /**
+     * @brief 更新并返回当前速率
+     * @param now 批次开始以来的秒数
+     * @param value 累计量
+     */
+    double Update(double now, double value) {
+        const double dt = now - m_LastTime;
+        if (dt > 0.0) {
+            const double alpha = 1.0 - std::exp(-dt / kTimeConstant);
+            m_Average += alpha * ((value - m_LastValue) / dt - m_Average);
+            m_LastTime = now;
+            m_LastValue = value;
+        }
+        const double weight = 1.0 - std::exp(-m_LastTime / kTimeConstant);
+        return weight > 0.0 ? m_Average / weight : 0.0;
+    }
+
+private:
+    double m_LastTime = 0.0;
+    double m_LastValue = 0.0;
+    double m_Average = 0.0;
+};
+
+} // namespace
+
+void BatchProgress::Reset(size_t taskCount) {
+    total = taskCount;
+    completed = 0;
+    failed = 0;
+    cancelled = 0;
+    running = true;
+    paused = false;
+    inputBytes = 0;
+    outputBytes = 0;
+    decodeMicros = 0;
+    processMicros = 0;
+    encodeMicros = 0;
+    writeMicros = 0;
+    imagesPerSecond = 0.0;
+    inputMBPerSecond = 0.0;
+    outputMBPerSecond = 0.0;
+    etaSeconds = -1.0;
+}
+
+BatchProcessor::BatchProcessor(const BatchPipelineOptions& options)
+    : m_Options(options) {}
 
 BatchProcessor::~BatchProcessor() {
     Stop();
 }
 
-void BatchProcessor::Start(const std::vector<BatchTask>& tasks,
+void BatchProcessor::Start(std::vector<BatchTask> tasks,
                             ProgressCallback onProgress,
                             CompletionCallback onComplete) {
     if (m_Progress.running) {
@@ -18,113 +242,276 @@ void BatchProcessor::Start(const std::vector<BatchTask>& tasks,
         return;
     }
 
-    // 确保上一次的监控线程已经结束
-    if (m_MonitorThread.joinable()) {
-        m_StopMonitor = true;
-        m_MonitorThread.join();
+    // 确保上一次的监控线程和流水线线程已经结束
+    StopMonitor();
+    if (m_Pipeline) {
+        m_Pipeline->Join();
     }
+    m_Pipeline.reset();
 
     // 重置进度状态
-    m_Progress.total = tasks.size();
-    m_Progress.completed = 0;
-    m_Progress.failed = 0;
-    m_Progress.running = true;
+    m_Progress.Reset(tasks.size());
+    m_WriteBusyAtStart = m_FileWriter.GetBusyMicroseconds();
 
     m_OnProgress = onProgress;
     m_OnComplete = onComplete;
 
-    // 提交所有任务到线程池
-    for (const auto& task : tasks) {
-        m_ThreadPool.Submit([this, task]() {
-            bool success = ProcessTask(task);
-            if (success) {
-                m_Progress.completed++;
-            } else {
-                m_Progress.failed++;
-            }
-        });
+    // 任务列表整体移入流水线，预处理图像的像素不发生复制
+    m_Pipeline = std::make_unique<Pipeline>(*this, std::move(tasks), m_Options.queueCapacity);
+    if (!m_Pipeline->tasks.empty()) {
+        m_Pipeline->canvasTemplate = ImageProcessor::CreateCanvasTemplate(m_Pipeline->tasks.front().config.canvas);
     }
 
+    // 读取 → 解码 → 处理 → 编码（→ 写入线程）；队列满时上游阻塞，队列关闭后下游取完即退出
+    Pipeline& pipeline = *m_Pipeline;
+    pipeline.Launch(ResolveThreads(m_Options.readThreads), nullptr, &pipeline.decodeQueue,
+                    [this](Job& job) { ReadJob(job); });
+    pipeline.Launch(ResolveThreads(m_Options.decodeThreads), &pipeline.decodeQueue,
+                    &pipeline.processQueue, [this](Job& job) { DecodeJob(job); });
+    pipeline.Launch(ResolveThreads(m_Options.processThreads), &pipeline.processQueue,
+                    &pipeline.encodeQueue, [this](Job& job) { ProcessJob(job); });
+    pipeline.Launch(ResolveThreads(m_Options.encodeThreads), &pipeline.encodeQueue, nullptr,
+                    [this](Job& job) { EncodeJob(job); });
+
     // 启动监控线程
-    m_StopMonitor = false;
+    {
+        std::lock_guard<std::mutex> lock(m_EventMutex);
+        m_StopMonitor = false;
+    }
     m_MonitorThread = std::thread(&BatchProcessor::MonitorThread, this);
 }
 
+size_t BatchProcessor::Cancel() {
+    if (!m_Pipeline || !m_Progress.running) {
+        return 0;
+    }
+
+    const size_t abandoned = m_Pipeline->Cancel();
+    m_Progress.paused = false;
+
+    // 共享线程池中其他调用方的任务不能丢弃；本批次残留的 ParallelFor 辅助任务
+    // 运行时发现取消或块已领完会立即返回，无需清理
+    std::cout << "Batch cancelled: " << abandoned << " tasks abandoned" << std::endl;
+    return abandoned;
+}
+
+void BatchProcessor::Pause() {
+    if (m_Pipeline && m_Progress.running) {
+        m_Pipeline->token.Pause();
+        m_Progress.paused = true;
+    }
+}
+
+void BatchProcessor::Resume() {
+    if (m_Pipeline) {
+        m_Pipeline->token.Resume();
+        m_Progress.paused = false;
+    }
+}
+
 void BatchProcessor::Stop() {
-    m_StopMonitor = true;
-    if (m_MonitorThread.joinable()) {
-        m_MonitorThread.join();
+    // 先停监控线程：Stop 不触发完成回调（需要回调时用 Cancel）
+    StopMonitor();
+
+    // 流水线线程在下一个检查点退出；线程仍会访问 m_Pipeline，先等它们结束再释放
+    Cancel();
+    if (m_Pipeline) {
+        m_Pipeline->Join();
     }
+    m_Pipeline.reset();
     m_Progress.running = false;
+    m_Progress.paused = false;
 }
 
-bool BatchProcessor::ProcessTask(const BatchTask& task) {
-    try {
-        // ✅ 优先使用预处理的图片数据（如果有修改，如删除选区）
-        ImageData source;
-        if (task.usePreprocessed && task.preprocessedImage.IsValid()) {
-            std::cout << "Using preprocessed image data for: " << task.inputPath << std::endl;
-            source = task.preprocessedImage;
-        } else {
-            // 从磁盘加载原始图片
-            if (!ImageLoader::Load(task.inputPath, source)) {
-                std::cerr << "Failed to load: " << task.inputPath << std::endl;
-                return false;
-            }
-        }
+void BatchProcessor::ReadJob(Job& job) {
+    const BatchTask& task = *job.task;
 
-        // 处理图片，传递用户的变换状态
-        const ImageTransformState* transformPtr = task.transformState.hasTransform ? &task.transformState : nullptr;
-        ImageData result = ImageProcessor::Process(source, task.config, transformPtr);
-        if (!result.IsValid()) {
-            std::cerr << "Failed to process: " << task.inputPath << std::endl;
-            return false;
-        }
+    // 用户的变换状态（旋转不依赖变换矩形，单独判断）
+    job.transform = (task.transformState.hasTransform || task.transformState.rotation != 0.0f)
+                        ? &task.transformState : nullptr;
 
-        // 保存图片
-        bool saved = false;
-        if (task.config.format == OutputFormat::PNG) {
-            saved = ImageLoader::SavePNG(task.outputPath, result);
-        } else {
-            saved = ImageLoader::SaveJPG(task.outputPath, result, task.config.jpgQuality);
+    // ✅ 优先使用预处理的图片数据（如果有修改，如删除选区），不读取文件
+    if (UsesPreprocessed(task)) {
+        return;
+    }
+
+    // 超大图片由解码阶段边读边处理，这里不读入整个文件
+    job.streaming = ImageProcessor::PlanFileLoad(task.inputPath, task.config, job.transform,
+                                                 job.decodeScale);
+    if (job.streaming) {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(task.inputPath, ec);
+        if (!ec) {
+            m_Progress.inputBytes += size;
         }
+        return;
+    }
 
-        if (!saved) {
-            std::cerr << "Failed to save: " << task.outputPath << std::endl;
-            return false;
+    std::string error;
+    if (!job.file.Open(task.inputPath, &error)) {
+        std::cerr << "Failed to load: " << task.inputPath << " (" << error << ")" << std::endl;
+        job.failed = true;
+        return;
+    }
+    job.file.Preload();
+    m_Progress.inputBytes += job.file.Size();
+}
+
+void BatchProcessor::DecodeJob(Job& job) {
+    const BatchTask& task = *job.task;
+    if (job.failed || UsesPreprocessed(task)) {
+        return;
+    }
+
+    if (job.streaming) {
+        ScopedStageTimer timer(m_Progress.processMicros);
+        job.failed = !ImageProcessor::ProcessFile(task.inputPath, task.config, job.transform,
+                                                  &m_Pipeline->canvasTemplate, job.encoded);
+        return;
+    }
+
+    // 输出远小于原图时 JPEG 直接以缩小的分辨率解码（倍数由读取阶段算好）
+    ScopedStageTimer timer(m_Progress.decodeMicros);
+    if (!ImageLoader::LoadFromMemory(job.file.Data(), job.file.Size(), job.decodeScale, job.image)) {
+        std::cerr << "Failed to load: " << task.inputPath << std::endl;
+        job.failed = true;
+    }
+    job.file.Close();
+}
+
+void BatchProcessor::ProcessJob(Job& job) {
+    const BatchTask& task = *job.task;
+    if (job.failed || job.streaming) {
+        return;
+    }
+
+    const bool preprocessed = UsesPreprocessed(task);
+    if (preprocessed) {
+        std::cout << "Using preprocessed image data for: " << task.inputPath << std::endl;
+    }
+
+    // 处理图片，传递用户的变换状态；预处理数据直接引用，不复制
+    const ImageView source = preprocessed ? ImageView(task.preprocessedImage) : ImageView(job.image);
+    ScopedStageTimer timer(m_Progress.processMicros);
+    job.canvas = ImageProcessor::Process(source, task.config, job.transform,
+                                         &m_Pipeline->canvasTemplate);
+    job.image = ImageData();
+    if (!job.canvas.IsValid() && !m_Pipeline->token.IsCancelled()) {
+        std::cerr << "Failed to process: " << task.inputPath << std::endl;
+        job.failed = true;
+    }
+}
+
+void BatchProcessor::EncodeJob(Job& job) {
+    const BatchTask& task = *job.task;
+
+    // 编码到内存，由写入线程落盘；本线程不等待磁盘，直接处理下一张
+    if (!job.failed && !job.streaming) {
+        ScopedStageTimer timer(m_Progress.encodeMicros);
+        if (!ImageLoader::EncodeToMemory(job.canvas, task.config.format, task.config.jpgQuality,
+                                         job.encoded, task.config.pngCompression,
+                                         task.config.webp)) {
+            std::cerr << "Failed to encode: " << task.outputPath << std::endl;
+            job.failed = true;
         }
+        job.canvas = ImageData();  // 在可能因写入背压而阻塞之前释放像素
+    }
 
-        return true;
+    // 编码期间被取消时结果可能不完整，不写入文件
+    if (m_Pipeline->token.IsCancelled()) {
+        m_Progress.cancelled++;
+        NotifyProgress();
+        return;
     }
-    catch (const std::exception& e) {
-        std::cerr << "Exception processing " << task.inputPath << ": " << e.what() << std::endl;
-        return false;
+
+    // 最后一级统一计数：失败的任务在这里计入，成功的任务在文件写完后由写入器回调计入
+    if (job.failed) {
+        m_Progress.failed++;
+        NotifyProgress();
+        return;
     }
+
+    const size_t size = job.encoded.size();
+    m_FileWriter.Write(task.outputPath, std::move(job.encoded),
+                       [this, path = task.outputPath, size](bool ok) {
+        m_Progress.writeMicros = m_FileWriter.GetBusyMicroseconds() - m_WriteBusyAtStart;
+        if (ok) {
+            m_Progress.outputBytes += size;
+            m_Progress.completed++;
+        } else {
+            std::cerr << "Failed to save: " << path << std::endl;
+            m_Progress.failed++;
+        }
+        NotifyProgress();
+    });
 }
 
 void BatchProcessor::MonitorThread() {
-    using namespace std::chrono_literals;
+    const auto start = std::chrono::steady_clock::now();
+    RateMeter imageRate;
+    RateMeter inputRate;
+    RateMeter outputRate;
+
+    uint64_t seen = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_EventMutex);
+        seen = m_EventCount;
+    }
+
+    while (true) {
+        // 更新速率：已处理的图片（不含取消的）决定剩余时间
+        const double now = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const size_t processed = m_Progress.completed + m_Progress.failed;
+        const double rate = imageRate.Update(now, static_cast<double>(processed));
+        m_Progress.imagesPerSecond = rate;
+        m_Progress.inputMBPerSecond = inputRate.Update(now, m_Progress.inputBytes / 1048576.0);
+        m_Progress.outputMBPerSecond = outputRate.Update(now, m_Progress.outputBytes / 1048576.0);
 
-    while (!m_StopMonitor) {
-        // 检查是否完成
-        size_t totalProcessed = m_Progress.completed + m_Progress.failed;
-        if (totalProcessed >= m_Progress.total) {
+        const size_t finished = m_Progress.GetFinished();
+        const size_t remaining = m_Progress.total > finished ? m_Progress.total - finished : 0;
+        m_Progress.etaSeconds = rate > 0.0 ? remaining / rate : (remaining == 0 ? 0.0 : -1.0);
+
+        // 所有任务都有结果：立即调用完成回调
+        if (remaining == 0) {
             m_Progress.running = false;
+            m_Progress.paused = false;
 
-            // 调用完成回调
             if (m_OnComplete) {
-                bool success = m_Progress.failed == 0;
+                bool success = m_Progress.failed == 0 && m_Progress.cancelled == 0;
                 m_OnComplete(success);
             }
-
-            break;
+            return;
         }
 
-        // 调用进度回调
         if (m_OnProgress) {
             m_OnProgress(m_Progress);
         }
 
-        std::this_thread::sleep_for(100ms);
+        // 等待下一个任务结束，不轮询
+        std::unique_lock<std::mutex> lock(m_EventMutex);
+        m_EventSignal.wait(lock, [&] { return m_StopMonitor || m_EventCount != seen; });
+        if (m_StopMonitor) {
+            return;
+        }
+        seen = m_EventCount;
+    }
+}
+
+void BatchProcessor::NotifyProgress() {
+    {
+        std::lock_guard<std::mutex> lock(m_EventMutex);
+        ++m_EventCount;
+    }
+    m_EventSignal.notify_one();
+}
+
+void BatchProcessor::StopMonitor() {
+    {
+        std::lock_guard<std::mutex> lock(m_EventMutex);
+        m_StopMonitor = true;
+    }
+    m_EventSignal.notify_one();
+    if (m_MonitorThread.joinable()) {
+        m_MonitorThread.join();
     }
 }
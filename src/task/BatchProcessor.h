@@ -1,11 +1,16 @@
 #pragma once
 
-#include "ThreadPool.h"
+#include "AsyncFileWriter.h"
 #include "core/Types.h"
 #include <string>
 #include <vector>
 #include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 /**
  * @brief 批量处理任务
@@ -21,16 +26,62 @@ struct BatchTask {
 
 /**
  * @brief 批量处理进度
+ *
+ * 计数和累计量由流水线线程更新；速率和剩余时间由监控线程在每个任务结束时重新计算。
  */
 struct BatchProgress {
     size_t total = 0;
     std::atomic<size_t> completed{0};
     std::atomic<size_t> failed{0};
+    std::atomic<size_t> cancelled{0};  // 取消后未执行或中途放弃的任务
     std::atomic<bool> running{false};
+    std::atomic<bool> paused{false};
+
+    // 累计字节数：输入在读取阶段计入，输出在文件写完后计入
+    std::atomic<uint64_t> inputBytes{0};
+    std::atomic<uint64_t> outputBytes{0};
+
+    // 各阶段累计耗时（微秒，多个线程的时间相加）；流式处理的图片整段计入处理
+    std::atomic<uint64_t> decodeMicros{0};
+    std::atomic<uint64_t> processMicros{0};
+    std::atomic<uint64_t> encodeMicros{0};
+    std::atomic<uint64_t> writeMicros{0};
+
+    // 指数加权平均的速率和据此估计的剩余时间（尚无估计时 etaSeconds 为负）
+    std::atomic<double> imagesPerSecond{0.0};
+    std::atomic<double> inputMBPerSecond{0.0};
+    std::atomic<double> outputMBPerSecond{0.0};
+    std::atomic<double> etaSeconds{-1.0};
 
     float GetProgress() const {
         return total > 0 ? static_cast<float>(completed) / total : 0.0f;
     }
+
+    /**
+     * @brief 已有结果的任务数（成功、失败或取消）
+     */
+    size_t GetFinished() const {
+        return completed + failed + cancelled;
+    }
+
+    /**
+     * @brief 清零所有计数和统计，开始新的批次
+     */
+    void Reset(size_t taskCount);
+};
+
+/**
+ * @brief 批量处理流水线的各阶段并发数和队列容量
+ *
+ * 线程数为 0 时使用硬件并发数。相邻阶段之间的队列有界，
+ * 同时在内存中的图片数不超过各阶段线程数与队列容量之和，与批次大小无关。
+ */
+struct BatchPipelineOptions {
+    size_t readThreads = 2;     // 读取：探测尺寸、把文件内容读入内存（I/O）
+    size_t decodeThreads = 0;   // 解码
+    size_t processThreads = 0;  // 裁剪、缩放、旋转、合成
+    size_t encodeThreads = 0;   // 编码（结果交给 AsyncFileWriter 落盘）
+    size_t queueCapacity = 2;   // 相邻两个阶段之间最多排队的图片数
 };
 
 /**
@@ -38,7 +89,12 @@ struct BatchProgress {
  * 
  * 职责：
  * - 管理批量处理任务
- * - 进度跟踪
+ * - 分阶段流水线：读取 → 解码 → 处理 → 编码 → 写入，各阶段独立的线程和有界队列，
+ *   I/O 与计算重叠，内存占用有上限
+ * - 写盘交给 AsyncFileWriter（慢速磁盘不会占住计算线程）
+ * - 进度跟踪（成功和失败都在最后一级计数）；监控线程在每个任务结束时被唤醒，
+ *   更新吞吐量和剩余时间，所有任务结束后立即调用完成回调
+ * - 取消、暂停和恢复：各阶段在任务之间检查取消令牌，长时间运行的内核在块或行之间检查
  * - 错误处理
  */
 class BatchProcessor {
@@ -46,21 +102,45 @@ public:
     using ProgressCallback = std::function<void(const BatchProgress&)>;
     using CompletionCallback = std::function<void(bool success)>;
 
-    BatchProcessor();
+    /**
+     * @brief 构造函数
+     * @param options 流水线各阶段的并发数和队列容量
+     */
+    explicit BatchProcessor(const BatchPipelineOptions& options = BatchPipelineOptions());
     ~BatchProcessor();
 
     /**
      * @brief 开始批量处理
-     * @param tasks 任务列表
+     * @param tasks 任务列表（移入处理器；预处理图像与预览缓存共享像素，不复制）
      * @param onProgress 进度回调
      * @param onComplete 完成回调
      */
-    void Start(const std::vector<BatchTask>& tasks,
+    void Start(std::vector<BatchTask> tasks,
                ProgressCallback onProgress = nullptr,
                CompletionCallback onComplete = nullptr);
 
     /**
-     * @brief 停止批量处理
+     * @brief 取消批量处理（不阻塞）
+     * @return 被放弃的尚未开始的任务数（立即计入 progress.cancelled）
+     *
+     * 之后不再领取新任务；流水线中的任务在下一个检查点放弃，同样计入 cancelled。
+     * 已经编码完成、交给写入器的文件仍会写完，不会留下不完整的文件。
+     * 所有任务都有结果后完成回调以 success = false 调用。
+     */
+    size_t Cancel();
+
+    /**
+     * @brief 暂停：各阶段线程在下一个检查点停住，队列中的任务保留
+     */
+    void Pause();
+
+    /**
+     * @brief 从暂停处继续
+     */
+    void Resume();
+
+    /**
+     * @brief 停止批量处理：取消并等待流水线线程退出（阻塞，不调用完成回调）
      */
     void Stop();
 
@@ -74,24 +154,64 @@ public:
      */
     bool IsRunning() const { return m_Progress.running; }
 
+    /**
+     * @brief 是否处于暂停状态
+     */
+    bool IsPaused() const { return m_Progress.paused; }
+
 private:
+    struct Job;
+    struct Pipeline;
+
+    /**
+     * @brief 读取阶段：决定加载方式，把文件内容读入内存（超大图片不读取，由解码阶段流式处理）
+     */
+    void ReadJob(Job& job);
+
+    /**
+     * @brief 解码阶段（流式处理的图片在这里一次完成解码、处理和编码）
+     */
+    void DecodeJob(Job& job);
+
+    /**
+     * @brief 处理阶段：裁剪、缩放、旋转并合成到画布
+     */
+    void ProcessJob(Job& job);
+
     /**
-     * @brief 处理单个任务
+     * @brief 编码阶段，也是最后一级：编码结果交给写入器，失败的任务在这里计数
      */
-    bool ProcessTask(const BatchTask& task);
+    void EncodeJob(Job& job);
 
     /**
-     * @brief 监控线程
+     * @brief 监控线程：等待进度事件，更新速率，调用进度和完成回调
      */
     void MonitorThread();
 
+    /**
+     * @brief 通知监控线程有任务结束（计数更新之后调用）
+     */
+    void NotifyProgress();
+
+    /**
+     * @brief 停止并等待监控线程（不调用完成回调）
+     */
+    void StopMonitor();
+
 private:
-    ThreadPool m_ThreadPool;
+    // 析构顺序：先等流水线线程结束，再写完剩余文件，最后才销毁它们回调中用到的进度和事件通知
     BatchProgress m_Progress;
+    std::mutex m_EventMutex;
+    std::condition_variable m_EventSignal;
+    uint64_t m_EventCount = 0;   // 进度事件序号（受 m_EventMutex 保护）
+    bool m_StopMonitor = false;  // 受 m_EventMutex 保护
+    uint64_t m_WriteBusyAtStart = 0;  // 批次开始时写入器的累计工作时间
+    AsyncFileWriter m_FileWriter;
+    BatchPipelineOptions m_Options;
+    std::unique_ptr<Pipeline> m_Pipeline;
     
     ProgressCallback m_OnProgress;
     CompletionCallback m_OnComplete;
     
     std::thread m_MonitorThread;
-    std::atomic<bool> m_StopMonitor{false};
 };
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/**
+ * @brief 有界阻塞队列（多生产者、多消费者）
+ *
+ * 职责：
+ * - 队列满时 Push() 阻塞：下游处理不过来时上游自然减速，队列中的数据量不超过容量
+ * - 队列空时 Pop() 阻塞，直到有新元素或队列关闭
+ * - Close() 之后不再接受新元素，已有的元素仍可全部取出
+ */
+template<typename T>
+class BoundedQueue {
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 容量（至少为 1）
+     */
+    explicit BoundedQueue(size_t capacity)
+        : m_Capacity(capacity > 0 ? capacity : 1) {}
+
+    // 禁止拷贝
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief 放入元素（队列满时阻塞）
+     * @return 队列已关闭时返回 false，元素被丢弃
+     */
+    bool Push(T item) {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_NotFull.wait(lock, [this] { return m_Closed || m_Items.size() < m_Capacity; });
+            if (m_Closed) {
+                return false;
+            }
+            m_Items.push_back(std::move(item));
+        }
+        m_NotEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief 取出元素（队列空时阻塞）
+     * @return 队列已关闭且已取空时返回 false
+     */
+    bool Pop(T& item) {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_NotEmpty.wait(lock, [this] { return m_Closed || !m_Items.empty(); });
+            if (m_Items.empty()) {
+                return false;
+            }
+            item = std::move(m_Items.front());
+            m_Items.pop_front();
+        }
+        m_NotFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief 关闭队列，唤醒所有等待的线程
+     */
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Closed = true;
+        }
+        m_NotFull.notify_all();
+        m_NotEmpty.notify_all();
+    }
+
+    /**
+     * @brief 当前元素数量
+     */
+    size_t Size() const {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Items.size();
+    }
+
+    size_t GetCapacity() const { return m_Capacity; }
+
+private:
+    const size_t m_Capacity;
+    std::deque<T> m_Items;
+    bool m_Closed = false;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_NotFull;
+    std::condition_variable m_NotEmpty;
+};
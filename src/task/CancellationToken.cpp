@@ -0,0 +1,54 @@
+#include "CancellationToken.h"
+
+namespace {
+
+thread_local const CancellationToken* t_Token = nullptr;
+
+} // namespace
+
+void CancellationToken::Cancel() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Cancelled.store(true, std::memory_order_release);
+    }
+    m_Resumed.notify_all();
+}
+
+void CancellationToken::Pause() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Paused.store(true, std::memory_order_release);
+}
+
+void CancellationToken::Resume() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Paused.store(false, std::memory_order_release);
+    }
+    m_Resumed.notify_all();
+}
+
+bool CancellationToken::WaitWhilePaused() const {
+    // 未暂停时不加锁，检查点的开销只有两次原子读
+    if (IsPaused() && !IsCancelled()) {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Resumed.wait(lock, [this] { return !IsPaused() || IsCancelled(); });
+    }
+    return !IsCancelled();
+}
+
+const CancellationToken* CancellationToken::Current() {
+    return t_Token;
+}
+
+bool CancellationToken::Checkpoint() {
+    return !t_Token || t_Token->WaitWhilePaused();
+}
+
+CancellationToken::ScopedToken::ScopedToken(const CancellationToken* token)
+    : m_Previous(t_Token) {
+    t_Token = token;
+}
+
+CancellationToken::ScopedToken::~ScopedToken() {
+    t_Token = m_Previous;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+/**
+ * @brief 取消/暂停令牌
+ *
+ * 职责：
+ * - 由控制方（界面线程）调用 Cancel() / Pause() / Resume()
+ * - 执行方在任务之间以及长时间运行的内核中检查：暂停时原地等待，取消后尽快放弃
+ * - 当前线程可以绑定一个令牌（ScopedToken），内核通过 Checkpoint() 检查，
+ *   不需要逐层传递参数；ThreadPool::ParallelFor 会把调用线程的令牌带到辅助任务中
+ *
+ * 注意：取消不可撤销；一个令牌只用于一次批处理
+ */
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    // 禁止拷贝
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    /**
+     * @brief 请求取消（同时唤醒所有处于暂停等待中的线程）
+     */
+    void Cancel();
+
+    bool IsCancelled() const { return m_Cancelled.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 暂停：执行方在下一个检查点停住，已排队的工作保持不变
+     */
+    void Pause();
+
+    /**
+     * @brief 恢复执行
+     */
+    void Resume();
+
+    bool IsPaused() const { return m_Paused.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 暂停期间阻塞，直到恢复或取消
+     * @return 已取消时返回 false
+     */
+    bool WaitWhilePaused() const;
+
+    /**
+     * @brief 当前线程绑定的令牌（没有时为空）
+     */
+    static const CancellationToken* Current();
+
+    /**
+     * @brief 当前线程的检查点：令牌暂停时阻塞，已取消时返回 false（没有令牌时总是返回 true）
+     */
+    static bool Checkpoint();
+
+    /**
+     * @brief 在作用域内把令牌绑定到当前线程
+     */
+    class ScopedToken {
+    public:
+        explicit ScopedToken(const CancellationToken* token);
+        ~ScopedToken();
+
+        ScopedToken(const ScopedToken&) = delete;
+        ScopedToken& operator=(const ScopedToken&) = delete;
+
+    private:
+        const CancellationToken* m_Previous;
+    };
+
+private:
+    std::atomic<bool> m_Cancelled{false};
+    std::atomic<bool> m_Paused{false};
+
+    mutable std::mutex m_Mutex;
+    mutable std::condition_variable m_Resumed;
+};
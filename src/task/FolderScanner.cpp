@@ -0,0 +1,235 @@
+#include "FolderScanner.h"
+#include "core/ImageLoader.h"
+#include "utils/Logger.h"
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 每个读取任务包含的文件数（单个文件只读几 KB，太小的任务调度开销占比过高）
+constexpr size_t kChunkSize = 16;
+
+// 超过该大小的文件不加入列表
+constexpr size_t kMaxFileSize = 2147483648ULL;
+
+/**
+ * @brief 离开作用域时标记块已完成（包括异常退出），否则 Poll() 会一直等在这个块上
+ */
+class DoneGuard {
+public:
+    explicit DoneGuard(std::atomic<bool>& done) : m_Done(done) {}
+    ~DoneGuard() { m_Done.store(true, std::memory_order_release); }
+
+    DoneGuard(const DoneGuard&) = delete;
+    DoneGuard& operator=(const DoneGuard&) = delete;
+
+private:
+    std::atomic<bool>& m_Done;
+};
+
+} // namespace
+
+FolderScanner::FolderScanner() = default;
+
+FolderScanner::~FolderScanner() {
+    Cancel();
+}
+
+bool FolderScanner::Start(const std::vector<std::string>& folderPaths, bool recursive) {
+    if (m_Running) {
+        Logger::Warning("Folder scan already running");
+        return false;
+    }
+    if (m_ScanThread.joinable()) {
+        m_ScanThread.join();
+    }
+
+    std::vector<std::string> roots;
+    for (const auto& path : folderPaths) {
+        std::error_code ec;
+        if (!path.empty() && fs::is_directory(path, ec) && !ec) {
+            roots.push_back(path);
+        } else {
+            Logger::Error("Not a directory: " + path + (ec ? " - " + ec.message() : ""));
+        }
+    }
+    if (roots.empty()) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Chunks.clear();
+    }
+    m_Cancel = false;
+    m_FoundCount = 0;
+    m_ProbedCount = 0;
+    m_Running = true;
+    m_ScanThread = std::thread(&FolderScanner::ScanThread, this, std::move(roots), recursive);
+    return true;
+}
+
+void FolderScanner::Cancel() {
+    m_Cancel = true;
+    if (m_ScanThread.joinable()) {
+        m_ScanThread.join();
+    }
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Chunks.clear();
+}
+
+bool FolderScanner::Poll(std::vector<ImageInfo>& outInfos) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    const size_t before = outInfos.size();
+    // 只取出连续已完成的块，后面的块先完成也要等前面的块，保证顺序
+    while (!m_Chunks.empty() && m_Chunks.front()->done.load(std::memory_order_acquire)) {
+        auto& infos = m_Chunks.front()->infos;
+        outInfos.insert(outInfos.end(), std::make_move_iterator(infos.begin()),
+                        std::make_move_iterator(infos.end()));
+        m_Chunks.pop_front();
+    }
+    return outInfos.size() > before;
+}
+
+void FolderScanner::ScanThread(std::vector<std::string> folderPaths, bool recursive) {
+    std::vector<std::future<void>> pending;
+    for (const auto& root : folderPaths) {
+        if (m_Cancel) {
+            break;
+        }
+        ScanFolder(root, recursive, pending);
+    }
+
+    // 等待所有读取任务完成后才标记结束，此后 Poll() 能取回全部结果
+    for (auto& future : pending) {
+        future.wait();
+    }
+    ImageIndex::Shared().Flush();
+    m_Running = false;
+}
+
+void FolderScanner::ScanFolder(const std::string& rootPath, bool recursive,
+                               std::vector<std::future<void>>& pending) {
+    // 显式栈实现深度优先遍历，子文件夹逆序入栈以便按名称顺序出栈
+    std::vector<fs::path> folders{fs::path(rootPath)};
+    while (!folders.empty() && !m_Cancel) {
+        const fs::path folder = std::move(folders.back());
+        folders.pop_back();
+
+        std::vector<fs::path> files;
+        std::vector<FileStamp> stamps;
+        std::vector<fs::path> subFolders;
+        std::error_code ec;
+        fs::directory_iterator it(folder, fs::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+            if (m_Cancel) {
+                return;
+            }
+            // 单个条目出错（例如 Windows 上文件名无法转换为当前代码页）只跳过该条目
+            try {
+                const fs::directory_entry& entry = *it;
+                std::error_code entryEc;
+                if (entry.is_directory(entryEc)) {
+                    // 不跟随指向文件夹的符号链接，避免循环
+                    if (recursive && !entry.is_symlink(entryEc)) {
+                        subFolders.push_back(entry.path());
+                    }
+                } else if (!entryEc && ImageLoader::IsSupportedFormat(entry.path().string())) {
+                    // 大小和修改时间来自遍历（Windows 上无需再访问文件），用于查找索引
+                    FileStamp stamp;
+                    if (!FileStamp::Read(entry, stamp)) {
+                        stamp = FileStamp();
+                    }
+                    files.push_back(entry.path());
+                    stamps.push_back(stamp);
+                }
+            } catch (const std::exception& e) {
+                Logger::Warning("Skipping directory entry: " + std::string(e.what()));
+            }
+        }
+        try {
+            if (ec) {
+                Logger::Warning("Error iterating directory " + folder.string() + ": " + ec.message());
+            } else {
+                // 完整遍历过的文件夹：索引中已不存在的文件一并清理
+                std::vector<std::string> names;
+                names.reserve(files.size());
+                for (const auto& file : files) {
+                    names.push_back(file.filename().string());
+                }
+                ImageIndex::Shared().Retain(folder.string(), names);
+            }
+        } catch (const std::exception& e) {
+            // 文件夹路径本身无法转换时不清理索引，文件照常读取
+            Logger::Warning("Skipping index cleanup: " + std::string(e.what()));
+        }
+
+        std::vector<size_t> order(files.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(),
+                  [&files](size_t a, size_t b) { return files[a] < files[b]; });
+        m_FoundCount += files.size();
+        for (size_t begin = 0; begin < order.size(); begin += kChunkSize) {
+            const size_t end = std::min(order.size(), begin + kChunkSize);
+            std::vector<std::string> paths;
+            std::vector<FileStamp> chunkStamps;
+            paths.reserve(end - begin);
+            chunkStamps.reserve(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                paths.push_back(files[order[i]].string());
+                chunkStamps.push_back(stamps[order[i]]);
+            }
+            SubmitChunk(std::move(paths), std::move(chunkStamps), pending);
+        }
+
+        std::sort(subFolders.begin(), subFolders.end());
+        folders.insert(folders.end(), std::make_move_iterator(subFolders.rbegin()),
+                       std::make_move_iterator(subFolders.rend()));
+    }
+}
+
+void FolderScanner::SubmitChunk(std::vector<std::string> paths, std::vector<FileStamp> stamps,
+                                std::vector<std::future<void>>& pending) {
+    auto chunk = std::make_shared<Chunk>();
+    chunk->paths = std::move(paths);
+    chunk->stamps = std::move(stamps);
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Chunks.push_back(chunk);
+    }
+    pending.push_back(m_ThreadPool.Submit([this, chunk]() { ProbeChunk(*chunk); }));
+}
+
+void FolderScanner::ProbeChunk(Chunk& chunk) {
+    DoneGuard guard(chunk.done);
+    ImageIndex& index = ImageIndex::Shared();
+    for (size_t i = 0; i < chunk.paths.size(); ++i) {
+        if (m_Cancel) {
+            break;
+        }
+        const std::string& path = chunk.paths[i];
+        const FileStamp& stamp = chunk.stamps[i];
+        const bool hasStamp = stamp.size > 0;
+
+        try {
+            ImageInfo info;
+            bool ok = hasStamp && index.LookupInfo(path, stamp, info);
+            if (!ok) {
+                ok = ImageLoader::GetInfo(path, info);
+                if (ok && hasStamp) {
+                    index.StoreInfo(info, stamp);
+                }
+            }
+            if (ok && info.fileSize <= kMaxFileSize) {
+                chunk.infos.push_back(std::move(info));
+            }
+        } catch (const std::exception& e) {
+            Logger::Warning("Skipping " + path + ": " + e.what());
+        }
+        m_ProbedCount++;
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "ThreadPool.h"
+#include "core/ImageIndex.h"
+#include "core/Types.h"
+#include <atomic>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 文件夹扫描器
+ *
+ * 职责：
+ * - 在后台线程中遍历文件夹（可选递归），按扩展名筛选图片
+ * - 把文件分块提交到线程池并发读取头部信息；大小和修改时间未变的文件直接使用 ImageIndex 中的记录
+ * - UI 线程每帧调用 Poll() 取回已完成的结果，列表逐步填充
+ * - 支持中途取消
+ *
+ * 结果顺序与完成顺序无关：每个文件夹内的文件按路径排序，先文件后子文件夹（深度优先），
+ * 多个根目录按传入顺序依次扫描。
+ */
+class FolderScanner {
+public:
+    FolderScanner();
+    ~FolderScanner();
+
+    FolderScanner(const FolderScanner&) = delete;
+    FolderScanner& operator=(const FolderScanner&) = delete;
+
+    /**
+     * @brief 开始扫描
+     * @param folderPaths 根文件夹列表（不存在或不是文件夹的路径会被跳过）
+     * @param recursive 是否扫描子文件夹
+     * @return 至少有一个有效文件夹且当前没有正在进行的扫描时返回 true
+     */
+    bool Start(const std::vector<std::string>& folderPaths, bool recursive = false);
+
+    /**
+     * @brief 取消扫描（等待后台线程退出，丢弃尚未取回的结果）
+     */
+    void Cancel();
+
+    /**
+     * @brief 取回已完成的结果（按确定的顺序追加到 outInfos）
+     * @return 有新结果时返回 true
+     *
+     * 注意：IsRunning() 变为 false 之后再调用一次即可取回全部剩余结果
+     */
+    bool Poll(std::vector<ImageInfo>& outInfos);
+
+    /**
+     * @brief 是否正在扫描
+     */
+    bool IsRunning() const { return m_Running; }
+
+    /**
+     * @brief 已找到的候选文件数（按扩展名）
+     */
+    size_t GetFoundCount() const { return m_FoundCount; }
+
+    /**
+     * @brief 已读取头部的文件数（包括失败的文件）
+     */
+    size_t GetProbedCount() const { return m_ProbedCount; }
+
+private:
+    /**
+     * @brief 一批待读取头部的文件
+     */
+    struct Chunk {
+        std::vector<std::string> paths;
+        std::vector<FileStamp> stamps;   // 与 paths 一一对应，size 为 0 时不使用索引
+        std::vector<ImageInfo> infos;    // 成功读取的文件，顺序与 paths 相同
+        std::atomic<bool> done{false};
+    };
+
+    /**
+     * @brief 扫描线程：遍历文件夹并提交读取任务，最后等待所有任务完成
+     */
+    void ScanThread(std::vector<std::string> folderPaths, bool recursive);
+
+    /**
+     * @brief 遍历一个根文件夹
+     */
+    void ScanFolder(const std::string& rootPath, bool recursive,
+                    std::vector<std::future<void>>& pending);
+
+    /**
+     * @brief 提交一批文件到线程池
+     */
+    void SubmitChunk(std::vector<std::string> paths, std::vector<FileStamp> stamps,
+                     std::vector<std::future<void>>& pending);
+
+    /**
+     * @brief 读取一批文件的头部信息（线程池中执行）
+     */
+    void ProbeChunk(Chunk& chunk);
+
+private:
+    ThreadPool m_ThreadPool;
+    std::thread m_ScanThread;
+
+    std::mutex m_Mutex;
+    std::deque<std::shared_ptr<Chunk>> m_Chunks;  // 按提交顺序排列，Poll() 从头部取出
+
+    std::atomic<bool> m_Running{false};
+    std::atomic<bool> m_Cancel{false};
+    std::atomic<size_t> m_FoundCount{0};
+    std::atomic<size_t> m_ProbedCount{0};
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief 只可移动的 void() 可调用对象（线程池的任务类型）
+ *
+ * 与 std::function<void()> 相比：
+ * - 不要求可复制，可以直接持有 std::packaged_task 等只可移动的对象
+ * - 不超过 kInlineBytes 的可调用对象存放在内部缓冲区，提交任务时不分配堆内存；
+ *   更大的对象退回堆上分配
+ */
+class InlineTask {
+public:
+    static constexpr size_t kInlineBytes = 48;
+
+    InlineTask() noexcept = default;
+
+    template<typename Func,
+             typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, InlineTask>>>
+    InlineTask(Func&& func) {
+        using Callable = std::decay_t<Func>;
+        if constexpr (IsInline<Callable>()) {
+            ::new (static_cast<void*>(m_Storage)) Callable(std::forward<Func>(func));
+        } else {
+            ::new (static_cast<void*>(m_Storage)) Callable*(new Callable(std::forward<Func>(func)));
+        }
+        m_Ops = &OpsFor<Callable>::kOps;
+    }
+
+    InlineTask(InlineTask&& other) noexcept {
+        MoveFrom(other);
+    }
+
+    InlineTask& operator=(InlineTask&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    ~InlineTask() {
+        Reset();
+    }
+
+    InlineTask(const InlineTask&) = delete;
+    InlineTask& operator=(const InlineTask&) = delete;
+
+    explicit operator bool() const { return m_Ops != nullptr; }
+
+    /**
+     * @brief 执行任务（必须非空）
+     */
+    void operator()() {
+        m_Ops->invoke(m_Storage);
+    }
+
+    /**
+     * @brief 销毁持有的可调用对象
+     */
+    void Reset() {
+        if (m_Ops) {
+            m_Ops->destroy(m_Storage);
+            m_Ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* dst, void* src);  // 移动到 dst 并销毁 src
+        void (*destroy)(void* storage);
+    };
+
+    template<typename Callable>
+    static constexpr bool IsInline() {
+        return sizeof(Callable) <= kInlineBytes &&
+               alignof(Callable) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Callable>;
+    }
+
+    template<typename Callable, bool Inline = IsInline<Callable>()>
+    struct OpsFor;
+
+    // 内联存放：缓冲区中就是对象本身
+    template<typename Callable>
+    struct OpsFor<Callable, true> {
+        static Callable* Get(void* storage) {
+            return std::launder(static_cast<Callable*>(storage));
+        }
+        static void Invoke(void* storage) { (*Get(storage))(); }
+        static void Move(void* dst, void* src) {
+            ::new (dst) Callable(std::move(*Get(src)));
+            Get(src)->~Callable();
+        }
+        static void Destroy(void* storage) { Get(storage)->~Callable(); }
+        static constexpr Ops kOps = {&Invoke, &Move, &Destroy};
+    };
+
+    // 堆上存放：缓冲区中只有指针
+    template<typename Callable>
+    struct OpsFor<Callable, false> {
+        static Callable*& Get(void* storage) {
+            return *std::launder(static_cast<Callable**>(storage));
+        }
+        static void Invoke(void* storage) { (*Get(storage))(); }
+        static void Move(void* dst, void* src) {
+            ::new (dst) Callable*(Get(src));
+        }
+        static void Destroy(void* storage) { delete Get(storage); }
+        static constexpr Ops kOps = {&Invoke, &Move, &Destroy};
+    };
+
+    void MoveFrom(InlineTask& other) noexcept {
+        if (other.m_Ops) {
+            other.m_Ops->move(m_Storage, other.m_Storage);
+            m_Ops = other.m_Ops;
+            other.m_Ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char m_Storage[kInlineBytes];
+    const Ops* m_Ops = nullptr;
+};
@@ -1,8 +1,190 @@
 #include "ThreadPool.h"
+#include "CancellationToken.h"
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
 
-ThreadPool::ThreadPool(size_t numThreads) {
+namespace {
+
+thread_local bool t_ParallelismEnabled = true;
+thread_local TaskPriority t_Priority = TaskPriority::Normal;
+
+// 当前线程所属的线程池及其在池中的序号（不是工作线程时为空）
+thread_local const ThreadPool* t_Pool = nullptr;
+thread_local size_t t_WorkerIndex = 0;
+
+/**
+ * @brief Chase-Lev 工作窃取双端队列（固定容量）
+ *
+ * 所属线程在底部 Push / Pop（后进先出），其它线程在顶部 Steal（先进先出）。
+ * 每个槽位记录下一次可以写入的下标：窃取者在 CAS 领取之后才把任务移出，
+ * 移出完成前所属线程不会覆盖该槽位；满了由调用方改用共享队列。
+ */
+class WorkStealingDeque {
+public:
+    static constexpr int64_t kCapacity = 256;
+
+    WorkStealingDeque() {
+        for (int64_t i = 0; i < kCapacity; ++i) {
+            m_Slots[i].turn.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 放入底部（只由所属线程调用）
+     * @return 已满时返回 false，task 保持不变
+     */
+    bool Push(InlineTask& task) {
+        const int64_t b = m_Bottom.load(std::memory_order_relaxed);
+        const int64_t t = m_Top.load(std::memory_order_acquire);
+        Slot& slot = m_Slots[b % kCapacity];
+        if (b - t >= kCapacity || slot.turn.load(std::memory_order_acquire) != b) {
+            return false;
+        }
+        slot.task = std::move(task);
+        m_Bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 从底部取出（只由所属线程调用）
+     */
+    bool Pop(InlineTask& task) {
+        const int64_t b = m_Bottom.load(std::memory_order_relaxed) - 1;
+        m_Bottom.store(b, std::memory_order_seq_cst);
+        int64_t t = m_Top.load(std::memory_order_seq_cst);
+        if (t > b) {
+            m_Bottom.store(b + 1, std::memory_order_release);
+            return false;
+        }
+
+        Slot& slot = m_Slots[b % kCapacity];
+        if (t < b) {
+            task = std::move(slot.task);
+            return true;
+        }
+
+        // 只剩最后一个，与窃取者竞争；领到后该下标不再复用
+        const bool won = m_Top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                       std::memory_order_relaxed);
+        if (won) {
+            task = std::move(slot.task);
+            slot.turn.store(b + kCapacity, std::memory_order_release);
+        }
+        m_Bottom.store(b + 1, std::memory_order_release);
+        return won;
+    }
+
+    /**
+     * @brief 是否为空（任意线程；所属线程 Pop 期间可能短暂不准确）
+     */
+    bool Empty() const {
+        return m_Top.load(std::memory_order_seq_cst) >= m_Bottom.load(std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief 从顶部窃取（任意线程）
+     */
+    bool Steal(InlineTask& task) {
+        int64_t t = m_Top.load(std::memory_order_seq_cst);
+        const int64_t b = m_Bottom.load(std::memory_order_seq_cst);
+        if (t >= b) {
+            return false;
+        }
+        if (!m_Top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {
+            return false;
+        }
+
+        Slot& slot = m_Slots[t % kCapacity];
+        task = std::move(slot.task);
+        slot.turn.store(t + kCapacity, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<int64_t> turn{0};
+        InlineTask task;
+    };
+
+    // 顶部和底部分别由窃取者和所属线程频繁修改，放在不同的缓存行
+    alignas(64) std::atomic<int64_t> m_Top{0};
+    alignas(64) std::atomic<int64_t> m_Bottom{0};
+    Slot m_Slots[kCapacity];
+};
+
+} // namespace
+
+struct ThreadPool::Worker {
+    WorkStealingDeque deques[kPriorityCount];
+    std::thread thread;
+};
+
+/**
+ * @brief 外部线程提交的任务（每条优先级通道一个环形缓冲，容量不足时翻倍，之后不再分配）
+ *
+ * Push / Pop 在 m_Mutex 内调用；Empty 可以不加锁，用于跳过空队列。
+ */
+class ThreadPool::SharedQueue {
+public:
+    void Push(TaskPriority priority, InlineTask task) {
+        Ring& ring = m_Rings[static_cast<size_t>(priority)];
+        if (ring.count == ring.items.size()) {
+            std::vector<InlineTask> grown(std::max<size_t>(64, ring.items.size() * 2));
+            for (size_t i = 0; i < ring.count; ++i) {
+                grown[i] = std::move(ring.items[(ring.head + i) % ring.items.size()]);
+            }
+            ring.items = std::move(grown);
+            ring.head = 0;
+        }
+        ring.items[(ring.head + ring.count) % ring.items.size()] = std::move(task);
+        ring.count.store(ring.count + 1, std::memory_order_relaxed);
+    }
+
+    bool Pop(TaskPriority priority, InlineTask& task) {
+        Ring& ring = m_Rings[static_cast<size_t>(priority)];
+        if (ring.count == 0) {
+            return false;
+        }
+        task = std::move(ring.items[ring.head]);
+        ring.head = (ring.head + 1) % ring.items.size();
+        ring.count.store(ring.count - 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool Empty(TaskPriority priority) const {
+        return m_Rings[static_cast<size_t>(priority)].count.load(std::memory_order_relaxed) == 0;
+    }
+
+    /**
+     * @brief 取出某条通道的全部任务，追加到 out
+     */
+    void Drain(TaskPriority priority, std::vector<InlineTask>& out) {
+        InlineTask task;
+        while (Pop(priority, task)) {
+            out.push_back(std::move(task));
+        }
+    }
+
+private:
+    struct Ring {
+        std::vector<InlineTask> items;
+        size_t head = 0;
+        std::atomic<size_t> count{0};
+    };
+    Ring m_Rings[kPriorityCount];
+};
+
+ThreadPool::ThreadPool(size_t numThreads)
+    : m_SharedQueue(std::make_unique<SharedQueue>()) {
+    // 先建好所有队列，工作线程启动后即可互相窃取
+    for (size_t i = 0; i < numThreads; ++i) {
+        m_Workers.push_back(std::make_unique<Worker>());
+    }
     for (size_t i = 0; i < numThreads; ++i) {
-        m_Threads.emplace_back(&ThreadPool::WorkerThread, this);
+        m_Workers[i]->thread = std::thread(&ThreadPool::WorkerThread, this, i);
     }
 }
 
@@ -14,36 +196,261 @@ ThreadPool::~ThreadPool() {
 
     m_Condition.notify_all();
 
-    for (auto& thread : m_Threads) {
-        if (thread.joinable()) {
-            thread.join();
+    for (auto& worker : m_Workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
         }
     }
 }
 
-void ThreadPool::WorkerThread() {
-    while (true) {
-        std::function<void()> task;
+void ThreadPool::Post(TaskPriority priority, InlineTask task) {
+    if (m_Stop) {
+        throw std::runtime_error("Cannot submit task to stopped ThreadPool");
+    }
+
+    // 先计数再放入：取走任务的线程总能看到计数，计数不会变成负数
+    m_Queued.fetch_add(1);
+
+    const bool local = t_Pool == this && !m_Workers.empty();
+    if (!local ||
+        !m_Workers[t_WorkerIndex]->deques[static_cast<size_t>(priority)].Push(task)) {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_SharedQueue->Push(priority, std::move(task));
+    }
+
+    // 有线程在等待时才需要加锁唤醒（等待方在锁内先登记再检查计数，不会漏掉）
+    if (m_Sleeping.load() > 0) {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.notify_one();
+    }
+}
+
+bool ThreadPool::FindTask(size_t index, InlineTask& task, TaskPriority& priority) {
+    for (size_t lane = 0; lane < kPriorityCount; ++lane) {
+        priority = static_cast<TaskPriority>(lane);
+
+        if (m_Workers[index]->deques[lane].Pop(task)) {
+            return true;
+        }
 
-        {
+        if (!m_SharedQueue->Empty(priority)) {
             std::unique_lock<std::mutex> lock(m_Mutex);
-            m_Condition.wait(lock, [this] {
-                return m_Stop || !m_Tasks.empty();
-            });
+            if (m_SharedQueue->Pop(priority, task)) {
+                return true;
+            }
+        }
 
-            if (m_Stop && m_Tasks.empty()) {
-                return;
+        // 从下一个线程开始依次尝试，避免所有空闲线程都去窃取同一个线程
+        for (size_t i = 1; i < m_Workers.size(); ++i) {
+            const size_t victim = (index + i) % m_Workers.size();
+            if (m_Workers[victim]->deques[lane].Steal(task)) {
+                return true;
             }
+        }
+    }
+    return false;
+}
 
-            task = std::move(m_Tasks.front());
-            m_Tasks.pop();
+void ThreadPool::WorkerThread(size_t index) {
+    t_Pool = this;
+    t_WorkerIndex = index;
+
+    InlineTask task;
+    TaskPriority priority = TaskPriority::Normal;
+    while (true) {
+        // 暂停时不取新任务；停止时即使处于暂停也要把剩余任务执行完
+        const bool held = m_Paused && !m_Stop;
+        if (!held && FindTask(index, task, priority)) {
+            m_Queued.fetch_sub(1);
+
+            // 任务内部再提交的任务（如 ParallelFor 的辅助任务）继承它的优先级
+            t_Priority = priority;
+            task();
+            task.Reset();
+            t_Priority = TaskPriority::Normal;
+            continue;
         }
 
-        task();
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        if (m_Stop && m_Queued.load() <= 0) {
+            return;
+        }
+        m_Sleeping.fetch_add(1);
+        m_Condition.wait(lock, [this] {
+            return m_Stop || (!m_Paused && m_Queued.load() > 0);
+        });
+        m_Sleeping.fetch_sub(1);
     }
 }
 
 size_t ThreadPool::GetPendingTaskCount() const {
-    std::unique_lock<std::mutex> lock(m_Mutex);
-    return m_Tasks.size();
+    return static_cast<size_t>(std::max<long long>(0, m_Queued.load()));
+}
+
+void ThreadPool::Pause() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Paused = true;
+}
+
+void ThreadPool::Resume() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Paused = false;
+    }
+    m_Condition.notify_all();
+}
+
+size_t ThreadPool::PurgePending(TaskPriority priority) {
+    std::vector<InlineTask> purged;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_SharedQueue->Drain(priority, purged);
+    }
+
+    // 工作线程的队列按窃取者的方式从顶部取走，可以与所属线程并发进行
+    const size_t lane = static_cast<size_t>(priority);
+    for (auto& worker : m_Workers) {
+        WorkStealingDeque& deque = worker->deques[lane];
+        InlineTask task;
+        while (!deque.Empty()) {
+            if (deque.Steal(task)) {
+                purged.push_back(std::move(task));
+            }
+        }
+    }
+
+    m_Queued.fetch_sub(static_cast<long long>(purged.size()));
+
+    // 在锁外销毁任务（析构可能唤醒等待 future 的线程）
+    const size_t count = purged.size();
+    purged.clear();
+    return count;
+}
+
+void ThreadPool::ParallelFor(int begin, int end, int grain,
+                             const std::function<void(int, int)>& body) {
+    if (end <= begin) {
+        return;
+    }
+
+    // 块数：至少 grain 个一块，且不超过线程数的 4 倍（兼顾负载均衡与调度开销）
+    const int total = end - begin;
+    grain = std::max(1, grain);
+    const int maxBlocks = static_cast<int>(m_Workers.size() + 1) * 4;
+    int blocks = std::min((total + grain - 1) / grain, maxBlocks);
+
+    const int blockSize = (total + blocks - 1) / blocks;
+    blocks = (total + blockSize - 1) / blockSize;
+
+    const CancellationToken* token = CancellationToken::Current();
+    if (blocks <= 1 || m_Workers.empty() || !t_ParallelismEnabled) {
+        if (!token) {
+            body(begin, end);
+            return;
+        }
+
+        // 有取消令牌时同样分块串行执行，块之间响应暂停和取消
+        for (int blockBegin = begin; blockBegin < end && token->WaitWhilePaused();
+             blockBegin += blockSize) {
+            body(blockBegin, std::min(end, blockBegin + blockSize));
+        }
+        return;
+    }
+
+    // 共享状态由辅助任务持有，调用方返回后才开始执行的辅助任务也能安全退出
+    struct State {
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+
+    // 只有领取到块之后才会访问 body 和 token：调用方会等所有块完成，领到块时它们一定还有效；
+    // 没领到块的辅助任务可能在调用方返回、token 已析构之后才运行，因此不能先检查暂停
+    // 取消后领取到的块只计数、不执行；暂停时辅助线程做完手上的块就退出，不占住工作线程
+    auto runBlocks = [state, blocks, blockSize, begin, end, &body, token](bool helper) {
+        while (true) {
+            const int block = state->next.fetch_add(1);
+            if (block >= blocks) {
+                return;
+            }
+
+            const int blockBegin = begin + block * blockSize;
+            const int blockEnd = std::min(end, blockBegin + blockSize);
+            const bool run = !token || (helper ? !token->IsCancelled() : token->WaitWhilePaused());
+            try {
+                if (run) {
+                    body(blockBegin, blockEnd);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) {
+                    state->error = std::current_exception();
+                }
+            }
+
+            // 必须在计入完成之前读取暂停状态，计入之后调用方可能已经返回
+            const bool yield = helper && token && token->IsPaused() && !token->IsCancelled();
+            if (state->done.fetch_add(1) + 1 == blocks) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+            if (yield) {
+                return;
+            }
+        }
+    };
+
+    // 辅助任务按当前线程的优先级提交；在工作线程上调用时进入本线程队列，由空闲线程窃取
+    const size_t helpers = std::min(m_Workers.size(), static_cast<size_t>(blocks - 1));
+    if (!m_Stop) {
+        for (size_t i = 0; i < helpers; ++i) {
+            Post(t_Priority, [runBlocks]() { runBlocks(true); });
+        }
+    }
+
+    // 调用线程同样领取块执行，然后等待其他线程手上的块完成
+    runBlocks(false);
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&] { return state->done.load() == blocks; });
+    }
+
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+ThreadPool& ThreadPool::Shared() {
+    // 调用线程也参与 ParallelFor，因此少开一个线程
+    static ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+TaskPriority ThreadPool::GetCurrentPriority() {
+    return t_Priority;
+}
+
+ThreadPool::ScopedPriority::ScopedPriority(TaskPriority priority)
+    : m_Previous(t_Priority) {
+    t_Priority = priority;
+}
+
+ThreadPool::ScopedPriority::~ScopedPriority() {
+    t_Priority = m_Previous;
+}
+
+bool ThreadPool::IsParallelismEnabled() {
+    return t_ParallelismEnabled;
+}
+
+ThreadPool::ScopedParallelism::ScopedParallelism(bool enabled)
+    : m_Previous(t_ParallelismEnabled) {
+    t_ParallelismEnabled = enabled;
+}
+
+ThreadPool::ScopedParallelism::~ScopedParallelism() {
+    t_ParallelismEnabled = m_Previous;
 }
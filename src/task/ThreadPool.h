@@ -1,21 +1,36 @@
 #pragma once
 
+#include "InlineTask.h"
 #include <vector>
-#include <queue>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <functional>
 #include <future>
 #include <atomic>
+#include <memory>
+#include <tuple>
 
 /**
- * @brief 线程池
+ * @brief 任务优先级（每个优先级一条独立的通道）
+ */
+enum class TaskPriority {
+    Interactive,  // 界面上的交互工作（预览等），先于批处理执行
+    Normal        // 批处理等后台工作
+};
+
+/**
+ * @brief 线程池（工作窃取调度）
  * 
  * 职责：
  * - 管理工作线程
- * - 任务队列调度
- * - 支持异步任务提交
+ * - 任务调度：每个工作线程每条优先级通道一个 Chase-Lev 双端队列，
+ *   本线程提交的任务后进先出，空闲线程从其它线程的队列头部先进先出地窃取；
+ *   外部线程提交的任务进入共享队列
+ * - 优先级通道：工作线程总是先找交互任务，再找普通任务
+ * - 支持异步任务提交（任务对象内联存放，提交时不为任务本身分配堆内存）
+ * - 区间并行（ParallelFor），用于单张大图内部的分块处理
+ * - 暂停/恢复（队列保持不变）和丢弃尚未开始的任务
  */
 class ThreadPool {
 public:
@@ -35,7 +50,7 @@ public:
     ThreadPool& operator=(const ThreadPool&) = delete;
 
     /**
-     * @brief 提交任务
+     * @brief 提交任务（普通优先级）
      * @param func 任务函数
      * @param args 参数
      * @return future 对象
@@ -44,52 +59,174 @@ public:
     auto Submit(Func&& func, Args&&... args) 
         -> std::future<typename std::invoke_result<Func, Args...>::type>;
 
+    /**
+     * @brief 按指定优先级提交任务
+     */
+    template<typename Func, typename... Args>
+    auto Submit(TaskPriority priority, Func&& func, Args&&... args)
+        -> std::future<typename std::invoke_result<Func, Args...>::type>;
+
+    /**
+     * @brief 提交不需要结果的任务（不创建 future，没有任何堆分配）
+     * @param priority 优先级
+     * @param task 任务
+     *
+     * 线程池已停止时抛出 std::runtime_error。
+     */
+    void Post(TaskPriority priority, InlineTask task);
+
+    /**
+     * @brief 并行执行区间 [begin, end)，调用线程也参与执行
+     * @param begin 区间起点
+     * @param end 区间终点（不含）
+     * @param grain 每块的最小长度
+     * @param body 块函数 body(blockBegin, blockEnd)，会在多个线程上同时调用
+     *
+     * 调用线程只等待已被领取的块执行完毕，从不等待仍在队列中的辅助任务，
+     * 因此在任意线程池（包括本池）的工作线程中嵌套调用都不会死锁。
+     * 块函数抛出的第一个异常会在调用线程重新抛出。
+     *
+     * 调用线程绑定了取消令牌（CancellationToken::ScopedToken）时，块之间检查令牌：
+     * 暂停时辅助线程不再领取新块，调用线程等待恢复；取消后剩余的块不再执行，
+     * 结果不完整，由调用方丢弃。
+     */
+    void ParallelFor(int begin, int end, int grain,
+                     const std::function<void(int, int)>& body);
+
+    /**
+     * @brief 进程内共享的线程池（单张图片内部的分块并行都提交到这里）
+     */
+    static ThreadPool& Shared();
+
+    /**
+     * @brief 当前线程是否允许 ParallelFor 拆分（不允许时在调用线程上串行执行）
+     */
+    static bool IsParallelismEnabled();
+
+    /**
+     * @brief 当前线程提交任务（包括 ParallelFor 的辅助任务）时使用的默认优先级
+     *
+     * 工作线程执行任务期间为该任务的优先级，其它线程默认为 Normal。
+     */
+    static TaskPriority GetCurrentPriority();
+
+    /**
+     * @brief 在作用域内设置当前线程的默认优先级（界面线程设为 Interactive）
+     */
+    class ScopedPriority {
+    public:
+        explicit ScopedPriority(TaskPriority priority);
+        ~ScopedPriority();
+
+        ScopedPriority(const ScopedPriority&) = delete;
+        ScopedPriority& operator=(const ScopedPriority&) = delete;
+
+    private:
+        TaskPriority m_Previous;
+    };
+
+    /**
+     * @brief 在作用域内开启/关闭当前线程的分块并行
+     *
+     * 批处理时图片数多于核心数，跨图片并行已经占满所有核心，再拆分只会增加调度开销。
+     */
+    class ScopedParallelism {
+    public:
+        explicit ScopedParallelism(bool enabled);
+        ~ScopedParallelism();
+
+        ScopedParallelism(const ScopedParallelism&) = delete;
+        ScopedParallelism& operator=(const ScopedParallelism&) = delete;
+
+    private:
+        bool m_Previous;
+    };
+
     /**
      * @brief 获取线程数量
      */
-    size_t GetThreadCount() const { return m_Threads.size(); }
+    size_t GetThreadCount() const { return m_Workers.size(); }
 
     /**
-     * @brief 获取待处理任务数量
+     * @brief 获取待处理任务数量（已提交、尚未开始执行）
      */
     size_t GetPendingTaskCount() const;
 
+    /**
+     * @brief 暂停：工作线程执行完手上的任务后停住，不再取新任务，已排队的任务保留
+     *
+     * 暂停期间 ParallelFor 的块全部由调用线程执行。
+     */
+    void Pause();
+
+    /**
+     * @brief 恢复执行
+     */
+    void Resume();
+
+    bool IsPaused() const { return m_Paused; }
+
+    /**
+     * @brief 丢弃某条优先级通道中尚未开始的任务
+     * @param priority 优先级通道
+     * @return 丢弃的任务数
+     *
+     * 正在执行的任务不受影响；被丢弃任务的 future 得到 std::future_error（broken_promise）。
+     * ParallelFor 的辅助任务可以安全丢弃（调用线程会自己执行剩余的块）。
+     * 整条通道的所有提交方都会受影响，不要在共享线程池上用它取消单个作业。
+     */
+    size_t PurgePending(TaskPriority priority);
+
 private:
+    struct Worker;
+    class SharedQueue;
+
+    static constexpr size_t kPriorityCount = 2;
+
     /**
      * @brief 工作线程函数
      */
-    void WorkerThread();
+    void WorkerThread(size_t index);
+
+    /**
+     * @brief 按优先级查找任务：本线程队列（后进先出）→ 共享队列 → 窃取其它线程（先进先出）
+     */
+    bool FindTask(size_t index, InlineTask& task, TaskPriority& priority);
 
 private:
-    std::vector<std::thread> m_Threads;
-    std::queue<std::function<void()>> m_Tasks;
-    
-    mutable std::mutex m_Mutex;
+    std::vector<std::unique_ptr<Worker>> m_Workers;
+    std::unique_ptr<SharedQueue> m_SharedQueue;
+
+    std::atomic<long long> m_Queued{0};   // 已提交、尚未被取走的任务数
+    std::atomic<size_t> m_Sleeping{0};    // 正在等待任务的线程数
+    mutable std::mutex m_Mutex;           // 保护共享队列和休眠/唤醒
     std::condition_variable m_Condition;
     std::atomic<bool> m_Stop{false};
+    std::atomic<bool> m_Paused{false};
 };
 
 // 模板实现
 template<typename Func, typename... Args>
 auto ThreadPool::Submit(Func&& func, Args&&... args)
     -> std::future<typename std::invoke_result<Func, Args...>::type> {
+    return Submit(GetCurrentPriority(), std::forward<Func>(func), std::forward<Args>(args)...);
+}
+
+template<typename Func, typename... Args>
+auto ThreadPool::Submit(TaskPriority priority, Func&& func, Args&&... args)
+    -> std::future<typename std::invoke_result<Func, Args...>::type> {
     
     using ReturnType = typename std::invoke_result<Func, Args...>::type;
 
-    auto task = std::make_shared<std::packaged_task<ReturnType()>>(
-        std::bind(std::forward<Func>(func), std::forward<Args>(args)...)
-    );
-
-    std::future<ReturnType> result = task->get_future();
-
-    {
-        std::unique_lock<std::mutex> lock(m_Mutex);
-        if (m_Stop) {
-            throw std::runtime_error("Cannot submit task to stopped ThreadPool");
-        }
-        m_Tasks.emplace([task]() { (*task)(); });
-    }
+    // packaged_task 只持有指向共享状态的指针，整个任务内联存放在 InlineTask 中；
+    // 唯一的堆分配是 future 的共享状态
+    std::packaged_task<ReturnType()> task(
+        [func = std::forward<Func>(func),
+         args = std::make_tuple(std::forward<Args>(args)...)]() mutable -> ReturnType {
+            return std::apply(std::move(func), std::move(args));
+        });
 
-    m_Condition.notify_one();
+    std::future<ReturnType> result = task.get_future();
+    Post(priority, [task = std::move(task)]() mutable { task(); });
     return result;
 }
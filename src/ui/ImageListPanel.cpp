@@ -1,5 +1,6 @@
 #include "ImageListPanel.h"
-#include "core/ImageLoader.h"
+#include "core/ImageIndex.h"
+#include "core/PixelKernels.h"
 #include <imgui.h>
 #include <sstream>
 #include <iomanip>
@@ -494,13 +495,25 @@ unsigned int ImageListPanel::GetThumbnailTexture(const std::string& filePath) {
         return it->second;
     }
     
-    // 加载图片
-    ImageData imageData;
-    if (!ImageLoader::Load(filePath, imageData) || !imageData.IsValid()) {
+    // 加载缩略图（优先使用磁盘索引中的缩略图，没有时解码原图生成）
+    ImageData thumbnail;
+    if (!ImageIndex::Shared().LoadThumbnail(filePath, thumbnail) || !thumbnail.IsValid()) {
+        m_ThumbnailCache[filePath] = 0;  // 失败的文件不再每帧重试
         return 0;
     }
+
+    // 统一转换为 RGBA（灰度图显示为灰色而不是红色）
+    std::vector<uint8_t> rgba(static_cast<size_t>(thumbnail.width) * thumbnail.height * 4);
+    DispatchChannels(thumbnail.channels, [&](auto channels) {
+        constexpr int C = decltype(channels)::value;
+        for (int y = 0; y < thumbnail.height; ++y) {
+            ConvertRowToRGBA<C, false>(rgba.data() + static_cast<size_t>(y) * thumbnail.width * 4,
+                                       thumbnail.pixels.data() + static_cast<size_t>(y) * thumbnail.width * C,
+                                       thumbnail.width);
+        }
+    });
     
-    // 创建缩略图纹理（76x76）
+    // 创建缩略图纹理
     unsigned int textureID = 0;
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_2D, textureID);
@@ -510,15 +523,8 @@ unsigned int ImageListPanel::GetThumbnailTexture(const std::string& filePath) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     
-    GLenum format = GL_RGB;
-    if (imageData.channels == 4) {
-        format = GL_RGBA;
-    } else if (imageData.channels == 1) {
-        format = GL_RED;
-    }
-    
-    glTexImage2D(GL_TEXTURE_2D, 0, format, imageData.width, imageData.height,
-                 0, format, GL_UNSIGNED_BYTE, imageData.pixels.data());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, thumbnail.width, thumbnail.height,
+                 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
     
     glBindTexture(GL_TEXTURE_2D, 0);
     
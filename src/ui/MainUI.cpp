@@ -5,12 +5,14 @@
 #include "SettingsPanel.h"
 #include "utils/FileDialog.h"
 #include "core/ImageLoader.h"
+#include "core/WebpWriter.h"
 #include "utils/Logger.h"
 
 #include <imgui.h>
 #include <imgui_internal.h>
 #include <cstdio>
 #include <iostream>
+#include <utility>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -24,6 +26,7 @@ MainUI::MainUI() {
     m_ControlPanel = std::make_unique<ControlPanel>();
     m_SettingsPanel = std::make_unique<SettingsPanel>();
     m_BatchProcessor = std::make_unique<BatchProcessor>();
+    m_FolderScanner = std::make_unique<FolderScanner>();
 
     // 设置默认画布参数为 750x1000，背景白色
     m_ProcessConfig.canvas = Canvas(750, 1000, Color::White());
@@ -134,6 +137,9 @@ void MainUI::Render() {
         }
     }
     
+    // 取回后台扫描到的图片（列表逐帧填充，不阻塞渲染）
+    UpdateFolderScan();
+
     RenderTopBar();
     SetupDockSpace();
 
@@ -166,8 +172,8 @@ void MainUI::Render() {
     // ControlPanel - 内联实现
     RenderControlPanel(m_ProcessConfig);
 
-    // 底部状态栏已移除
-    // RenderBottomStatusBar();
+    // 底部状态栏（批处理吞吐量、剩余时间和各阶段耗时）
+    RenderBottomStatusBar();
 
     // 关于对话框
     if (m_ShowAbout) {
@@ -259,10 +265,29 @@ void MainUI::RenderTopBar() {
     ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.0f, 0.0f, 0.0f, 0.0f));  // 透明背景
     ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.0f, 0.0f, 0.0f, 0.0f));
     ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.0f, 0.0f, 0.0f, 0.0f));
-    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.2f, 0.8f, 0.3f, 1.0f));
-    ImGui::SetWindowFontScale(1.2f);
-    ImGui::Button("● 就绪", ImVec2(80, 50));  // 使用按钮确保高度一致
-    ImGui::SetWindowFontScale(1.0f);
+    if (m_FolderScanActive) {
+        // 扫描中：显示进度，点击取消
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.26f, 0.59f, 0.98f, 1.0f));
+        ImGui::SetWindowFontScale(1.2f);
+        if (ImGui::Button("● 扫描中", ImVec2(80, 50))) {
+            m_FolderScanner->Cancel();
+            m_FolderScanActive = false;
+            std::string message = "已取消扫描\n已添加 " + std::to_string(m_ScanAddedCount) + " 张图片";
+            Logger::Info(message);
+            ShowSuccess(message);
+        }
+        ImGui::SetWindowFontScale(1.0f);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("已读取 %d / %d 个文件，点击取消",
+                              static_cast<int>(m_FolderScanner->GetProbedCount()),
+                              static_cast<int>(m_FolderScanner->GetFoundCount()));
+        }
+    } else {
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.2f, 0.8f, 0.3f, 1.0f));
+        ImGui::SetWindowFontScale(1.2f);
+        ImGui::Button("● 就绪", ImVec2(80, 50));  // 使用按钮确保高度一致
+        ImGui::SetWindowFontScale(1.0f);
+    }
     ImGui::PopStyleColor(4);
     
     // 全局设置按钮
@@ -295,6 +320,37 @@ void MainUI::RenderTopBar() {
     
     ImGui::PopStyleColor(3);
 
+    // 批处理进行中：暂停/继续、取消
+    if (m_BatchProcessor->IsRunning()) {
+        ImGui::SameLine();
+        ImGui::SetCursorPosY(buttonY);
+        const bool paused = m_BatchProcessor->IsPaused();
+        if (ImGui::Button(paused ? "继续" : "暂停", ImVec2(80, 50))) {
+            if (paused) {
+                m_BatchProcessor->Resume();
+            } else {
+                m_BatchProcessor->Pause();
+            }
+        }
+
+        ImGui::SameLine();
+        ImGui::SetCursorPosY(buttonY);
+        ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.6f, 0.2f, 0.2f, 1.0f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.7f, 0.25f, 0.25f, 1.0f));
+        if (ImGui::Button("取消", ImVec2(80, 50))) {
+            // 立即告知被放弃的任务数；流水线中的任务在下一个检查点放弃
+            const size_t abandoned = m_BatchProcessor->Cancel();
+            Logger::Info("Batch cancelled, abandoned tasks: " + std::to_string(abandoned));
+            ShowSuccess("已取消批处理，放弃 " + std::to_string(abandoned) + " 个未开始的任务");
+        }
+        ImGui::PopStyleColor(2);
+
+        const BatchProgress& progress = m_BatchProcessor->GetProgress();
+        ImGui::SameLine();
+        ImGui::SetCursorPosY(buttonY + 16.0f);
+        ImGui::Text("%zu / %zu%s", progress.GetFinished(), progress.total, paused ? "（已暂停）" : "");
+    }
+
     ImGui::End();
     ImGui::PopStyleColor();
     ImGui::PopStyleVar(2);
@@ -305,7 +361,7 @@ void MainUI::SetupDockSpace() {
     
     // 计算工作区域
     const float topBarHeight = 120.0f;
-    const float statusBarHeight = 0.0f;  // 状态栏已移除，设置为 0
+    const float statusBarHeight = 28.0f;
     const float toolbarWidth = 80.0f;  // 从 60 更新到 80
     
     // DockSpace 从工具栏右侧开始
@@ -377,10 +433,28 @@ void MainUI::RenderBottomStatusBar() {
     // 左侧：已选中数量
     ImGui::SetWindowFontScale(1.1f);  // 状态栏字体放大
     ImGui::TextDisabled("已选中 %d 张", static_cast<int>(m_ImageList.size()));
-    
-    // 右侧：耗时
-    ImGui::SameLine(viewport->WorkSize.x - 160);
-    ImGui::TextDisabled("耗时: 2s • 0.7s");
+
+    // 批处理统计（监控线程在每个任务结束时更新，这里只读取）
+    const BatchProgress& progress = m_BatchProcessor->GetProgress();
+    if (progress.total > 0) {
+        char eta[32] = "--:--";
+        const double etaSeconds = progress.etaSeconds;
+        if (etaSeconds >= 0.0) {
+            const int seconds = static_cast<int>(etaSeconds + 0.5);
+            std::snprintf(eta, sizeof(eta), "%02d:%02d", seconds / 60, seconds % 60);
+        }
+
+        ImGui::SameLine(0, 32);
+        ImGui::TextDisabled("%zu / %zu  •  %.1f 张/秒  •  读 %.1f MB/s  •  写 %.1f MB/s  •  剩余 %s",
+                            progress.GetFinished(), progress.total, progress.imagesPerSecond.load(),
+                            progress.inputMBPerSecond.load(), progress.outputMBPerSecond.load(), eta);
+
+        // 右侧：各阶段累计耗时（多线程时间之和）
+        ImGui::SameLine(viewport->WorkSize.x - 420);
+        ImGui::TextDisabled("解码 %.1fs • 处理 %.1fs • 编码 %.1fs • 写入 %.1fs",
+                            progress.decodeMicros / 1e6, progress.processMicros / 1e6,
+                            progress.encodeMicros / 1e6, progress.writeMicros / 1e6);
+    }
     ImGui::SetWindowFontScale(1.0f);
 
     ImGui::End();
@@ -395,7 +469,7 @@ void MainUI::RenderToolbar() {
     const float toolbarWidth = 80.0f;  // 从 60 增加到 80
     
     ImVec2 pos = ImVec2(viewport->WorkPos.x, viewport->WorkPos.y + topBarHeight);
-    ImVec2 size = ImVec2(toolbarWidth, viewport->WorkSize.y - topBarHeight);  // 移除了 -28（状态栏高度）
+    ImVec2 size = ImVec2(toolbarWidth, viewport->WorkSize.y - topBarHeight - 28);  // 28 为状态栏高度
     
     ImGui::SetNextWindowPos(pos);
     ImGui::SetNextWindowSize(size);
@@ -434,6 +508,8 @@ void MainUI::RenderToolbar() {
         ImGui::BeginTooltip();
         ImGui::SetWindowFontScale(1.1f);
         ImGui::Text("变换工具 (Ctrl+T)");
+        ImGui::Text("R / Shift+R: 旋转 90°");
+        ImGui::Text("] / [: 旋转 1° (Shift: 15°)");
         ImGui::SetWindowFontScale(1.0f);
         ImGui::EndTooltip();
     }
@@ -544,33 +620,42 @@ void MainUI::StartBatchProcess() {
         BatchTask task;
         task.inputPath = info.filePath;
         task.outputPath = outputFolder + "/" + info.fileName;
+        if (m_ProcessConfig.format == OutputFormat::WebP) {
+            // WebP 文件不沿用原扩展名，避免其它程序按扩展名误判格式
+            task.outputPath = outputFolder + "/" + info.fileName.substr(0, info.fileName.find_last_of('.')) + ".webp";
+        }
         task.config = m_ProcessConfig;
         task.transformState = info.transformState;  // 传递变换状态
         
         // ✅ 检查是否有缓存的修改后的图片数据（如删除选区）
         ImageData cachedImage;
         if (m_PreviewPanel->GetCachedImageData(info.filePath, cachedImage)) {
-            task.preprocessedImage = cachedImage;
+            task.preprocessedImage = std::move(cachedImage);  // 与预览缓存共享像素
             task.usePreprocessed = true;
             Logger::Info("Using cached modified image for: " + info.fileName);
         } else {
             task.usePreprocessed = false;
         }
         
-        tasks.push_back(task);
+        tasks.push_back(std::move(task));
     }
 
     // 使用 Lambda 捕获 this 指针
-    m_BatchProcessor->Start(tasks,
+    m_BatchProcessor->Start(std::move(tasks),
         [this](const BatchProgress& progress) { 
             (void)progress; 
         },
         [this](bool success) { 
+            const BatchProgress& progress = m_BatchProcessor->GetProgress();
             if (success) {
                 std::string message = "[OK] 批处理成功完成！\n\n处理文件数：" + 
                     std::to_string(m_ImageList.size()) + "\n" +
                     "输出目录：" + m_OutputDirectory;
                 ShowBatchProcessComplete(message);
+            } else if (progress.cancelled > 0) {
+                ShowSuccess("批处理已取消：完成 " + std::to_string(progress.completed) +
+                            "，失败 " + std::to_string(progress.failed) +
+                            "，放弃 " + std::to_string(progress.cancelled));
             } else {
                 ShowError("批处理失败！\n请检查文件权限或重试。");
             }
@@ -683,7 +768,6 @@ void MainUI::AddImages() {
 void MainUI::AddImagesFromFolder() {
     try {
         Logger::Info("=== AddImagesFromFolder() started ===");
-        Logger::Debug("Calling FileDialog::OpenFolder()...");
         std::string folderPath = FileDialog::OpenFolder();
         Logger::Info("FileDialog::OpenFolder() returned: " + (folderPath.empty() ? "empty" : folderPath));
         
@@ -692,103 +776,93 @@ void MainUI::AddImagesFromFolder() {
             return; // 用户取消选择
         }
 
-        Logger::Debug("Opening folder: " + folderPath);
-        std::vector<ImageInfo> folderImages;
-        
-        try {
-            Logger::Debug("Calling ImageLoader::GetFolderImages()...");
-            if (!ImageLoader::GetFolderImages(folderPath, folderImages)) {
-                Logger::Error("GetFolderImages() returned false");
-                ShowError("读取文件夹失败!\n\n可能的原因:\n- 文件夹权限不足\n- 路径无效或不存在\n- 磁盘读取错误");
-                return;
-            }
-            Logger::Info("GetFolderImages() succeeded, found " + std::to_string(folderImages.size()) + " images");
-        } catch (const std::exception& e) {
-            Logger::Error("Exception in GetFolderImages(): " + std::string(e.what()));
-            ShowError("读取文件夹异常!\n\n错误: " + std::string(e.what()));
-            return;
-        } catch (...) {
-            Logger::Error("Unknown exception in GetFolderImages()");
-            ShowError("读取文件夹发生未知错误!\n请检查文件夹是否存在或权限是否正确");
-            return;
-        }
+        StartFolderScan({folderPath});
+    } catch (const std::exception& e) {
+        Logger::Error("Exception in AddImagesFromFolder(): " + std::string(e.what()));
+        ShowError("导入文件夹时发生异常!\n\n" + std::string(e.what()));
+    } catch (...) {
+        Logger::Error("Unknown exception in AddImagesFromFolder()");
+        ShowError("导入文件夹时发生未知错误!\n请重试");
+    }
+}
 
-        if (folderImages.empty()) {
-            Logger::Warning("No images found in folder");
-            ShowError("文件夹中没有找到支持的图片!\n\n支持的格式:\n- JPG / JPEG\n- PNG\n- BMP\n- TGA");
-            return;
-        }
+void MainUI::StartFolderScan(const std::vector<std::string>& folderPaths) {
+    if (m_FolderScanActive) {
+        ShowError("正在读取文件夹，请等待完成或点击“扫描中”取消");
+        return;
+    }
 
-        Logger::Debug("Processing " + std::to_string(folderImages.size()) + " images from folder...");
-        int addedCount = 0;
-        int skippedCount = 0;
+    if (!m_FolderScanner->Start(folderPaths)) {
+        ShowError("读取文件夹失败!\n\n可能的原因:\n- 文件夹权限不足\n- 路径无效或不存在\n- 磁盘读取错误");
+        return;
+    }
 
-        for (size_t i = 0; i < folderImages.size(); ++i) {
-            try {
-                Logger::Debug("Processing image " + std::to_string(i + 1) + ": " + folderImages[i].fileName);
-                // 检查是否已存在
-                bool exists = false;
-                for (const auto& existing : m_ImageList) {
-                    if (existing.filePath == folderImages[i].filePath) {
-                        exists = true;
-                        break;
-                    }
-                }
-                
-                if (!exists) {
-                    m_ImageList.push_back(folderImages[i]);
-                    addedCount++;
-                    Logger::Debug("Image added");
-                } else {
-                    skippedCount++;
-                    Logger::Debug("Image already exists, skipped");
-                }
-            } catch (const std::exception& e) {
-                Logger::Error("Error adding image " + folderImages[i].fileName + ": " + std::string(e.what()));
-                skippedCount++;
-                continue;
-            } catch (...) {
-                Logger::Error("Unknown error adding image " + folderImages[i].fileName);
-                skippedCount++;
-                continue;
-            }
-        }
+    m_FolderScanActive = true;
+    m_ScanAddedCount = 0;
+    m_ScanSkippedCount = 0;
+    m_ScanKnownPaths.clear();
+    m_ScanKnownListSize = static_cast<size_t>(-1);  // 第一次取到结果时建立
+}
 
-        Logger::Info("Folder processing completed. Added: " + std::to_string(addedCount) + 
-                     ", Skipped: " + std::to_string(skippedCount));
+void MainUI::UpdateFolderScan() {
+    if (!m_FolderScanActive) {
+        return;
+    }
 
-        if (addedCount == 0) {
-            std::string message;
-            if (skippedCount > 0) {
-                message = "没有新图片被添加!\n\n所有 " + std::to_string(skippedCount) + " 张图片已存在于列表中";
-            } else {
-                message = "没有图片被添加!\n请检查文件";
-            }
-            Logger::Warning(message);
-            ShowError(message);
+    // 先判断是否结束再取结果：结束后的这次 Poll 能取回全部剩余结果
+    const bool finished = !m_FolderScanner->IsRunning();
+
+    std::vector<ImageInfo> batch;
+    m_FolderScanner->Poll(batch);
+    if (!batch.empty() && m_ScanKnownListSize != m_ImageList.size()) {
+        // 扫描期间列表被其它操作修改过（添加图片、删除等），重新建立去重集合
+        m_ScanKnownPaths.clear();
+        for (const auto& existing : m_ImageList) {
+            m_ScanKnownPaths.insert(existing.filePath);
+        }
+    }
+    for (auto& info : batch) {
+        if (m_ScanKnownPaths.insert(info.filePath).second) {
+            m_ImageList.push_back(std::move(info));
+            m_ScanAddedCount++;
         } else {
-            std::string message = "成功添加 " + std::to_string(addedCount) + " 张图片";
-            if (skippedCount > 0) {
-                message += "\n(跳过 " + std::to_string(skippedCount) + " 张重复图片)";
-            }
-            Logger::Info(message);
-            ShowSuccess(message);
+            m_ScanSkippedCount++;
         }
+    }
+    if (!batch.empty()) {
+        m_ScanKnownListSize = m_ImageList.size();
+    }
 
-        Logger::Debug("Checking if need to auto-select first image...");
-        // 如果之前没有选中，自动选中第一张
-        if (m_CurrentImageIndex == -1 && !m_ImageList.empty()) {
-            m_CurrentImageIndex = 0;
-            Logger::Debug("Auto-selected first image");
+    // 如果之前没有选中，自动选中第一张
+    if (m_CurrentImageIndex == -1 && !m_ImageList.empty()) {
+        m_CurrentImageIndex = 0;
+    }
+
+    if (!finished) {
+        return;
+    }
+
+    m_FolderScanActive = false;
+    m_ScanKnownPaths.clear();
+    Logger::Info("Folder scan completed. Added: " + std::to_string(m_ScanAddedCount) + 
+                 ", Skipped: " + std::to_string(m_ScanSkippedCount));
+
+    if (m_ScanAddedCount == 0) {
+        std::string message;
+        if (m_ScanSkippedCount > 0) {
+            message = "没有新图片被添加!\n\n所有 " + std::to_string(m_ScanSkippedCount) + " 张图片已存在于列表中";
+        } else {
+            message = "文件夹中没有找到支持的图片!\n\n支持的格式:\n- JPG / JPEG\n- PNG\n- BMP\n- TGA";
         }
-        
-        Logger::Info("=== AddImagesFromFolder() completed successfully ===");
-    } catch (const std::exception& e) {
-        Logger::Error("Exception in AddImagesFromFolder(): " + std::string(e.what()));
-        ShowError("导入文件夹时发生异常!\n\n" + std::string(e.what()));
-    } catch (...) {
-        Logger::Error("Unknown exception in AddImagesFromFolder()");
-        ShowError("导入文件夹时发生未知错误!\n请重试");
+        Logger::Warning(message);
+        ShowError(message);
+    } else {
+        std::string message = "成功添加 " + std::to_string(m_ScanAddedCount) + " 张图片";
+        if (m_ScanSkippedCount > 0) {
+            message += "\n(跳过 " + std::to_string(m_ScanSkippedCount) + " 张重复图片)";
+        }
+        Logger::Info(message);
+        ShowSuccess(message);
     }
 }
 
@@ -805,6 +879,12 @@ void MainUI::OpenFileExplorer() {
 void MainUI::ClearAllImages() {
     try {
         Logger::Info("=== ClearAllImages() started ===");
+
+        // 正在扫描的文件夹不再加入列表
+        if (m_FolderScanActive) {
+            m_FolderScanner->Cancel();
+            m_FolderScanActive = false;
+        }
         
         // 清空图片列表
         m_ImageList.clear();
@@ -822,30 +902,15 @@ void MainUI::ClearAllImages() {
 }
 
 void MainUI::OnFilesDropped(const std::vector<std::string>& filePaths) {
+    std::vector<std::string> folders;
     for (const auto& path : filePaths) {
         // 检查是文件还是文件夹
         DWORD attrs = GetFileAttributesA(path.c_str());
         
         if (attrs != INVALID_FILE_ATTRIBUTES) {
             if (attrs & FILE_ATTRIBUTE_DIRECTORY) {
-                // 是文件夹，加载文件夹中的所有图片
-                std::vector<ImageInfo> folderImages;
-                if (ImageLoader::GetFolderImages(path, folderImages)) {
-                    for (const auto& info : folderImages) {
-                        // 检查是否已存在
-                        bool exists = false;
-                        for (const auto& existing : m_ImageList) {
-                            if (existing.filePath == info.filePath) {
-                                exists = true;
-                                break;
-                            }
-                        }
-                        
-                        if (!exists) {
-                            m_ImageList.push_back(info);
-                        }
-                    }
-                }
+                // 是文件夹，在后台扫描其中的所有图片
+                folders.push_back(path);
             } else {
                 // 是文件，检查是否为图片
                 if (ImageLoader::IsSupportedFormat(path)) {
@@ -869,6 +934,10 @@ void MainUI::OnFilesDropped(const std::vector<std::string>& filePaths) {
         }
     }
 
+    if (!folders.empty()) {
+        StartFolderScan(folders);
+    }
+
     // 如果之前没有选中，自动选中第一张
     if (m_CurrentImageIndex == -1 && !m_ImageList.empty()) {
         m_CurrentImageIndex = 0;
@@ -888,7 +957,7 @@ void MainUI::RenderControlPanel(ProcessConfig& config) {
     ImGui::Spacing();
 
     // 导出 (Export)
-    RenderExportSection(config.format, config.jpgQuality);
+    RenderExportSection(config.format, config.jpgQuality, config.pngCompression, config.webp);
 
     ImGui::End();
 }
@@ -1006,7 +1075,8 @@ void MainUI::RenderTransformSection(Canvas& canvas) {
 }
 
 
-void MainUI::RenderExportSection(OutputFormat& format, int& jpgQuality) {
+void MainUI::RenderExportSection(OutputFormat& format, int& jpgQuality, PngCompression& pngCompression,
+                                 WebpOptions& webpOptions) {
     ImGui::PushStyleColor(ImGuiCol_Header, ImVec4(0.20f, 0.20f, 0.20f, 1.0f));
     ImGui::PushStyleColor(ImGuiCol_HeaderHovered, ImVec4(0.24f, 0.24f, 0.24f, 1.0f));
     ImGui::PushStyleColor(ImGuiCol_HeaderActive, ImVec4(0.28f, 0.28f, 0.28f, 1.0f));
@@ -1032,10 +1102,14 @@ void MainUI::RenderExportSection(OutputFormat& format, int& jpgQuality) {
         ImGui::Spacing();
         ImGui::Spacing();
         
-        float buttonWidth = (ImGui::GetContentRegionAvail().x - 12) / 2.0f;
+        // WebP 只在编译了 libwebp 时提供
+        const bool webpAvailable = WebpWriter::IsAvailable();
+        const int formatCount = webpAvailable ? 3 : 2;
+        float buttonWidth = (ImGui::GetContentRegionAvail().x - 12 * (formatCount - 1)) / formatCount;
         
         bool isJPG = (format == OutputFormat::JPG);
         bool isPNG = (format == OutputFormat::PNG);
+        bool isWebP = (format == OutputFormat::WebP);
         
         // 高质量 JPG 按钮 - 增大尺寸和字体
         if (isJPG) {
@@ -1075,6 +1149,113 @@ void MainUI::RenderExportSection(OutputFormat& format, int& jpgQuality) {
         ImGui::SetWindowFontScale(1.0f);
         ImGui::PopStyleColor(3);
 
+        // WebP 按钮
+        if (webpAvailable) {
+            ImGui::SameLine();
+            if (isWebP) {
+                ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.26f, 0.59f, 0.98f, 1.0f));
+                ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.36f, 0.69f, 1.0f, 1.0f));
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+            } else {
+                ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.18f, 0.18f, 0.18f, 1.0f));
+                ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.22f, 0.22f, 0.22f, 1.0f));
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.7f, 0.7f, 0.7f, 1.0f));
+            }
+
+            ImGui::SetWindowFontScale(1.1f);
+            if (ImGui::Button("WebP", ImVec2(buttonWidth, 50))) {
+                format = OutputFormat::WebP;
+            }
+            ImGui::SetWindowFontScale(1.0f);
+            ImGui::PopStyleColor(3);
+        } else if (isWebP) {
+            format = OutputFormat::PNG;
+        }
+
+        // PNG 压缩级别
+        if (format == OutputFormat::PNG) {
+            ImGui::Spacing();
+            ImGui::Spacing();
+            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.7f, 0.7f, 0.7f, 1.0f));
+            ImGui::TextUnformatted("PNG 压缩");
+            ImGui::PopStyleColor();
+            ImGui::Spacing();
+
+            struct LevelOption {
+                const char* label;
+                const char* tooltip;
+                PngCompression level;
+            };
+            const LevelOption options[] = {
+                {"不压缩", "最快，文件最大", PngCompression::Store},
+                {"快速", "速度优先，文件略大", PngCompression::Fast},
+                {"标准", "压缩率优先（默认）", PngCompression::Default},
+            };
+            const float levelWidth = (ImGui::GetContentRegionAvail().x - 2 * ImGui::GetStyle().ItemSpacing.x) / 3.0f;
+            for (size_t i = 0; i < 3; ++i) {
+                const bool selected = (pngCompression == options[i].level);
+                if (selected) {
+                    ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.26f, 0.59f, 0.98f, 1.0f));
+                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.36f, 0.69f, 1.0f, 1.0f));
+                    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+                } else {
+                    ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.18f, 0.18f, 0.18f, 1.0f));
+                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.22f, 0.22f, 0.22f, 1.0f));
+                    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.7f, 0.7f, 0.7f, 1.0f));
+                }
+                if (i > 0) {
+                    ImGui::SameLine();
+                }
+                if (ImGui::Button(options[i].label, ImVec2(levelWidth, 32))) {
+                    pngCompression = options[i].level;
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("%s", options[i].tooltip);
+                }
+                ImGui::PopStyleColor(3);
+            }
+        }
+
+        // WebP 编码参数
+        if (format == OutputFormat::WebP) {
+            ImGui::Spacing();
+            ImGui::Spacing();
+            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.7f, 0.7f, 0.7f, 1.0f));
+            ImGui::TextUnformatted("WebP 压缩");
+            ImGui::PopStyleColor();
+            ImGui::Spacing();
+
+            const float modeWidth = (ImGui::GetContentRegionAvail().x - ImGui::GetStyle().ItemSpacing.x) / 2.0f;
+            for (int i = 0; i < 2; ++i) {
+                const bool lossless = (i == 1);
+                if (webpOptions.lossless == lossless) {
+                    ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.26f, 0.59f, 0.98f, 1.0f));
+                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.36f, 0.69f, 1.0f, 1.0f));
+                    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+                } else {
+                    ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.18f, 0.18f, 0.18f, 1.0f));
+                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.22f, 0.22f, 0.22f, 1.0f));
+                    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.7f, 0.7f, 0.7f, 1.0f));
+                }
+                if (i > 0) {
+                    ImGui::SameLine();
+                }
+                if (ImGui::Button(lossless ? "无损" : "有损", ImVec2(modeWidth, 32))) {
+                    webpOptions.lossless = lossless;
+                }
+                ImGui::PopStyleColor(3);
+            }
+            ImGui::Spacing();
+
+            ImGui::SetNextItemWidth(-80);
+            ImGui::SliderInt(webpOptions.lossless ? "压缩力度" : "画质", &webpOptions.quality, 0, 100);
+            ImGui::SetNextItemWidth(-80);
+            ImGui::SliderInt("方法", &webpOptions.method, 0, 6);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("0 最快，6 最慢但文件最小");
+            }
+        }
+
         ImGui::Spacing();
         ImGui::Spacing();
         ImGui::Spacing();
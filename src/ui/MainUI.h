@@ -2,7 +2,9 @@
 
 #include "core/Types.h"
 #include "task/BatchProcessor.h"
+#include "task/FolderScanner.h"
 #include <memory>
+#include <unordered_set>
 #include <vector>
 
 class ImageListPanel;
@@ -80,6 +82,17 @@ private:
      */
     void AddImagesFromFolder();
 
+    /**
+     * @brief 在后台开始扫描文件夹，结果在 UpdateFolderScan() 中逐帧加入列表
+     * @param folderPaths 文件夹列表
+     */
+    void StartFolderScan(const std::vector<std::string>& folderPaths);
+
+    /**
+     * @brief 取回扫描结果并加入列表（每帧调用），扫描结束时显示汇总提示
+     */
+    void UpdateFolderScan();
+
     /**
      * @brief 清空所有图片素材
      */
@@ -95,7 +108,8 @@ private:
      */
     void RenderControlPanel(ProcessConfig& config);
     void RenderTransformSection(Canvas& canvas);
-    void RenderExportSection(OutputFormat& format, int& jpgQuality);
+    void RenderExportSection(OutputFormat& format, int& jpgQuality, PngCompression& pngCompression,
+                             WebpOptions& webpOptions);
     
     /**
      * @brief 渲染提示对话框
@@ -137,6 +151,14 @@ private:
     // 批量处理器
     std::unique_ptr<BatchProcessor> m_BatchProcessor;
 
+    // 文件夹扫描器
+    std::unique_ptr<FolderScanner> m_FolderScanner;
+    bool m_FolderScanActive = false;  // 是否有扫描结果尚未汇总
+    int m_ScanAddedCount = 0;
+    int m_ScanSkippedCount = 0;
+    std::unordered_set<std::string> m_ScanKnownPaths;  // 列表中已有的路径（扫描期间去重）
+    size_t m_ScanKnownListSize = 0;  // m_ScanKnownPaths 对应的列表长度，列表在别处被修改时重建
+
     // 全局状态
     std::vector<ImageInfo> m_ImageList;
     int m_CurrentImageIndex = -1;
@@ -2,9 +2,12 @@
 #include "core/ImageLoader.h"
 #include "core/TransformManager.h"
 #include "core/GuideLineManager.h"
+#include "core/PixelKernels.h"
 #include <imgui.h>
 #include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <utility>
 
 // OpenGL
 #ifdef _WIN32
@@ -140,6 +143,25 @@ void PreviewPanel::Render(std::vector<ImageInfo>& imageList,
             m_TransformRect.top += step;
             m_TransformRect.bottom += step;
         }
+        
+        // 旋转（绕变换矩形中心，顺时针为正）：R 顺时针 90°，Shift+R 逆时针 90°；
+        // ] / [ 微调 1°，按住 Shift 时 15°
+        float rotateStep = 0.0f;
+        if (ImGui::IsKeyPressed(ImGuiKey_R, false) && !ctrlPressed) {
+            rotateStep = shiftPressed ? -90.0f : 90.0f;
+        }
+        if (ImGui::IsKeyPressed(ImGuiKey_RightBracket)) {
+            rotateStep = shiftPressed ? 15.0f : 1.0f;
+        }
+        if (ImGui::IsKeyPressed(ImGuiKey_LeftBracket)) {
+            rotateStep = shiftPressed ? -15.0f : -1.0f;
+        }
+        if (rotateStep != 0.0f) {
+            m_TransformRotation = std::fmod(m_TransformRotation + rotateStep, 360.0f);
+            if (m_TransformRotation < 0.0f) {
+                m_TransformRotation += 360.0f;
+            }
+        }
     }
     
     // 选区模式下的快捷键（需要在渲染前处理，以便传递正确的图片边界）
@@ -609,13 +631,34 @@ void PreviewPanel::RenderCanvasStage(const ImageData& image, ProcessConfig& conf
         //     uvMaxY = vOffset + uvMaxY * vScale;
         // }
         
-        ImGui::GetWindowDrawList()->AddImage(
-            (void*)(intptr_t)m_TextureID,
-            clippedImageMin,
-            clippedImageMax,
-            ImVec2(uvMinX, uvMinY),
-            ImVec2(uvMaxX, uvMaxY)
-        );
+        if (m_TransformRotation != 0.0f) {
+            // 旋转：四个角绕变换矩形中心旋转（与 ImageProcessor::Process 一致），超出画布的部分由裁剪去掉
+            const float radians = m_TransformRotation * 3.14159265f / 180.0f;
+            const float cosA = std::cos(radians);
+            const float sinA = std::sin(radians);
+            const ImVec2 center((imageMin.x + imageMax.x) * 0.5f, (imageMin.y + imageMax.y) * 0.5f);
+            auto rotate = [&](float x, float y) {
+                const float dx = x - center.x;
+                const float dy = y - center.y;
+                return ImVec2(center.x + dx * cosA - dy * sinA, center.y + dx * sinA + dy * cosA);
+            };
+            ImDrawList* imageDrawList = ImGui::GetWindowDrawList();
+            imageDrawList->PushClipRect(canvasMin, canvasMax, true);
+            imageDrawList->AddImageQuad(
+                (void*)(intptr_t)m_TextureID,
+                rotate(imageMin.x, imageMin.y), rotate(imageMax.x, imageMin.y),
+                rotate(imageMax.x, imageMax.y), rotate(imageMin.x, imageMax.y)
+            );
+            imageDrawList->PopClipRect();
+        } else {
+            ImGui::GetWindowDrawList()->AddImage(
+                (void*)(intptr_t)m_TextureID,
+                clippedImageMin,
+                clippedImageMax,
+                ImVec2(uvMinX, uvMinY),
+                ImVec2(uvMaxX, uvMaxY)
+            );
+        }
         
         // 变换模式：显示控制点和对齐辅助线
         if (m_TransformMode) {
@@ -1203,7 +1246,7 @@ void PreviewPanel::SaveTransformState(ImageInfo& imageInfo) {
     imageInfo.transformState.scaleY = static_cast<float>(m_TransformRect.top);
     imageInfo.transformState.positionX = static_cast<float>(m_TransformRect.right);
     imageInfo.transformState.positionY = static_cast<float>(m_TransformRect.bottom);
-    imageInfo.transformState.rotation = 0.0f;  // 暂未使用
+    imageInfo.transformState.rotation = m_TransformRotation;
     
     // 检查是否有自定义变换（不是默认值）
     imageInfo.transformState.hasTransform = 
@@ -1244,6 +1287,7 @@ void PreviewPanel::RestoreTransformState(const ImageInfo& imageInfo) {
         // 没有保存的变换状态，重置矩形（会在渲染时自动初始化）
         m_TransformRect = TransformRect();
     }
+    m_TransformRotation = imageInfo.transformState.rotation;
 }
 
 void PreviewPanel::RenderTransformControls(const ImVec2& imageMin, const ImVec2& imageMax) {
@@ -1667,30 +1711,18 @@ bool PreviewPanel::DeleteSelectionContent(const ProcessConfig& config) {
     if (channels < 4) {
         printf("[DeleteSelection] Converting image to RGBA format...\n");
         
-        // 转换为 RGBA 格式
-        std::vector<uint8_t> newPixels;
-        newPixels.reserve(m_CurrentImage.width * m_CurrentImage.height * 4);
-        
-        for (int y = 0; y < m_CurrentImage.height; y++) {
-            for (int x = 0; x < m_CurrentImage.width; x++) {
-                int srcIdx = (y * m_CurrentImage.width + x) * channels;
-                
-                if (channels == 3) {
-                    // RGB -> RGBA
-                    newPixels.push_back(m_CurrentImage.pixels[srcIdx + 0]); // R
-                    newPixels.push_back(m_CurrentImage.pixels[srcIdx + 1]); // G
-                    newPixels.push_back(m_CurrentImage.pixels[srcIdx + 2]); // B
-                    newPixels.push_back(255); // A (不透明)
-                } else if (channels == 1) {
-                    // Grayscale -> RGBA
-                    uint8_t gray = m_CurrentImage.pixels[srcIdx];
-                    newPixels.push_back(gray); // R
-                    newPixels.push_back(gray); // G
-                    newPixels.push_back(gray); // B
-                    newPixels.push_back(255);  // A (不透明)
-                }
+        // 转换为 RGBA 格式（按通道数特化，灰度 + Alpha 保留原 alpha）
+        const int width = m_CurrentImage.width;
+        PixelBuffer newPixels = PixelBuffer::Allocate(static_cast<size_t>(width) * m_CurrentImage.height * 4);
+        DispatchChannels(channels, [&](auto tag) {
+            constexpr int kChannels = decltype(tag)::value;
+            for (int y = 0; y < m_CurrentImage.height; y++) {
+                ConvertRowToRGBA<kChannels>(
+                    newPixels.data() + static_cast<size_t>(y) * width * 4,
+                    std::as_const(m_CurrentImage.pixels).data() + static_cast<size_t>(y) * width * kChannels,
+                    width);
             }
-        }
+        });
         
         m_CurrentImage.pixels = std::move(newPixels);
         m_CurrentImage.channels = 4;
@@ -1698,6 +1730,8 @@ bool PreviewPanel::DeleteSelectionContent(const ProcessConfig& config) {
     }
     
     // 6. 删除选区内的像素（设置 Alpha = 0）
+    // 像素可能与撤销历史共享，取一次写指针，只在这里复制一份
+    uint8_t* pixels = m_CurrentImage.pixels.data();
     int pixelsDeleted = 0;
     for (int y = deleteTop; y < deleteBottom; y++) {
         for (int x = deleteLeft; x < deleteRight; x++) {
@@ -1706,7 +1740,7 @@ bool PreviewPanel::DeleteSelectionContent(const ProcessConfig& config) {
             
             // ✅ PS 行为：将 Alpha 设置为 0（完全透明）
             // RGB 值保留（虽然不可见，但符合 PS 行为）
-            m_CurrentImage.pixels[pixelIdx + 3] = 0;  // Alpha = 0
+            pixels[pixelIdx + 3] = 0;  // Alpha = 0
             pixelsDeleted++;
         }
     }
@@ -1745,7 +1779,7 @@ bool PreviewPanel::DeleteSelectionContent(const ProcessConfig& config) {
     for (int y = 0; y < m_CurrentImage.height; y++) {
         for (int x = 0; x < m_CurrentImage.width; x++) {
             int pixelIdx = (y * m_CurrentImage.width + x) * channels;
-            uint8_t alpha = m_CurrentImage.pixels[pixelIdx + 3];
+            uint8_t alpha = std::as_const(m_CurrentImage.pixels)[pixelIdx + 3];
             
             if (alpha > 0) {  // 有效像素（非完全透明）
                 minX = std::min(minX, x);
@@ -1813,7 +1847,7 @@ bool PreviewPanel::Undo() {
         for (int y = 0; y < m_CurrentImage.height; y++) {
             for (int x = 0; x < m_CurrentImage.width; x++) {
                 int pixelIdx = (y * m_CurrentImage.width + x) * channels;
-                uint8_t alpha = m_CurrentImage.pixels[pixelIdx + 3];
+                uint8_t alpha = std::as_const(m_CurrentImage.pixels)[pixelIdx + 3];
                 
                 if (alpha > 0) {  // 有效像素（非完全透明）
                     minX = std::min(minX, x);
@@ -1898,7 +1932,7 @@ bool PreviewPanel::Redo() {
         for (int y = 0; y < m_CurrentImage.height; y++) {
             for (int x = 0; x < m_CurrentImage.width; x++) {
                 int pixelIdx = (y * m_CurrentImage.width + x) * channels;
-                uint8_t alpha = m_CurrentImage.pixels[pixelIdx + 3];
+                uint8_t alpha = std::as_const(m_CurrentImage.pixels)[pixelIdx + 3];
                 
                 if (alpha > 0) {  // 有效像素（非完全透明）
                     minX = std::min(minX, x);
@@ -132,7 +132,7 @@ private:
     
     // 兼容旧代码（用于保存/恢复状态）
     ImVec2 m_TransformScale = ImVec2(1.0f, 1.0f);
-    float m_TransformRotation = 0.0f;
+    float m_TransformRotation = 0.0f;        // 顺时针旋转角度（度）
     ImVec2 m_TransformPosition = ImVec2(0.0f, 0.0f);
     
     // 对齐辅助线管理器
@@ -0,0 +1,279 @@
+#include "MappedFile.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <filesystem>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void SetError(std::string* error, const std::string& message) {
+    if (error) {
+        *error = message;
+    }
+}
+
+} // namespace
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+void MappedFile::Preload() const {
+    if (!m_Mapped) {
+        return;
+    }
+
+    // 按最小的页大小步进，每页读一个字节即可触发整页读入
+    constexpr size_t kPageBytes = 4096;
+    volatile uint8_t sink = 0;
+    for (size_t offset = 0; offset < m_Size; offset += kPageBytes) {
+        sink = sink ^ m_Data[offset];
+    }
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& filePath, std::string* error) {
+    Close();
+
+    // UTF-8 路径转换为宽字符，支持中文文件名
+    std::wstring wpath = std::filesystem::path(filePath).wstring();
+    HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        SetError(error, "CreateFile failed (error " + std::to_string(GetLastError()) + ")");
+        return false;
+    }
+
+    LARGE_INTEGER size = {};
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        SetError(error, "not a regular file");
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        SetError(error, "file is empty");
+        return false;
+    }
+    m_Size = static_cast<size_t>(size.QuadPart);
+
+    if (m_Size < kMapThreshold) {
+        m_Buffer.resize(m_Size);
+        DWORD read = 0;
+        const BOOL ok = ReadFile(file, m_Buffer.data(), static_cast<DWORD>(m_Size), &read, nullptr);
+        CloseHandle(file);
+        if (!ok || read != m_Size) {
+            Close();
+            SetError(error, "ReadFile failed (error " + std::to_string(GetLastError()) + ")");
+            return false;
+        }
+        m_Data = m_Buffer.data();
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        m_Size = 0;
+        SetError(error, "CreateFileMapping failed (error " + std::to_string(GetLastError()) + ")");
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        m_Size = 0;
+        SetError(error, "MapViewOfFile failed (error " + std::to_string(GetLastError()) + ")");
+        return false;
+    }
+
+    m_MappingHandle = mapping;
+    m_Data = static_cast<const uint8_t*>(view);
+    m_Mapped = true;
+    return true;
+}
+
+bool MappedFile::ReadPrefix(const std::string& filePath, size_t maxBytes,
+                            std::vector<uint8_t>& outData, size_t& outFileSize,
+                            std::string* error) {
+    std::wstring wpath = std::filesystem::path(filePath).wstring();
+    HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        SetError(error, "CreateFile failed (error " + std::to_string(GetLastError()) + ")");
+        return false;
+    }
+
+    LARGE_INTEGER size = {};
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        SetError(error, "not a regular file");
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        SetError(error, "file is empty");
+        return false;
+    }
+    outFileSize = static_cast<size_t>(size.QuadPart);
+
+    outData.resize(std::min(outFileSize, maxBytes));
+    DWORD read = 0;
+    const BOOL ok = ReadFile(file, outData.data(), static_cast<DWORD>(outData.size()), &read, nullptr);
+    CloseHandle(file);
+    if (!ok || read == 0) {
+        SetError(error, "ReadFile failed (error " + std::to_string(GetLastError()) + ")");
+        return false;
+    }
+    outData.resize(read);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_Mapped) {
+        UnmapViewOfFile(m_Data);
+        CloseHandle(static_cast<HANDLE>(m_MappingHandle));
+        m_MappingHandle = nullptr;
+    }
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Mapped = false;
+    m_Buffer.clear();
+    m_Buffer.shrink_to_fit();
+}
+
+#else
+
+bool MappedFile::Open(const std::string& filePath, std::string* error) {
+    Close();
+
+    const int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        SetError(error, std::strerror(errno));
+        return false;
+    }
+
+    // fstat 使用打开时取得的属性，不会再访问一次路径
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        SetError(error, std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    if (!S_ISREG(info.st_mode)) {
+        ::close(fd);
+        SetError(error, "not a regular file");
+        return false;
+    }
+    if (info.st_size <= 0) {
+        ::close(fd);
+        SetError(error, "file is empty");
+        return false;
+    }
+    m_Size = static_cast<size_t>(info.st_size);
+
+    if (m_Size < kMapThreshold) {
+        // 小文件：一次 pread 读完（被信号打断或短读时继续）
+        m_Buffer.resize(m_Size);
+        size_t offset = 0;
+        while (offset < m_Size) {
+            const ssize_t n = ::pread(fd, m_Buffer.data() + offset, m_Size - offset,
+                                      static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                SetError(error, n < 0 ? std::strerror(errno) : "unexpected end of file");
+                ::close(fd);
+                Close();
+                return false;
+            }
+            offset += static_cast<size_t>(n);
+        }
+        ::close(fd);
+        m_Data = m_Buffer.data();
+        return true;
+    }
+
+    void* view = ::mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // 映射建立后文件描述符不再需要
+    if (view == MAP_FAILED) {
+        m_Size = 0;
+        SetError(error, std::strerror(errno));
+        return false;
+    }
+
+    // 解码器从头到尾读取一遍：提示内核积极预读，读过的页可以尽快回收
+    ::madvise(view, m_Size, MADV_SEQUENTIAL);
+    ::madvise(view, m_Size, MADV_WILLNEED);
+
+    m_Data = static_cast<const uint8_t*>(view);
+    m_Mapped = true;
+    return true;
+}
+
+bool MappedFile::ReadPrefix(const std::string& filePath, size_t maxBytes,
+                            std::vector<uint8_t>& outData, size_t& outFileSize,
+                            std::string* error) {
+    const int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        SetError(error, std::strerror(errno));
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        SetError(error, std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    if (!S_ISREG(info.st_mode)) {
+        ::close(fd);
+        SetError(error, "not a regular file");
+        return false;
+    }
+    if (info.st_size <= 0) {
+        ::close(fd);
+        SetError(error, "file is empty");
+        return false;
+    }
+    outFileSize = static_cast<size_t>(info.st_size);
+
+    // 头部解析只需要开头几 KB，短读直接使用已读到的部分
+    outData.resize(std::min(outFileSize, maxBytes));
+    ssize_t n;
+    do {
+        n = ::pread(fd, outData.data(), outData.size(), 0);
+    } while (n < 0 && errno == EINTR);
+    ::close(fd);
+
+    if (n <= 0) {
+        SetError(error, n < 0 ? std::strerror(errno) : "unexpected end of file");
+        return false;
+    }
+    outData.resize(static_cast<size_t>(n));
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_Mapped) {
+        ::munmap(const_cast<uint8_t*>(m_Data), m_Size);
+    }
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Mapped = false;
+    m_Buffer.clear();
+    m_Buffer.shrink_to_fit();
+}
+
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 只读文件映射
+ *
+ * 职责：
+ * - 只打开一次文件，错误（不存在、不是普通文件、为空）都来自这一次打开
+ * - 大文件使用内存映射（顺序读取 + 预读提示）
+ * - 小文件一次读入内存（映射的建立/撤销开销比读取本身还大）
+ *
+ * 注意：Data() 在对象销毁或 Close() 之前有效
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief 打开文件
+     * @param filePath 文件路径（UTF-8）
+     * @param error 失败时输出原因（可选）
+     * @return 成功返回 true
+     */
+    bool Open(const std::string& filePath, std::string* error = nullptr);
+
+    /**
+     * @brief 只读取文件开头（一次打开、一次读取，不建立映射）
+     * @param filePath 文件路径（UTF-8）
+     * @param maxBytes 最多读取的字节数
+     * @param outData 输出读取到的内容（文件较小时为整个文件）
+     * @param outFileSize 输出文件大小（来自同一次打开的 fstat）
+     * @param error 失败时输出原因（可选）
+     * @return 成功返回 true
+     */
+    static bool ReadPrefix(const std::string& filePath, size_t maxBytes,
+                           std::vector<uint8_t>& outData, size_t& outFileSize,
+                           std::string* error = nullptr);
+
+    /**
+     * @brief 把映射的内容全部读入内存（逐页访问一次）
+     *
+     * 映射的页在首次访问时才从磁盘读取；批处理的读取阶段调用它，之后的解码不再因缺页等待磁盘。
+     * 小文件已经读入缓冲，直接返回。
+     */
+    void Preload() const;
+
+    /**
+     * @brief 释放映射或缓冲
+     */
+    void Close();
+
+    const uint8_t* Data() const { return m_Data; }
+    size_t Size() const { return m_Size; }
+    bool IsMapped() const { return m_Mapped; }
+
+    // 小于该大小的文件直接读入内存
+    static constexpr size_t kMapThreshold = 1024 * 1024;
+
+private:
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+    bool m_Mapped = false;
+    std::vector<uint8_t> m_Buffer;  // 小文件的内容
+#ifdef _WIN32
+    void* m_MappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,94 @@
+// Deflate 回归测试：压缩结果须能被 stb_image 的 zlib 解码器还原
+//
+// 输入用恰好等长的堆内存保存，配合 AddressSanitizer 可以发现越界读取。
+#include "core/Deflate.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#include <stb_image.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+int g_Failures = 0;
+
+void Check(bool condition, const char* what, size_t size, int strategy) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s (size=%zu, strategy=%d)\n", what, size, strategy);
+        ++g_Failures;
+    }
+}
+
+// 压缩后解码，结果须与输入一致
+void RoundTrip(const std::vector<uint8_t>& input) {
+    // 复制到恰好等长的堆内存，越界读取会落在分配之外
+    std::unique_ptr<uint8_t[]> data(new uint8_t[input.size()]);
+    std::copy(input.begin(), input.end(), data.get());
+
+    const Deflate::Strategy strategies[] = {
+        Deflate::Strategy::Store, Deflate::Strategy::FixedHuffman, Deflate::Strategy::Dynamic
+    };
+    for (Deflate::Strategy strategy : strategies) {
+        std::vector<uint8_t> compressed;
+        Deflate::CompressSegment(data.get(), 0, 0, input.size(), strategy, true, compressed);
+
+        int decodedSize = 0;
+        char* decoded = stbi_zlib_decode_noheader_malloc(
+            reinterpret_cast<const char*>(compressed.data()), static_cast<int>(compressed.size()),
+            &decodedSize);
+        const bool ok = decoded && static_cast<size_t>(decodedSize) == input.size() &&
+                        std::equal(input.begin(), input.end(), reinterpret_cast<uint8_t*>(decoded));
+        Check(ok, "round trip", input.size(), static_cast<int>(strategy));
+        std::free(decoded);
+    }
+}
+
+// 输入在延迟匹配中途结束：末尾是前面某段数据的副本，
+// 末尾位置找到的匹配恰好延伸到输入结尾，下一个位置再尝试延迟匹配
+void TestInputEndsInsideLazyMatch() {
+    std::mt19937 random(1);
+    for (int tail = 3; tail <= 20; ++tail) {
+        for (int prefix = 64; prefix <= 512; prefix += 37) {
+            std::vector<uint8_t> input(static_cast<size_t>(prefix));
+            for (uint8_t& value : input) {
+                value = static_cast<uint8_t>(random());
+            }
+            const size_t source = static_cast<size_t>(random() % (prefix - tail));
+            input.insert(input.end(), input.begin() + source, input.begin() + source + tail);
+            RoundTrip(input);
+        }
+    }
+}
+
+// 重复度不同的数据
+void TestMixedInputs() {
+    std::mt19937 random(2);
+    for (size_t size : {0u, 1u, 2u, 3u, 257u, 258u, 259u, 4096u, 70000u}) {
+        for (int alphabet : {1, 4, 256}) {
+            std::vector<uint8_t> input(size);
+            for (uint8_t& value : input) {
+                value = static_cast<uint8_t>(random() % alphabet);
+            }
+            RoundTrip(input);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    TestInputEndsInsideLazyMatch();
+    TestMixedInputs();
+
+    if (g_Failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("All Deflate tests passed\n");
+    return 0;
+}
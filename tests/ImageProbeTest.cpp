@@ -0,0 +1,117 @@
+// 图片头部探测测试：GetInfo 的结果须与完整解码一致，头部超出开头 64 KiB 时也要识别
+#include "core/ImageLoader.h"
+#include "core/ImageProber.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+int g_Failures = 0;
+
+void Check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+        ++g_Failures;
+    }
+}
+
+ImageData MakeImage(int width, int height, int channels) {
+    ImageData image;
+    image.width = width;
+    image.height = height;
+    image.channels = channels;
+    image.pixels = PixelBuffer::Allocate(image.GetSize());
+    for (size_t i = 0; i < image.GetSize(); ++i) {
+        image.pixels[i] = static_cast<uint8_t>(i * 7 + i / 13);
+    }
+    return image;
+}
+
+bool WriteFile(const fs::path& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    return static_cast<bool>(file.write(reinterpret_cast<const char*>(bytes.data()),
+                                        static_cast<std::streamsize>(bytes.size())));
+}
+
+// 在 SOI 之后插入一个 APPn 段（length 含长度字段本身，最大 65535）
+void InsertSegment(std::vector<uint8_t>& jpeg, size_t& pos, uint8_t marker, size_t length) {
+    std::vector<uint8_t> segment(length + 2, 0x20);
+    segment[0] = 0xFF;
+    segment[1] = marker;
+    segment[2] = static_cast<uint8_t>(length >> 8);
+    segment[3] = static_cast<uint8_t>(length & 0xFF);
+    jpeg.insert(jpeg.begin() + static_cast<std::ptrdiff_t>(pos), segment.begin(), segment.end());
+    pos += segment.size();
+}
+
+// 编码后写入文件，GetInfo 的尺寸和通道数须与 Load 的结果一致
+void CheckInfo(const fs::path& path, const std::vector<uint8_t>& bytes, const std::string& name) {
+    Check(WriteFile(path, bytes), name + ": write");
+
+    ImageInfo info;
+    ImageData decoded;
+    const bool hasInfo = ImageLoader::GetInfo(path.string(), info);
+    const bool hasImage = ImageLoader::Load(path.string(), decoded);
+    Check(hasInfo, name + ": GetInfo");
+    Check(hasImage, name + ": Load");
+    if (hasInfo && hasImage) {
+        Check(info.width == decoded.width && info.height == decoded.height &&
+              info.channels == decoded.channels, name + ": GetInfo matches Load");
+        Check(info.fileSize == bytes.size(), name + ": file size");
+    }
+}
+
+void TestCommonFormats(const fs::path& directory) {
+    for (int channels = 1; channels <= 4; ++channels) {
+        const ImageData image = MakeImage(37, 23, channels);
+        std::vector<uint8_t> bytes;
+        Check(ImageLoader::EncodeToMemory(image, OutputFormat::PNG, 90, bytes), "encode PNG");
+        CheckInfo(directory / "probe.png", bytes, "PNG " + std::to_string(channels) + " channels");
+
+        Check(ImageLoader::EncodeToMemory(image, OutputFormat::JPG, 90, bytes), "encode JPG");
+        CheckInfo(directory / "probe.jpg", bytes, "JPG " + std::to_string(channels) + " channels");
+    }
+}
+
+// APP1 占满一个段（65535 字节）再跟一个 4 KiB 的 APP2：SOF 落在开头 64 KiB 之外
+void TestJpegHeaderBeyondPrefix(const fs::path& directory) {
+    std::vector<uint8_t> jpeg;
+    Check(ImageLoader::EncodeToMemory(MakeImage(301, 157, 3), OutputFormat::JPG, 90, jpeg),
+          "encode large-header JPG");
+    size_t pos = 2;
+    InsertSegment(jpeg, pos, 0xE1, 65535);
+    InsertSegment(jpeg, pos, 0xE2, 4096);
+
+    int width = 0, height = 0, channels = 0;
+    Check(!ImageProber::Parse(jpeg.data(), ImageProber::kProbeBytes, width, height, channels),
+          "SOF lies outside the probe prefix");
+    Check(ImageProber::Parse(jpeg.data(), jpeg.size(), width, height, channels) &&
+          width == 301 && height == 157 && channels == 3, "Parse finds SOF in the whole file");
+
+    CheckInfo(directory / "large-header.jpg", jpeg, "JPG with 68 KiB of APPn segments");
+}
+
+} // namespace
+
+int main() {
+    const fs::path directory = fs::temp_directory_path() / "ImageProbeTest";
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+
+    TestCommonFormats(directory);
+    TestJpegHeaderBeyondPrefix(directory);
+
+    fs::remove_all(directory, ec);
+    if (g_Failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("All image probe tests passed\n");
+    return 0;
+}
@@ -0,0 +1,122 @@
+// 旋转处理测试：任意角度旋转的结果须与不旋转时一样有效，细长图层缩到不足 1 像素也不能失败
+#include "core/ImageProcessor.h"
+
+#include <cstdio>
+#include <string>
+
+namespace {
+
+int g_Failures = 0;
+
+void Check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+        ++g_Failures;
+    }
+}
+
+ImageData MakeImage(int width, int height, int channels) {
+    ImageData image;
+    image.width = width;
+    image.height = height;
+    image.channels = channels;
+    image.pixels = PixelBuffer::Allocate(image.GetSize());
+    for (size_t i = 0; i < image.GetSize(); ++i) {
+        image.pixels[i] = static_cast<uint8_t>(i * 31 + i / 7);
+    }
+    return image;
+}
+
+const char* ModeName(ScaleMode mode) {
+    switch (mode) {
+        case ScaleMode::None: return "None";
+        case ScaleMode::Fit: return "Fit";
+        case ScaleMode::Fill: return "Fill";
+        case ScaleMode::Stretch: return "Stretch";
+        case ScaleMode::FixedWidth: return "FixedWidth";
+        case ScaleMode::FixedHeight: return "FixedHeight";
+    }
+    return "?";
+}
+
+// 同一配置下不旋转有效时，旋转后也必须得到完整的画布
+void CheckRotated(const ImageData& source, int canvasWidth, int canvasHeight,
+                  ScaleMode mode, float degrees) {
+    ProcessConfig config;
+    config.canvas = Canvas(canvasWidth, canvasHeight);
+    config.scaleMode = mode;
+
+    const std::string name = std::to_string(source.width) + "x" + std::to_string(source.height) +
+                             " into " + std::to_string(canvasWidth) + "x" +
+                             std::to_string(canvasHeight) + " " + ModeName(mode) + " at " +
+                             std::to_string(degrees);
+
+    const ImageData plain = ImageProcessor::Process(source, config);
+    if (!plain.IsValid()) {
+        return;
+    }
+
+    ImageTransformState transform;
+    transform.rotation = degrees;
+    const ImageData rotated = ImageProcessor::Process(source, config, &transform);
+    Check(rotated.IsValid() && rotated.width == canvasWidth && rotated.height == canvasHeight,
+          name);
+}
+
+// 细长图层旋转后窄边不足 1 像素（原先整张图处理失败）
+void TestThinLayers() {
+    const ImageData wide = MakeImage(1920, 50, 3);
+    const ImageData tall = MakeImage(50, 1080, 4);
+    for (ScaleMode mode : {ScaleMode::Fit, ScaleMode::Fill, ScaleMode::Stretch}) {
+        CheckRotated(wide, 16, 16, mode, 30.0f);
+        CheckRotated(tall, 16, 16, mode, 1.0f);
+        CheckRotated(tall, 640, 16, mode, 1.0f);
+    }
+
+    // 用户变换矩形本身不足 1 像素高
+    ProcessConfig config;
+    config.canvas = Canvas(64, 64);
+    ImageTransformState transform;
+    transform.hasTransform = true;
+    transform.scaleX = 10.0f;     // left
+    transform.scaleY = 30.0f;     // top
+    transform.positionX = 50.0f;  // right
+    transform.positionY = 30.4f;  // bottom
+    transform.rotation = 45.0f;
+    const ImageData result = ImageProcessor::Process(wide, config, &transform);
+    Check(result.IsValid() && result.width == 64 && result.height == 64,
+          "user rect thinner than 1 px at 45");
+}
+
+// 常见尺寸、画布和缩放模式的组合
+void TestSweep() {
+    const int sizes[][2] = {{1920, 50}, {50, 1080}, {640, 480}, {3, 900}, {1, 1}};
+    const int canvases[][2] = {{16, 16}, {200, 16}, {16, 300}, {800, 600}};
+    const float angles[] = {1.0f, 30.0f, 45.0f, 89.5f, 135.0f, 359.0f};
+    const ScaleMode modes[] = {ScaleMode::None, ScaleMode::Fit, ScaleMode::Fill,
+                               ScaleMode::Stretch, ScaleMode::FixedWidth, ScaleMode::FixedHeight};
+    for (const auto& size : sizes) {
+        const ImageData source = MakeImage(size[0], size[1], 3);
+        for (const auto& canvas : canvases) {
+            for (ScaleMode mode : modes) {
+                for (float degrees : angles) {
+                    CheckRotated(source, canvas[0], canvas[1], mode, degrees);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    TestThinLayers();
+    TestSweep();
+
+    if (g_Failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("All rotation tests passed\n");
+    return 0;
+}